@@ -23,11 +23,13 @@
 #include <qobjectdefs.h>
 #include <qtypes.h>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstddef>
 #include <format>
 #include <mutex>
 #include <numbers>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include "db_manager.hpp"
@@ -35,6 +37,7 @@
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
+#include "rt_macros.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
 
@@ -54,17 +57,21 @@ Autogain::Autogain(const std::string& tag, pw::Manager* pipe_manager, PipelineTy
 
   // specific plugin controls
 
-  connect(settings, &DbAutogain::maximumHistoryChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(data_mutex);
+  BIND_RT_VALUE(force_silence, forceSilence, DbAutogain::forceSilenceChanged);
 
-    set_maximum_history(settings->maximumHistory());
-  });
+  BIND_RT_VALUE(reference, reference, DbAutogain::referenceChanged);
+
+  BIND_RT_VALUE(target, target, DbAutogain::targetChanged);
+
+  BIND_RT_VALUE(silence_threshold, silenceThreshold, DbAutogain::silenceThresholdChanged);
+
+  BIND_RT_VALUE_NOTIFY(maximum_history, maximumHistory, DbAutogain::maximumHistoryChanged, maximum_history_changed);
 }
 
 Autogain::~Autogain() {
   stop_worker();
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   ebur128_ready = false;
 
@@ -105,7 +112,9 @@ auto Autogain::init_ebur128() -> bool {
   ebur128_set_channel(ebur_state, 0U, EBUR128_LEFT);
   ebur128_set_channel(ebur_state, 1U, EBUR128_RIGHT);
 
-  set_maximum_history(settings->maximumHistory());
+  maximum_history_changed.store(false, std::memory_order_relaxed);
+
+  set_maximum_history(maximum_history.load(std::memory_order_relaxed));
 
   return ebur_state != nullptr;
 }
@@ -126,7 +135,7 @@ void Autogain::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   block_time = static_cast<double>(n_samples) / static_cast<double>(rate);
 
@@ -160,7 +169,7 @@ void Autogain::setup() {
 
         status = init_ebur128();
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         ebur128_ready = status;
       },
@@ -172,9 +181,9 @@ void Autogain::process(std::span<float>& left_in,
                        std::span<float>& right_in,
                        std::span<float>& left_out,
                        std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass) {
+  if (bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
@@ -211,6 +220,10 @@ void Autogain::process(std::span<float>& left_in,
     }
   }
 
+  if (maximum_history_changed.exchange(false, std::memory_order_acquire)) {
+    set_maximum_history(maximum_history.load(std::memory_order_relaxed));
+  }
+
   ebur128_add_frames_float(ebur_state, data.data(), n_samples);
 
   auto failed = false;
@@ -255,7 +268,7 @@ void Autogain::process(std::span<float>& left_in,
     global = momentary;
   }
 
-  if (momentary > settings->silenceThreshold() && !failed) {
+  if (momentary > silence_threshold.load(std::memory_order_relaxed) && !failed) {
     double peak_L = 0.0;
     double peak_R = 0.0;
 
@@ -268,7 +281,7 @@ void Autogain::process(std::span<float>& left_in,
     }
 
     if (!failed) {
-      switch (settings->reference()) {
+      switch (reference.load(std::memory_order_relaxed)) {
         case 0:  // momentary
           loudness = momentary;
           break;
@@ -312,7 +325,7 @@ void Autogain::process(std::span<float>& left_in,
           break;
       }
 
-      const double diff = settings->target() - loudness;
+      const double diff = target.load(std::memory_order_relaxed) - loudness;
 
       // 10^(diff/20). The way below should be faster than using pow
       const double gain = std::exp((diff / 20.0) * std::numbers::ln10);
@@ -335,7 +348,7 @@ void Autogain::process(std::span<float>& left_in,
         }
       }
     }
-  } else if (settings->forceSilence()) {
+  } else if (force_silence.load(std::memory_order_relaxed)) {
     internal_output_gain = util::minimum_linear_d_level;
   }
 
@@ -24,6 +24,7 @@
 #include <qtmetamacros.h>
 #include <sys/types.h>
 #include <QString>
+#include <atomic>
 #include <span>
 #include <string>
 #include <vector>
@@ -106,6 +107,19 @@ class Autogain : public PluginBase {
 
   DbAutogain* settings = nullptr;
 
+  std::atomic<bool> force_silence = {false};
+
+  std::atomic<int> reference = {0};
+
+  std::atomic<double> target = {0.0};
+  std::atomic<double> silence_threshold = {0.0};
+
+  // libebur128 is only used by the realtime thread after setup. It applies the history when it changes.
+
+  std::atomic<int> maximum_history = {0};
+
+  std::atomic<bool> maximum_history_changed = {false};
+
   auto init_ebur128() -> bool;
 
   void set_maximum_history(const int& seconds);
@@ -30,6 +30,7 @@
 #include <format>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include "db_manager.hpp"
@@ -131,7 +132,7 @@ void Autotune::clear_data() {
   }
 
   {
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
     lv2_wrapper->destroy_instance_locked();
   }
@@ -144,7 +145,7 @@ void Autotune::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   if (!lv2_wrapper->found_plugin) {
     return;
@@ -166,7 +167,7 @@ void Autotune::setup() {
       [this] {
         lv2_wrapper->create_instance(rate);
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         ready = true;
       },
@@ -178,9 +179,9 @@ void Autotune::process(std::span<float>& left_in,
                        std::span<float>& right_in,
                        std::span<float>& left_out,
                        std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass) {
+  if (bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
@@ -25,6 +25,7 @@
 #include <format>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include "db_manager.hpp"
@@ -95,7 +96,7 @@ void BassEnhancer::clear_data() {
   }
 
   {
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
     lv2_wrapper->destroy_instance_locked();
   }
@@ -109,7 +110,7 @@ void BassEnhancer::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   if (!lv2_wrapper->found_plugin) {
     return;
@@ -129,7 +130,7 @@ void BassEnhancer::setup() {
       [this] {
         lv2_wrapper->create_instance(rate);
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         ready = true;
       },
@@ -141,9 +142,9 @@ void BassEnhancer::process(std::span<float>& left_in,
                            std::span<float>& right_in,
                            std::span<float>& left_out,
                            std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass) {
+  if (bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
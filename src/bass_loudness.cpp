@@ -25,6 +25,7 @@
 #include <format>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include "db_manager.hpp"
@@ -89,7 +90,7 @@ void BassLoudness::clear_data() {
   }
 
   {
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
     lv2_wrapper->destroy_instance_locked();
   }
@@ -103,7 +104,7 @@ void BassLoudness::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   if (!lv2_wrapper->found_plugin) {
     return;
@@ -123,7 +124,7 @@ void BassLoudness::setup() {
       [this] {
         lv2_wrapper->create_instance(rate);
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         ready = true;
       },
@@ -135,9 +136,9 @@ void BassLoudness::process(std::span<float>& left_in,
                            std::span<float>& right_in,
                            std::span<float>& left_out,
                            std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass) {
+  if (bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
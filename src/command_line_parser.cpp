@@ -21,17 +21,23 @@
 #include <qcommandlineparser.h>
 #include <qobject.h>
 #include <qtmetamacros.h>
+#include <sys/types.h>
 #include <KAboutData>
 #include <KLocalizedString>
 #include <QApplication>
 #include <QLoggingCategory>
 #include <QString>
 #include <cstdlib>
+#include <filesystem>
 #include <iostream>
 #include <memory>
 #include <string>
 #include "easyeffects_db.h"
+#include "offline_renderer.hpp"
 #include "pipeline_type.hpp"
+#ifdef ENABLE_BENCHMARKS
+#include "plugin_benchmark.hpp"
+#endif
 #include "presets_manager.hpp"
 #include "util.hpp"
 
@@ -54,7 +60,32 @@ CommandLineParser::CommandLineParser(KAboutData& about, QObject* parent)
        {{"s", "last-loaded-presets"}, i18n("Get the last loaded input and output presets.")},
        {"gapplication-service", i18n("Deprecated. Use --service-mode instead.")},
        {"service-mode", i18n("Start the application with service mode turned on.")},
-       {"debug", i18n("Enable debug messages.")}});
+       {"debug", i18n("Enable debug messages.")},
+       {"render",
+        i18n("Process an audio file with the effects of a preset without using PipeWire. Example: easyeffects "
+             "--render in.wav --preset music --out out.wav"),
+        i18n("input-file")},
+       {"preset", i18n("Preset used by --render. A local preset name or the path to a preset file."),
+        i18n("preset-name")},
+       {"out", i18n("Output file written by --render."), i18n("output-file")},
+       {"render-pipeline", i18n("Pipeline used by --render: input or output. The default is output."),
+        i18n("pipeline")},
+       {"render-quantum", i18n("Number of samples processed at a time by --render. The default is 512."),
+        i18n("samples")},
+       {"render-probe",
+        i18n("Audio file used by --render as the monitor of the output device. It is needed by the echo "
+             "canceller. Silence is used when it is not set."),
+        i18n("probe-file")}});
+
+#ifdef ENABLE_BENCHMARKS
+  parser->addOptions(
+      {{"bench", i18n("Measure the processing time of every plugin at several quanta and sampling rates.")},
+       {"bench-plugins", i18n("Comma separated list of the plugins measured by --bench."), i18n("plugins")},
+       {"bench-impulse", i18n("Impulse response used by the convolver in --bench."), i18n("impulse-file")},
+       {"bench-duration", i18n("Seconds of audio processed in each --bench measurement. The default is 1."),
+        i18n("seconds")},
+       {"bench-json", i18n("Also write the --bench results to a JSON file."), i18n("output-file")}});
+#endif
 }
 
 void CommandLineParser::set_is_primary(const bool& state) {
@@ -79,6 +110,106 @@ void CommandLineParser::process_hide_window(bool& show_window) {
   }
 }
 
+auto CommandLineParser::render_requested() const -> bool {
+  return parser->isSet("render");
+}
+
+auto CommandLineParser::process_render() -> int {
+  if (!parser->isSet("preset") || !parser->isSet("out")) {
+    std::cout << i18n("--render needs --preset and --out.").toStdString() << '\n';
+
+    return EXIT_FAILURE;
+  }
+
+  auto pipeline_type = PipelineType::output;
+
+  if (parser->isSet("render-pipeline")) {
+    const auto value = parser->value("render-pipeline");
+
+    if (value != "input" && value != "output") {
+      std::cout << i18n("Must specify pipeline type: input/output.").toStdString() << '\n';
+
+      return EXIT_FAILURE;
+    }
+
+    pipeline_type = (value == "input") ? PipelineType::input : PipelineType::output;
+  }
+
+  uint n_samples = 512U;
+
+  if (parser->isSet("render-quantum")) {
+    if (!util::str_to_num(parser->value("render-quantum").toStdString(), n_samples) || n_samples == 0U) {
+      std::cout << i18n("Provided an invalid quantum.").toStdString() << '\n';
+
+      return EXIT_FAILURE;
+    }
+  }
+
+  OfflineRenderer renderer(pipeline_type, n_samples);
+
+  if (parser->isSet("render-probe")) {
+    renderer.set_probe_file(parser->value("render-probe").toStdString());
+  }
+
+  if (!renderer.load_preset(parser->value("preset").toStdString())) {
+    std::cout << i18n("Failed to load the preset.").toStdString() << '\n';
+
+    return EXIT_FAILURE;
+  }
+
+  if (!renderer.render(parser->value("render").toStdString(), parser->value("out").toStdString())) {
+    std::cout << i18n("Failed to render the audio file.").toStdString() << '\n';
+
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+#ifdef ENABLE_BENCHMARKS
+
+auto CommandLineParser::bench_requested() const -> bool {
+  return parser->isSet("bench");
+}
+
+auto CommandLineParser::process_bench() -> int {
+  PluginBenchmark bench;
+
+  if (parser->isSet("bench-plugins")) {
+    bench.set_plugins_filter(parser->value("bench-plugins").split(",", Qt::SkipEmptyParts));
+  }
+
+  if (parser->isSet("bench-impulse")) {
+    bench.set_impulse_file(parser->value("bench-impulse").toStdString());
+  }
+
+  if (parser->isSet("bench-duration")) {
+    double seconds = 0.0;
+
+    if (!util::str_to_num(parser->value("bench-duration").toStdString(), seconds) || seconds <= 0.0) {
+      std::cout << i18n("Provided an invalid duration.").toStdString() << '\n';
+
+      return EXIT_FAILURE;
+    }
+
+    bench.set_duration(seconds);
+  }
+
+  const auto results = bench.run();
+
+  PluginBenchmark::print(results);
+
+  if (parser->isSet("bench-json")) {
+    if (!PluginBenchmark::write_json(results, std::filesystem::path{parser->value("bench-json").toStdString()})) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+#endif
+
 void CommandLineParser::process_events() {
   auto* pm = &presets::Manager::self();
 
@@ -42,6 +42,21 @@ class CommandLineParser : public QObject {
 
   void process_events();
 
+  [[nodiscard]] auto render_requested() const -> bool;
+
+  /**
+   * Runs the offline renderer with the options given in the command line and
+   * returns the exit code of the application.
+   */
+  auto process_render() -> int;
+
+#ifdef ENABLE_BENCHMARKS
+  [[nodiscard]] auto bench_requested() const -> bool;
+
+  // Runs the plugins benchmark and returns the exit code of the application
+  auto process_bench() -> int;
+#endif
+
   void set_is_primary(const bool& state);
 
  Q_SIGNALS:
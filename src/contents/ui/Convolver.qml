@@ -78,6 +78,11 @@ Kirigami.ScrollablePage {
             }
         }
 
+        function onKernelCombinationProgress(percentage: int) {
+            progressBar.indeterminate = false;
+            progressBar.value = percentage;
+        }
+
         function onKernelCombinationStopped() {
             progressBar.visible = false;
         }
@@ -196,6 +201,8 @@ Kirigami.ScrollablePage {
             text: i18n("Combine") // qmllint disable
             icon.name: "path-combine-symbolic"
             onTriggered: {
+                progressBar.indeterminate = true;
+                progressBar.value = 0;
                 progressBar.visible = true;
 
                 const saneCombinedImpulseName = combinedImpulseName.text.trim().replace(/(?:\.irs)+$/, "");
@@ -504,6 +511,37 @@ Kirigami.ScrollablePage {
                     convolverPage.pluginDB.wet = v;
                 }
             }
+
+            FormCard.FormComboBoxDelegate {
+                id: engine
+
+                verticalPadding: Kirigami.Units.smallSpacing
+                text: i18n("Engine") // qmllint disable
+                displayMode: FormCard.FormComboBoxDelegate.ComboBox
+                currentIndex: convolverPage.pluginDB.engine
+                editable: false
+                model: [PluginsPackage.zita, i18n("Native")] // qmllint disable
+                onActivated: idx => {
+                    convolverPage.pluginDB.engine = idx;
+                }
+            }
+
+            EeSpinBox {
+                id: nativeEngineThreads
+
+                visible: engine.currentIndex === 1
+                label: i18n("Threads") // qmllint disable
+                labelAbove: true
+                spinboxLayoutFillWidth: true
+                from: convolverPage.pluginDB.getMinValue("nativeEngineThreads")
+                to: convolverPage.pluginDB.getMaxValue("nativeEngineThreads")
+                value: convolverPage.pluginDB.nativeEngineThreads
+                decimals: 0
+                stepSize: 1
+                onValueModified: v => {
+                    convolverPage.pluginDB.nativeEngineThreads = v;
+                }
+            }
         }
     }
 
@@ -517,7 +555,7 @@ Kirigami.ScrollablePage {
 
     footer: RowLayout {
         Controls.Label {
-            text: i18n("Using %1", `<strong>${PluginsPackage.zita}</strong>`) // qmllint disable
+            text: i18n("Using %1", `<strong>${convolverPage.pluginDB.engine === 0 ? PluginsPackage.zita : PluginsPackage.ee}</strong>`) // qmllint disable
             textFormat: Text.RichText
             horizontalAlignment: Qt.AlignLeft
             verticalAlignment: Qt.AlignVCenter
@@ -86,6 +86,16 @@ Kirigami.Dialog {
             }
         }
 
+        EeSwitch {
+            label: i18n("Interpolate Between Measurements") // qmllint disable
+            subtitle: i18n("Mix the 3 measurements closest to the target orientation.") // qmllint disable
+            isChecked: sofaDialog.pluginDB?.sofaInterpolation ?? false
+            onCheckedChanged: {
+                if (isChecked !== sofaDialog.pluginDB.sofaInterpolation)
+                    sofaDialog.pluginDB.sofaInterpolation = isChecked;
+            }
+        }
+
         Controls.Label {
             Layout.alignment: Qt.AlignHCenter
             text: i18n("Status") // qmllint disable
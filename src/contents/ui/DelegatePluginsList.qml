@@ -36,6 +36,7 @@ Item {
     required property string translatedName
     required property var pluginDB
     required property var streamDB
+    property var pipelineInstance: null
 
     readonly property bool bypass: delegateItem.pluginDB?.bypass ?? false
 
@@ -64,7 +65,7 @@ Item {
         contentItem: GridLayout {
             id: pluginRowItem
 
-            columns: 4
+            columns: 5
             rows: 1
             columnSpacing: Kirigami.Units.smallSpacing
 
@@ -108,6 +109,45 @@ Item {
                 elide: Text.ElideRight
             }
 
+            Controls.Label {
+                id: dspLoadLabel
+
+                readonly property bool showLoad: DbMain.showPluginsDspLoad && !DbMain.collapsePluginsList
+
+                visible: showLoad
+                color: Kirigami.Theme.disabledTextColor
+                font.family: "monospace"
+                Controls.ToolTip.visible: showLoad && listItemDelegate.hovered && Controls.ToolTip.text !== ""
+                Controls.ToolTip.delay: Kirigami.Units.toolTipDelay
+
+                Timer {
+                    interval: 1000
+                    repeat: true
+                    triggeredOnStart: true
+                    running: dspLoadLabel.showLoad && delegateItem.pipelineInstance !== null && !delegateItem.bypass
+
+                    onTriggered: {
+                        const stats = delegateItem.pipelineInstance.getPluginInstance(delegateItem.name)?.getDspStats();
+
+                        if (stats === undefined || stats.count === 0) {
+                            dspLoadLabel.text = "";
+                            dspLoadLabel.Controls.ToolTip.text = "";
+
+                            return;
+                        }
+
+                        dspLoadLabel.text = `${(100 * stats.loadP99).toLocaleString(Qt.locale(), 'f', 0)} %`;
+
+                        const p50 = stats.p50.toLocaleString(Qt.locale(), 'f', 3);
+                        const p99 = stats.p99.toLocaleString(Qt.locale(), 'f', 3);
+                        const max = stats.max.toLocaleString(Qt.locale(), 'f', 3);
+                        const budget = stats.budget.toLocaleString(Qt.locale(), 'f', 3);
+
+                        dspLoadLabel.Controls.ToolTip.text = [i18n("50th percentile: %1 %2", p50, Units.ms), i18n("99th percentile: %1 %2", p99, Units.ms), i18n("Maximum: %1 %2", max, Units.ms), i18n("Budget: %1 %2", budget, Units.ms)].join("\n"); // qmllint disable
+                    }
+                }
+            }
+
             Kirigami.ActionToolBar {
                 id: pluginActionButtonControls
 
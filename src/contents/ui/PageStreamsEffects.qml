@@ -462,6 +462,7 @@ Kirigami.Page {
                         listModel: pluginsListModel
                         listView: pluginsListView
                         streamDB: pageStreamsEffects.streamDB
+                        pipelineInstance: pageStreamsEffects.pipelineInstance
                         onSelectedChanged: name => {
                             if (pageStreamsEffects.streamDB.visiblePlugin !== name) {
                                 pageStreamsEffects.streamDB.visiblePlugin = name;
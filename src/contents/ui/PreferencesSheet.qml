@@ -254,6 +254,45 @@ KirigamiSettings.ConfigurationView {
                     }
                 }
 
+                EeSwitch {
+                    id: skipSilentInput
+
+                    label: i18n("Skip silent effects") // qmllint disable
+                    subtitle: i18n("Stop processing an effect when its input has been silent for longer than its reverberation or delay time. Processing starts again with the first sound.") // qmllint disable
+                    maximumLineCount: -1
+                    isChecked: DbMain.skipSilentInput
+                    onCheckedChanged: {
+                        if (isChecked !== DbMain.skipSilentInput)
+                            DbMain.skipSilentInput = isChecked;
+                    }
+                }
+
+                EeSwitch {
+                    id: fusedEffectsChain
+
+                    label: i18n("Fused effects chain") // qmllint disable
+                    subtitle: i18n("Process the effects of each pipeline inside a single sound server node. This reduces the scheduling overhead of long chains. Effects that need probe ports keep their own node.") // qmllint disable
+                    maximumLineCount: -1
+                    isChecked: DbMain.fusedEffectsChain
+                    onCheckedChanged: {
+                        if (isChecked !== DbMain.fusedEffectsChain)
+                            DbMain.fusedEffectsChain = isChecked;
+                    }
+                }
+
+                EeSwitch {
+                    id: hardBypass
+
+                    label: i18n("Unlink bypassed effects") // qmllint disable
+                    subtitle: i18n("Remove bypassed effects from the pipeline instead of passing the audio through them. A bypassed effect does not use the processor until it is enabled again.") // qmllint disable
+                    maximumLineCount: -1
+                    isChecked: DbMain.hardBypass
+                    onCheckedChanged: {
+                        if (isChecked !== DbMain.hardBypass)
+                            DbMain.hardBypass = isChecked;
+                    }
+                }
+
                 EeSwitch {
                     id: resetBypassOnDeviceChange
 
@@ -549,6 +588,72 @@ KirigamiSettings.ConfigurationView {
                     }
                 }
             }
+
+            FormCard.FormHeader {
+                title: i18n("Analysis") // qmllint disable
+            }
+
+            FormCard.FormCard {
+                FormCard.FormComboBoxDelegate {
+                    id: fftSize
+
+                    text: i18n("FFT size") // qmllint disable
+                    displayMode: FormCard.FormComboBoxDelegate.ComboBox
+                    currentIndex: DbSpectrum.fftSize
+                    editable: false
+                    model: ["1024", "2048", "4096", "8192", "16384", "32768", "65536"]
+                    onActivated: idx => {
+                        if (idx !== DbSpectrum.fftSize)
+                            DbSpectrum.fftSize = idx;
+                    }
+                }
+
+                FormCard.FormComboBoxDelegate {
+                    id: fftOverlap
+
+                    text: i18n("Overlap") // qmllint disable
+                    displayMode: FormCard.FormComboBoxDelegate.ComboBox
+                    currentIndex: DbSpectrum.fftOverlap
+                    editable: false
+                    model: [i18n("None"), "50%", "75%", "87.5%"] // qmllint disable
+                    onActivated: idx => {
+                        if (idx !== DbSpectrum.fftOverlap)
+                            DbSpectrum.fftOverlap = idx;
+                    }
+                }
+
+                FormCard.FormComboBoxDelegate {
+                    id: averaging
+
+                    text: i18n("Averaging") // qmllint disable
+                    displayMode: FormCard.FormComboBoxDelegate.ComboBox
+                    currentIndex: DbSpectrum.averaging
+                    editable: false
+                    model: [i18n("None"), i18n("Peak Hold"), i18n("Exponential"), i18n("Welch")] // qmllint disable
+                    onActivated: idx => {
+                        if (idx !== DbSpectrum.averaging)
+                            DbSpectrum.averaging = idx;
+                    }
+                }
+
+                EeSpinBox {
+                    id: averagingTime
+
+                    label: i18n("Averaging time") // qmllint disable
+                    subtitle: i18n("Decay time constant of the peak hold and exponential averaging.") // qmllint disable
+                    maximumLineCount: -1
+                    from: DbSpectrum.getMinValue("averagingTime")
+                    to: DbSpectrum.getMaxValue("averagingTime")
+                    value: DbSpectrum.averagingTime
+                    decimals: 2
+                    stepSize: 0.05
+                    unit: Units.s
+                    enabled: DbSpectrum.averaging === 1 || DbSpectrum.averaging === 2
+                    onValueModified: v => {
+                        DbSpectrum.averagingTime = v;
+                    }
+                }
+            }
         }
     }
 
@@ -624,6 +729,20 @@ KirigamiSettings.ConfigurationView {
                     }
                 }
 
+                EeSwitch {
+                    id: showPluginsDspLoad
+
+                    label: i18n("Show effects processing load") // qmllint disable
+                    subtitle: i18n("Show next to each effect the fraction of the processing time budget it uses. The tooltip has the 50th and 99th percentiles and the maximum time spent by the effect.") // qmllint disable
+                    maximumLineCount: -1
+                    isChecked: DbMain.showPluginsDspLoad
+                    onCheckedChanged: {
+                        if (isChecked !== DbMain.showPluginsDspLoad) {
+                            DbMain.showPluginsDspLoad = isChecked;
+                        }
+                    }
+                }
+
                 FormCard.FormComboBoxDelegate {
                     text: i18n("Color scheme") // qmllint disable
                     displayMode: FormCard.FormComboBoxDelegate.ComboBox
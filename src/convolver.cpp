@@ -26,6 +26,7 @@
 #include <qpoint.h>
 #include <qstandardpaths.h>
 #include <qthread.h>
+#include <qtimer.h>
 #include <qtmetamacros.h>
 #include <qtypes.h>
 #include <sched.h>
@@ -34,15 +35,24 @@
 #include <zita-convolver.h>
 #include <QString>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <format>
+#include <memory>
 #include <mutex>
+#include <numbers>
+#include <numeric>
+#include <shared_mutex>
 #include <sndfile.hh>
 #include <span>
 #include <string>
 #include <vector>
 #include "convolver_kernel_fft.hpp"
+#include "convolver_engine.hpp"
 #include "convolver_kernel_manager.hpp"
+#include "convolver_native.hpp"
+#include "convolver_zita.hpp"
 #include "db_manager.hpp"
 #include "easyeffects_db_convolver.h"
 #include "pipeline_type.hpp"
@@ -69,16 +79,34 @@ Convolver::Convolver(const std::string& tag, pw::Manager* pipe_manager, Pipeline
 
   wet = (settings->wet() <= util::minimum_db_d_level) ? 0.0F : static_cast<float>(util::db_to_linear(settings->wet()));
 
-  connect(settings, &DbConvolver::kernelNameChanged, [&]() { load_kernel_file(true, rate); });
+  connect(settings, &DbConvolver::kernelNameChanged, [&]() {
+    QMetaObject::invokeMethod(worker, [this] { load_kernel_file(true, rate); }, Qt::QueuedConnection);
+  });
+
+  connect(settings, &DbConvolver::sofaInterpolationChanged, [&]() {
+    if (kernelIsSofa) {
+      applySofaOrientation();
+    }
+  });
+
+  // The new width and autogain are applied to a second engine instance that replaces the current one
 
   connect(settings, &DbConvolver::irWidthChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(data_mutex);
-    zita.update_ir_width_and_autogain(settings->irWidth(), settings->autogain(), true);
+    QMetaObject::invokeMethod(worker, [this] { prepare_engine(); }, Qt::QueuedConnection);
   });
 
   connect(settings, &DbConvolver::autogainChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(data_mutex);
-    zita.update_ir_width_and_autogain(settings->irWidth(), settings->autogain(), true);
+    QMetaObject::invokeMethod(worker, [this] { prepare_engine(); }, Qt::QueuedConnection);
+  });
+
+  // The engines may use different block sizes. So the convolver is reinitialized when switching.
+
+  connect(settings, &DbConvolver::engineChanged, [&]() { setup(); });
+
+  connect(settings, &DbConvolver::nativeEngineThreadsChanged, [&]() {
+    if (settings->engine() == native_engine) {
+      QMetaObject::invokeMethod(worker, [this] { prepare_engine(); }, Qt::QueuedConnection);
+    }
   });
 
   connect(settings, &DbConvolver::dryChanged, [&]() {
@@ -99,37 +127,39 @@ Convolver::Convolver(const std::string& tag, pw::Manager* pipe_manager, Pipeline
 
   connect(
       worker, &ConvolverWorker::onNewKernel, this,
-      [this](ConvolverKernelManager::KernelData data, bool init_zita) {
-        kernel_is_initialized = data.isValid();
+      [this](ConvolverKernelStore::Handle kernel) {
+        kernel_is_initialized = kernel != nullptr;
 
         if (kernel_is_initialized) {
-          kernelIsSofa = data.is_sofa;
-          kernelRate = QString::fromStdString(util::to_string(data.original_rate));
-          kernelSamples = QString::fromStdString(util::to_string(data.sampleCount()));
-          kernelDuration = QString::fromStdString(util::to_string(data.duration()));
-          kernelChannels = data.channels;
+          tail_seconds = static_cast<float>(kernel->duration());
+
+          kernelIsSofa = kernel->is_sofa;
+          kernelRate = QString::fromStdString(util::to_string(kernel->original_rate));
+          kernelSamples = QString::fromStdString(util::to_string(kernel->sampleCount()));
+          kernelDuration = QString::fromStdString(util::to_string(kernel->duration()));
+          kernelChannels = kernel->channels;
 
           Q_EMIT kernelIsSofaChanged();
           Q_EMIT kernelRateChanged();
           Q_EMIT kernelDurationChanged();
           Q_EMIT kernelSamplesChanged();
           Q_EMIT kernelChannelsChanged();
-          Q_EMIT newKernelLoaded(data.name, true);
-
-          if (data.is_sofa) {
-            sofaDatabase = data.sofaMetadata.database;
-            sofaMeasurements = data.sofaMetadata.measurements;
-            sofaIndex = data.sofaMetadata.index;
-            sofaAzimuth = data.sofaMetadata.azimuth;
-            sofaElevation = data.sofaMetadata.elevation;
-            sofaRadius = data.sofaMetadata.radius;
-
-            sofaMinAzimuth = data.sofaMetadata.min_azimuth;
-            sofaMaxAzimuth = data.sofaMetadata.max_azimuth;
-            sofaMinElevation = data.sofaMetadata.min_elevation;
-            sofaMaxElevation = data.sofaMetadata.max_elevation;
-            sofaMinRadius = data.sofaMetadata.min_radius;
-            sofaMaxRadius = data.sofaMetadata.max_radius;
+          Q_EMIT newKernelLoaded(kernel->name, true);
+
+          if (kernel->is_sofa) {
+            sofaDatabase = kernel->sofaMetadata.database;
+            sofaMeasurements = kernel->sofaMetadata.measurements;
+            sofaIndex = kernel->sofaMetadata.index;
+            sofaAzimuth = kernel->sofaMetadata.azimuth;
+            sofaElevation = kernel->sofaMetadata.elevation;
+            sofaRadius = kernel->sofaMetadata.radius;
+
+            sofaMinAzimuth = kernel->sofaMetadata.min_azimuth;
+            sofaMaxAzimuth = kernel->sofaMetadata.max_azimuth;
+            sofaMinElevation = kernel->sofaMetadata.min_elevation;
+            sofaMaxElevation = kernel->sofaMetadata.max_elevation;
+            sofaMinRadius = kernel->sofaMetadata.min_radius;
+            sofaMaxRadius = kernel->sofaMetadata.max_radius;
 
             Q_EMIT sofaDatabaseChanged();
             Q_EMIT sofaMeasurementsChanged();
@@ -145,18 +175,6 @@ Convolver::Convolver(const std::string& tag, pw::Manager* pipe_manager, Pipeline
             Q_EMIT sofaMinRadiusChanged();
             Q_EMIT sofaMaxRadiusChanged();
           }
-
-          if (init_zita) {
-            std::scoped_lock<std::mutex> lock(data_mutex);
-
-            auto success = zita.init(data, blocksize, settings->irWidth(), settings->autogain());
-
-            if (!success) {
-              util::warning(std::format("{} Zita init failed", log_tag));
-            }
-
-            ready = success;
-          }
         }
       },
       Qt::QueuedConnection);
@@ -202,7 +220,8 @@ Convolver::Convolver(const std::string& tag, pw::Manager* pipe_manager, Pipeline
   QMetaObject::invokeMethod(
       worker,
       [this] {
-        if (ready || destructor_called) {
+        // Without a PipeWire manager (offline rendering) setup() loads the kernel
+        if (ready || destructor_called || pm == nullptr) {
           return;
         }
 
@@ -223,7 +242,7 @@ Convolver::Convolver(const std::string& tag, pw::Manager* pipe_manager, Pipeline
 Convolver::~Convolver() {
   stop_worker();
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   destructor_called = true;
   ready = false;
@@ -232,7 +251,14 @@ Convolver::~Convolver() {
     disconnect_from_pw();
   }
 
-  zita.stop();
+  // The realtime thread does not run after the disconnection
+  delete_retired_engine();
+
+  delete engine_pending.exchange(nullptr);
+
+  if (engine != nullptr) {
+    engine->stop();
+  }
 
   settings->disconnect();
 
@@ -253,12 +279,12 @@ void Convolver::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   ready = false;
 
   /**
-   * As zita uses fftw we have to be careful when reinitializing it.
+   * As the engines use fftw we have to be careful when reinitializing it.
    * The thread that creates the fftw plan has to be the same that destroys it.
    * Otherwise segmentation faults can happen. As we do not want to do this
    * initializing in the plugin realtime thread we send it to the worker thread
@@ -275,27 +301,40 @@ void Convolver::setup() {
 
         blocksize = n_samples;
 
-        n_samples_is_power_of_2 = (n_samples & (n_samples - 1U)) == 0U && n_samples != 0U;
+        // The native engine works with any quantum. Zita needs a power of 2.
 
-        if (!n_samples_is_power_of_2) {
+        block_is_quantum =
+            settings->engine() == native_engine || ((n_samples & (n_samples - 1U)) == 0U && n_samples != 0U);
+
+        if (!block_is_quantum) {
           while ((blocksize & (blocksize - 1)) != 0 && blocksize > 2) {
             blocksize--;
           }
+
+          blocksize = std::max<uint>(blocksize, 64);  // zita does not work with less than 64
         }
 
-        blocksize = std::max<uint>(blocksize, 64);  // zita does not work with less than 64
+        /**
+         * When the quantum is not a multiple of the block size the output
+         * starts with enough zeros to always have a full quantum available.
+         * This way the latency does not change from one cycle to the next.
+         */
+        latency_n_frames = block_is_quantum ? 0U : blocksize - std::gcd(n_samples, blocksize);
+
+        for (auto* buf : {&buf_in_L, &buf_in_R, &buf_out_L, &buf_out_R}) {
+          buf->set_capacity(2U * (static_cast<size_t>(n_samples) + blocksize));
+        }
 
-        buf_in_L.clear();
-        buf_in_R.clear();
-        buf_out_L.clear();
-        buf_out_R.clear();
+        buf_out_L.push_zeros(latency_n_frames);
+        buf_out_R.push_zeros(latency_n_frames);
 
         data_L.resize(blocksize);
         data_R.resize(blocksize);
 
-        notify_latency = true;
+        fade_L.resize(std::max(n_samples, blocksize));
+        fade_R.resize(std::max(n_samples, blocksize));
 
-        latency_n_frames = 0U;
+        notify_latency = true;
 
         load_kernel_file(true, rate);
       },
@@ -308,9 +347,9 @@ void Convolver::process(std::span<float>& left_in,
                         std::span<float>& right_in,
                         std::span<float>& left_out,
                         std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass) {
+  if (bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
@@ -332,48 +371,40 @@ void Convolver::process(std::span<float>& left_in,
     apply_gain(left_in, right_in, input_gain);
   }
 
-  if (n_samples_is_power_of_2) {
+  // A new instance is only taken after the previous replaced one was deleted
+
+  if (engine_next == nullptr && engine_retired.load(std::memory_order_acquire) == nullptr) {
+    if (auto* next = engine_pending.exchange(nullptr, std::memory_order_acq_rel); next != nullptr) {
+      engine_next.reset(next);
+
+      crossfade_position = 0U;
+    }
+  }
+
+  if (block_is_quantum) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
-    zita.process(left_out, right_out);
+    process_engine(left_out, right_out);
   } else {
-    buf_in_L.insert(buf_in_L.end(), left_in.begin(), left_in.end());
-    buf_in_R.insert(buf_in_R.end(), right_in.begin(), right_in.end());
+    buf_in_L.push(left_in);
+    buf_in_R.push(right_in);
 
     while (buf_in_L.size() >= blocksize) {
-      util::copy_bulk(buf_in_L, data_L);
-      util::copy_bulk(buf_in_R, data_R);
+      buf_in_L.pop(data_L);
+      buf_in_R.pop(data_R);
 
-      zita.process(data_L, data_R);
+      process_engine(data_L, data_R);
 
-      buf_out_L.insert(buf_out_L.end(), data_L.begin(), data_L.end());
-      buf_out_R.insert(buf_out_R.end(), data_R.begin(), data_R.end());
+      buf_out_L.push(data_L);
+      buf_out_R.push(data_R);
     }
 
-    // copying the processed samples to the output buffers
-
-    if (buf_out_L.size() >= n_samples) {
-      util::copy_bulk(buf_out_L, left_out);
-      util::copy_bulk(buf_out_R, right_out);
-    } else {
-      const uint offset = n_samples - buf_out_L.size();
-
-      if (offset != latency_n_frames) {
-        latency_n_frames = offset;
-
-        notify_latency = true;
-      }
-
-      // Fill beginning with zeros
-      std::fill_n(left_out.begin(), offset, 0.0F);
-      std::fill_n(right_out.begin(), offset, 0.0F);
-
-      std::ranges::copy(buf_out_L, left_out.begin() + offset);
-      std::ranges::copy(buf_out_R, right_out.begin() + offset);
+    // The zeros added in setup guarantee a full quantum here
 
-      buf_out_L.clear();
-      buf_out_R.clear();
+    if (!buf_out_L.pop(left_out) || !buf_out_R.pop(right_out)) {
+      std::ranges::fill(left_out, 0.0F);
+      std::ranges::fill(right_out, 0.0F);
     }
   }
 
@@ -402,6 +433,134 @@ void Convolver::process(std::span<float>& left_in,
   }
 }
 
+void Convolver::process_engine(std::span<float> left, std::span<float> right) {
+  if (engine_next == nullptr) {
+    engine->process(left, right);
+
+    return;
+  }
+
+  auto next_left = std::span(fade_L).first(left.size());
+  auto next_right = std::span(fade_R).first(right.size());
+
+  std::ranges::copy(left, next_left.begin());
+  std::ranges::copy(right, next_right.begin());
+
+  engine->process(left, right);
+  engine_next->process(next_left, next_right);
+
+  // Equal power crossfade from the current instance to the new one
+
+  const auto crossfade_frames = std::max(static_cast<uint>(crossfade_seconds * static_cast<float>(rate)), 1U);
+
+  for (size_t n = 0U; n < left.size(); n++) {
+    const auto t = std::min(static_cast<float>(crossfade_position) / static_cast<float>(crossfade_frames), 1.0F);
+
+    const auto gain_current = std::cos(0.5F * std::numbers::pi_v<float> * t);
+    const auto gain_next = std::sin(0.5F * std::numbers::pi_v<float> * t);
+
+    left[n] = (gain_current * left[n]) + (gain_next * next_left[n]);
+    right[n] = (gain_current * right[n]) + (gain_next * next_right[n]);
+
+    crossfade_position++;
+  }
+
+  if (crossfade_position < crossfade_frames) {
+    return;
+  }
+
+  engine_retired.store(engine.release(), std::memory_order_release);
+
+  engine = std::move(engine_next);
+
+  if (pm == nullptr) {
+    // Offline rendering is not realtime
+    delete_retired_engine();
+  }
+}
+
+void Convolver::delete_retired_engine() {
+  delete engine_retired.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+void Convolver::prepare_engine() {
+  if (destructor_called || loaded_kernel == nullptr || rate == 0U || n_samples == 0U) {
+    return;
+  }
+
+  auto key = loaded_kernel_key;
+
+  key.ir_width = settings->irWidth();
+  key.autogain = settings->autogain();
+
+  // The engines copy the kernel to their partitions. So this one is only shared while other instances use it.
+
+  const auto kernel = ConvolverKernelStore::self().get(key, [&] {
+    auto data = *loaded_kernel;
+
+    ConvolverKernelManager::applyStereoWidth(data, key.ir_width);
+
+    if (key.autogain) {
+      ConvolverKernelManager::applyAutogain(data);
+    }
+
+    return data;
+  });
+
+  if (kernel == nullptr) {
+    return;
+  }
+
+  std::unique_ptr<ConvolverEngine> new_engine;
+
+  if (settings->engine() == native_engine) {
+    new_engine = std::make_unique<ConvolverNative>(static_cast<uint>(settings->nativeEngineThreads()));
+  } else {
+    new_engine = std::make_unique<ConvolverZita>();
+  }
+
+  if (!new_engine->init(*kernel, blocksize)) {
+    util::warning(std::format("{} {} engine init failed", log_tag,
+                              settings->defaultEngineLabelsValue()[settings->engine()].toStdString()));
+
+    return;
+  }
+
+  // Instances replaced here are deleted after the lock is released
+
+  std::unique_ptr<ConvolverEngine> old_engine, old_next, old_pending;
+
+  {
+    std::scoped_lock<rt::DataMutex> lock(data_mutex);
+
+    if (!ready) {
+      // Nothing is being convolved. The new instance can be used right away.
+
+      old_engine = std::move(engine);
+      old_next = std::move(engine_next);
+      old_pending.reset(engine_pending.exchange(nullptr));
+
+      engine = std::move(new_engine);
+
+      ready = true;
+
+      return;
+    }
+  }
+
+  // The realtime thread only takes a new instance after the one replaced by the last crossfade was deleted
+
+  delete_retired_engine();
+
+  // The realtime thread crossfades to it. A pending instance it did not take yet is outdated.
+
+  old_pending.reset(engine_pending.exchange(new_engine.release(), std::memory_order_acq_rel));
+
+  // Freeing the instance replaced by this crossfade does not have to wait for the next kernel change
+
+  QTimer::singleShot(retire_delay, worker, [this]() { delete_retired_engine(); });
+}
+
 void Convolver::process([[maybe_unused]] std::span<float>& left_in,
                         [[maybe_unused]] std::span<float>& right_in,
                         [[maybe_unused]] std::span<float>& left_out,
@@ -409,27 +568,33 @@ void Convolver::process([[maybe_unused]] std::span<float>& left_in,
                         [[maybe_unused]] std::span<float>& probe_left,
                         [[maybe_unused]] std::span<float>& probe_right) {}
 
-void Convolver::load_kernel_file(const bool& init_zita, const uint& server_sampling_rate) {
+void Convolver::load_kernel_file(const bool& init_engine, const uint& server_sampling_rate) {
   if (destructor_called) {
     return;
   }
 
   const auto name = settings->kernelName();
 
-  auto kernel_data = kernel_manager.loadKernel(name.toStdString());
+  ConvolverKernelStore::Key key{.source = kernel_manager.searchKernelPath(name.toStdString()),
+                                .rate = server_sampling_rate};
+
+  if (ConvolverKernelManager::getFileExtension(key.source) == ConvolverKernelManager::sofa_ext) {
+    key.source += std::format("#{}/{}/{}/{}", settings->targetSofaAzimuth(), settings->targetSofaElevation(),
+                              settings->targetSofaRadius(), settings->sofaInterpolation());
+  }
 
-  if (!kernel_data.isValid()) {
+  // The kernel manager resamples the kernel to the server rate, reusing a cached copy when possible
+
+  const auto kernel = ConvolverKernelStore::self().get(
+      key, [&] { return kernel_manager.loadKernel(name.toStdString(), server_sampling_rate); });
+
+  if (kernel == nullptr) {
     Q_EMIT worker->onInvalidKernel(name);
 
     return;
   }
 
-  if (server_sampling_rate != 0 && kernel_data.rate != server_sampling_rate) {
-    util::debug(std::format("{}{} kernel has {} rate. Resampling it to {}", log_tag, name.toStdString(),
-                            kernel_data.rate, server_sampling_rate));
-
-    kernel_data = ConvolverKernelManager::resampleKernel(kernel_data, server_sampling_rate);
-  }
+  const auto& kernel_data = *kernel;
 
   const auto dt = 1.0 / kernel_data.rate;
 
@@ -461,8 +626,6 @@ void Convolver::load_kernel_file(const bool& init_zita, const uint& server_sampl
 
   util::debug(std::format("{}{}: kernel correctly loaded", log_tag, name.toStdString()));
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
   ConvolverKernelFFT kernel_fft;
 
   kernel_fft.calculate_fft(kernel_data.channel_L, kernel_data.channel_R, kernel_data.original_rate, interpPoints);
@@ -471,7 +634,14 @@ void Convolver::load_kernel_file(const bool& init_zita, const uint& server_sampl
 
   Q_EMIT worker->onNewSpectrum(kernel_fft.linear_L, kernel_fft.linear_R, kernel_fft.log_L, kernel_fft.log_R);
 
-  Q_EMIT worker->onNewKernel(kernel_data, init_zita);
+  loaded_kernel = kernel;
+  loaded_kernel_key = key;
+
+  if (init_engine) {
+    prepare_engine();
+  }
+
+  Q_EMIT worker->onNewKernel(kernel);
 }
 
 auto Convolver::get_latency_seconds() -> float {
@@ -481,7 +651,8 @@ auto Convolver::get_latency_seconds() -> float {
 void Convolver::combine_kernels(const std::string& kernel_1_name,
                                 const std::string& kernel_2_name,
                                 const std::string& output_file_name) {
-  kernel_manager.combineKernels(kernel_1_name, kernel_2_name, output_file_name);
+  kernel_manager.combineKernels(kernel_1_name, kernel_2_name, output_file_name,
+                                [this](const int& percentage) { Q_EMIT kernelCombinationProgress(percentage); });
 
   Q_EMIT kernelCombinationStopped();
 }
@@ -505,5 +676,7 @@ void Convolver::clear_chart_data() {
 }
 
 void Convolver::applySofaOrientation() {
-  setup();
+  // The kernel at the new orientation is crossfaded in without resetting the plugin
+
+  QMetaObject::invokeMethod(worker, [this] { load_kernel_file(true, rate); }, Qt::QueuedConnection);
 }
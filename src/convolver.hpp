@@ -25,25 +25,29 @@
 #include <qqmlintegration.h>
 #include <qtmetamacros.h>
 #include <sys/types.h>
-#include <zita-convolver.h>
 #include <QString>
 #include <QThread>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <span>
 #include <string>
 #include <vector>
+#include "convolver_engine.hpp"
 #include "convolver_kernel_fft.hpp"
 #include "convolver_kernel_manager.hpp"
-#include "convolver_zita.hpp"
+#include "convolver_kernel_store.hpp"
 #include "easyeffects_db_convolver.h"
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
+#include "rt_ring_buffer.hpp"
 
 class ConvolverWorker : public QObject {
   Q_OBJECT
 
  Q_SIGNALS:
-  void onNewKernel(ConvolverKernelManager::KernelData data, bool init_zita);
+  void onNewKernel(ConvolverKernelStore::Handle kernel);
 
   void onNewChartMag(QList<QPointF> mag_L, QList<QPointF> mag_R);
 
@@ -120,6 +124,9 @@ class Convolver : public PluginBase {
 
   Q_INVOKABLE void applySofaOrientation();
 
+  // Deletes the instance replaced by the last crossfade. Called by the worker.
+  void delete_retired_engine();
+
  Q_SIGNALS:
   void newKernelLoaded(QString name, bool success);
 
@@ -153,6 +160,8 @@ class Convolver : public PluginBase {
   void chartMagLfftLogChanged();
   void chartMagRfftLogChanged();
 
+  void kernelCombinationProgress(int percentage);
+
   void kernelCombinationStopped();
 
  private:
@@ -160,11 +169,13 @@ class Convolver : public PluginBase {
 
   bool kernel_is_initialized = false;
   bool kernelIsSofa = false;
-  bool n_samples_is_power_of_2 = true;
+  bool block_is_quantum = true;
   bool ready = false;
   bool destructor_called = false;
   bool notify_latency = false;
 
+  static constexpr int native_engine = 1;  // Index in the engineLabels setting
+
   uint blocksize = 512U;
   uint latency_n_frames = 0U;
 
@@ -191,8 +202,9 @@ class Convolver : public PluginBase {
   QString kernelDuration;
 
   std::vector<float> data_L, data_R;
-  std::vector<float> buf_in_L, buf_in_R;
-  std::vector<float> buf_out_L, buf_out_R;
+
+  rt::RingBuffer<float> buf_in_L, buf_in_R;
+  rt::RingBuffer<float> buf_out_L, buf_out_R;
 
   QList<QPointF> chartMagL, chartMagR, chartMagLfftLinear, chartMagRfftLinear, chartMagLfftLog, chartMagRfftLog;
 
@@ -200,11 +212,39 @@ class Convolver : public PluginBase {
 
   ConvolverKernelFFT kernel_fft;
 
-  ConvolverZita zita;
+  /**
+   * New kernels are prepared by the worker in a second instance. The realtime
+   * thread takes it from engine_pending, crossfades from engine to engine_next and
+   * hands the replaced instance to engine_retired. The worker deletes it before
+   * publishing the next instance and once more after retire_delay.
+   */
+
+  std::unique_ptr<ConvolverEngine> engine, engine_next;
+
+  std::atomic<ConvolverEngine*> engine_pending = nullptr;
+  std::atomic<ConvolverEngine*> engine_retired = nullptr;
+
+  static constexpr float crossfade_seconds = 0.02F;
+
+  static constexpr auto retire_delay = std::chrono::seconds(1);
+
+  uint crossfade_position = 0U;
+
+  std::vector<float> fade_L, fade_R;
+
+  // Kernel shared with the other instances using the same impulse. Only used by the worker.
+
+  ConvolverKernelStore::Handle loaded_kernel;
+
+  ConvolverKernelStore::Key loaded_kernel_key;
 
   ConvolverWorker* worker;
 
-  void load_kernel_file(const bool& init_zita, const uint& server_sampling_rate);
+  void load_kernel_file(const bool& init_engine, const uint& server_sampling_rate);
+
+  void prepare_engine();
+
+  void process_engine(std::span<float> left, std::span<float> right);
 
   void combine_kernels(const std::string& kernel_1_name,
                        const std::string& kernel_2_name,
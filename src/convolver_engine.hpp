@@ -0,0 +1,43 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <qtypes.h>
+#include <span>
+#include "convolver_kernel_manager.hpp"
+
+// Applies the Convolver kernel to blocks of a fixed size
+class ConvolverEngine {
+ public:
+  ConvolverEngine() = default;
+  ConvolverEngine(const ConvolverEngine&) = delete;
+  auto operator=(const ConvolverEngine&) -> ConvolverEngine& = delete;
+  ConvolverEngine(const ConvolverEngine&&) = delete;
+  auto operator=(const ConvolverEngine&&) -> ConvolverEngine& = delete;
+  virtual ~ConvolverEngine() = default;
+
+  // The stereo width and the autogain have to be applied to the kernel before
+  virtual auto init(const ConvolverKernelManager::KernelData& kernel, uint bufferSize) -> bool = 0;
+
+  // Convolves bufferSize samples in place
+  virtual auto process(std::span<float> left, std::span<float> right) -> bool = 0;
+
+  virtual void stop() = 0;
+};
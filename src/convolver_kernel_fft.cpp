@@ -26,9 +26,9 @@
 #include <cmath>
 #include <cstring>
 #include <format>
-#include <mutex>
 #include <numbers>
 #include <vector>
+#include "fftw_planner.hpp"
 #include "util.hpp"
 
 ConvolverKernelFFT::ConvolverKernelFFT() = default;
@@ -118,8 +118,6 @@ auto ConvolverKernelFFT::apply_hanning_window(std::vector<float>& signal) -> voi
 }
 
 auto ConvolverKernelFFT::compute_fft_magnitude(std::vector<float>& kernel) -> std::vector<double> {
-  std::scoped_lock<std::mutex> lock(util::fftw_lock());
-
   if (kernel.empty() || kernel.size() < 2) {
     return {};
   }
@@ -148,7 +146,9 @@ auto ConvolverKernelFFT::compute_fft_magnitude(std::vector<float>& kernel) -> st
     real_input[n] = static_cast<double>(kernel[n]);
   }
 
-  auto* plan = fftw_plan_dft_r2c_1d(static_cast<int>(kernel.size()), real_input, complex_output, FFTW_ESTIMATE);
+  auto* plan = FftwPlanner::self().run([&] {
+    return fftw_plan_dft_r2c_1d(static_cast<int>(kernel.size()), real_input, complex_output, FFTW_ESTIMATE);
+  });
 
   if (plan == nullptr) {
     util::debug("FFTW plan creation failed!");
@@ -180,7 +180,8 @@ auto ConvolverKernelFFT::compute_fft_magnitude(std::vector<float>& kernel) -> st
     spectrum[i] = static_cast<double>(util::linear_to_db(mag));
   }
 
-  fftw_destroy_plan(plan);
+  FftwPlanner::self().run([&] { fftw_destroy_plan(plan); });
+
   fftw_free(complex_output);
   fftw_free(real_input);
 
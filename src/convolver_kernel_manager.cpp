@@ -18,26 +18,36 @@
  */
 
 #include "convolver_kernel_manager.hpp"
-#include <mysofa.h>
+#include <fftw3.h>
+#include <qcryptographichash.h>
+#include <qfile.h>
+#include <qiodevicebase.h>
+#include <qsavefile.h>
 #include <qstandardpaths.h>
 #include <qtypes.h>
 #include <sndfile.h>
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cctype>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <exception>
 #include <execution>
 #include <filesystem>
 #include <format>
+#include <functional>
 #include <memory>
 #include <numeric>
 #include <sndfile.hh>
 #include <string>
-#include <utility>
 #include <vector>
+#include "convolver_sofa_database.hpp"
 #include "db_manager.hpp"
 #include "easyeffects_db_convolver.h"
+#include "fftw_planner.hpp"
 #include "pipeline_type.hpp"
 #include "resampler.hpp"
 #include "tags_app.hpp"
@@ -47,7 +57,8 @@ ConvolverKernelManager::ConvolverKernelManager(DbConvolver* settings, const Pipe
     : settings(settings),
       pipeline_type(pipeline_type),
       app_data_dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation).toStdString()),
-      local_dir_irs(app_data_dir + "/irs") {
+      local_dir_irs(app_data_dir + "/irs"),
+      cache_dir_irs(QStandardPaths::writableLocation(QStandardPaths::CacheLocation).toStdString() + "/irs") {
   /**
    * Flatpak specific path (.flatpak-info always present for apps running in
    * the flatpak sandbox)
@@ -80,7 +91,7 @@ auto ConvolverKernelManager::KernelData::sampleCount() const -> size_t {
   return channel_L.size();
 }
 
-auto ConvolverKernelManager::loadKernel(const std::string& name) -> KernelData {
+auto ConvolverKernelManager::loadKernel(const std::string& name, const uint& target_rate) -> KernelData {
   if (name.empty()) {
     util::warning("Kernel name is empty");
 
@@ -98,8 +109,34 @@ auto ConvolverKernelManager::loadKernel(const std::string& name) -> KernelData {
 
   const auto extension = getFileExtension(file_path);
 
+  /**
+   * The kernel taken from a SOFA file depends on the target position set by the
+   * user. So only impulse files are cached. Their sampling rate is read from the
+   * header first because hashing the whole file is only needed when it has to
+   * be resampled.
+   */
+  std::string cache_path;
+
+  if (extension != sofa_ext && target_rate != 0U &&
+      SndfileHandle(file_path).samplerate() != static_cast<int>(target_rate)) {
+    cache_path = getCachePath(file_path, target_rate);
+  }
+
+  if (!cache_path.empty()) {
+    kernel_data = readCachedKernel(cache_path);
+
+    if (kernel_data.isValid()) {
+      kernel_data.name = QString::fromStdString(name);
+      kernel_data.file_path = QString::fromStdString(file_path);
+
+      util::debug(std::format("Loaded kernel '{}' from the cache file {}", name, cache_path));
+
+      return kernel_data;
+    }
+  }
+
   if (extension == sofa_ext) {
-    kernel_data = readSofaKernelFile(file_path);
+    kernel_data = readSofaKernelFile(file_path, target_rate);
   } else {
     kernel_data = readKernelFile(file_path);
   }
@@ -115,12 +152,196 @@ auto ConvolverKernelManager::loadKernel(const std::string& name) -> KernelData {
   util::debug(std::format("Loaded kernel '{}': {} Hz, {} samples, {:.3f}s", name, kernel_data.rate,
                           kernel_data.sampleCount(), kernel_data.duration()));
 
+  if (target_rate != 0U && kernel_data.rate != target_rate) {
+    kernel_data = resampleKernel(kernel_data, target_rate);
+
+    if (!cache_path.empty()) {
+      writeCachedKernel(kernel_data, cache_path);
+    }
+  }
+
+  return kernel_data;
+}
+
+auto ConvolverKernelManager::getCachePath(const std::string& file_path, const uint& target_rate) const
+    -> std::string {
+  QFile file(QString::fromStdString(file_path));
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    return "";
+  }
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+
+  if (!hash.addData(&file)) {
+    return "";
+  }
+
+  return std::format("{}/{}_{}.kernel", cache_dir_irs, hash.result().toHex().toStdString(), target_rate);
+}
+
+auto ConvolverKernelManager::readCachedKernel(const std::string& cache_path) -> KernelData {
+  KernelData kernel_data;
+
+  QFile file(QString::fromStdString(cache_path));
+
+  if (!file.open(QIODevice::ReadOnly) || static_cast<size_t>(file.size()) < sizeof(CacheHeader)) {
+    return kernel_data;
+  }
+
+  auto* data = file.map(0, file.size());
+
+  if (data == nullptr) {
+    return kernel_data;
+  }
+
+  CacheHeader header;
+  const CacheHeader expected_header;
+
+  std::memcpy(&header, data, sizeof(CacheHeader));
+
+  const auto n_floats = static_cast<size_t>(header.channels) * header.n_samples;
+
+  if (std::memcmp(header.magic, expected_header.magic, sizeof(header.magic)) != 0 ||
+      header.version != expected_header.version || (header.channels != 2U && header.channels != 4U) ||
+      static_cast<size_t>(file.size()) != sizeof(CacheHeader) + (n_floats * sizeof(float))) {
+    util::warning(std::format("Ignoring the invalid kernel cache file {}", cache_path));
+
+    file.unmap(data);
+
+    return kernel_data;
+  }
+
+  kernel_data.rate = header.rate;
+  kernel_data.original_rate = header.original_rate;
+  kernel_data.channels = header.channels;
+
+  const auto* samples = data + sizeof(CacheHeader);
+
+  for (auto* channel : {&kernel_data.channel_L, &kernel_data.channel_R, &kernel_data.channel_LR,
+                        &kernel_data.channel_RL}) {
+    if (kernel_data.channels == 2U && (channel == &kernel_data.channel_LR || channel == &kernel_data.channel_RL)) {
+      continue;
+    }
+
+    channel->resize(header.n_samples);
+
+    std::memcpy(channel->data(), samples, header.n_samples * sizeof(float));
+
+    samples += header.n_samples * sizeof(float);
+  }
+
+  file.unmap(data);
+
+  // The modification time tells pruneCache which files were used recently
+  try {
+    std::filesystem::last_write_time(cache_path, std::filesystem::file_time_type::clock::now());
+  } catch (const std::exception& e) {
+    util::debug(std::format("Could not update the time of the kernel cache file {}: {}", cache_path, e.what()));
+  }
+
   return kernel_data;
 }
 
+void ConvolverKernelManager::writeCachedKernel(const KernelData& kernel, const std::string& cache_path) {
+  try {
+    std::filesystem::create_directories(std::filesystem::path{cache_path}.parent_path());
+  } catch (const std::exception& e) {
+    util::warning(std::format("Failed to create the kernel cache directory: {}", e.what()));
+
+    return;
+  }
+
+  CacheHeader header;
+
+  header.rate = kernel.rate;
+  header.original_rate = kernel.original_rate;
+  header.channels = kernel.channels;
+  header.n_samples = kernel.sampleCount();
+
+  // QSaveFile only replaces the cache file once it is complete
+
+  QSaveFile file(QString::fromStdString(cache_path));
+
+  if (!file.open(QIODevice::WriteOnly)) {
+    util::warning(std::format("Failed to create the kernel cache file {}", cache_path));
+
+    return;
+  }
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+
+  for (const auto* channel : {&kernel.channel_L, &kernel.channel_R, &kernel.channel_LR, &kernel.channel_RL}) {
+    if (kernel.channels == 2U && (channel == &kernel.channel_LR || channel == &kernel.channel_RL)) {
+      continue;
+    }
+
+    file.write(reinterpret_cast<const char*>(channel->data()), static_cast<qint64>(channel->size() * sizeof(float)));
+  }
+
+  if (!file.commit()) {
+    util::warning(std::format("Failed to write the kernel cache file {}", cache_path));
+
+    return;
+  }
+
+  util::debug(
+      std::format("Saved the resampled kernel '{}' to the cache file {}", kernel.name.toStdString(), cache_path));
+
+  pruneCache(std::filesystem::path{cache_path}.parent_path(), cache_path);
+}
+
+void ConvolverKernelManager::pruneCache(const std::filesystem::path& directory,
+                                        const std::filesystem::path& keep_path) {
+  struct CacheFile {
+    std::filesystem::path path;
+    std::filesystem::file_time_type time;
+    std::uintmax_t size = 0U;
+  };
+
+  std::vector<CacheFile> files;
+
+  std::uintmax_t total_size = 0U;
+
+  try {
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+      if (!entry.is_regular_file() || entry.path().extension() != ".kernel") {
+        continue;
+      }
+
+      files.push_back({.path = entry.path(), .time = entry.last_write_time(), .size = entry.file_size()});
+
+      total_size += files.back().size;
+    }
+
+    if (total_size <= max_cache_size) {
+      return;
+    }
+
+    std::ranges::sort(files, {}, &CacheFile::time);
+
+    for (const auto& file : files) {
+      if (total_size <= max_cache_size) {
+        break;
+      }
+
+      if (file.path == keep_path || !std::filesystem::remove(file.path)) {
+        continue;
+      }
+
+      total_size -= file.size;
+
+      util::debug(std::format("Removed the kernel cache file {}", file.path.string()));
+    }
+  } catch (const std::exception& e) {
+    util::warning(std::format("Failed to prune the kernel cache directory: {}", e.what()));
+  }
+}
+
 auto ConvolverKernelManager::combineKernels(const std::string& kernel1_name,
                                             const std::string& kernel2_name,
-                                            const std::string& output_name) -> bool {
+                                            const std::string& output_name,
+                                            const std::function<void(const int&)>& on_progress) -> bool {
   if (output_name.empty()) {
     util::warning("Output kernel name is empty");
     return false;
@@ -143,21 +364,71 @@ auto ConvolverKernelManager::combineKernels(const std::string& kernel1_name,
   const auto resampled_kernel1 = (kernel1.rate != target_rate) ? resampleKernel(kernel1, target_rate) : kernel1;
   const auto resampled_kernel2 = (kernel2.rate != target_rate) ? resampleKernel(kernel2, target_rate) : kernel2;
 
-  auto combined_kernel_L = directConvolution(resampled_kernel1.channel_L, resampled_kernel2.channel_L);
-  auto combined_kernel_R = directConvolution(resampled_kernel1.channel_R, resampled_kernel2.channel_R);
-
   KernelData combined_kernel;
 
   combined_kernel.rate = target_rate;
   combined_kernel.channels = resampled_kernel1.channels;
-  combined_kernel.channel_L = std::move(combined_kernel_L);
-  combined_kernel.channel_R = std::move(combined_kernel_R);
+
+  struct ChannelPair {
+    const std::vector<float>* a;
+    const std::vector<float>* b;
+
+    std::vector<float>* output;
+  };
+
+  std::vector<ChannelPair> channels = {
+      {&resampled_kernel1.channel_L, &resampled_kernel2.channel_L, &combined_kernel.channel_L},
+      {&resampled_kernel1.channel_R, &resampled_kernel2.channel_R, &combined_kernel.channel_R}};
 
   if (combined_kernel.channels == 4) {
-    combined_kernel.channel_LR = directConvolution(resampled_kernel1.channel_LR, resampled_kernel2.channel_LR);
-    combined_kernel.channel_RL = directConvolution(resampled_kernel1.channel_RL, resampled_kernel2.channel_RL);
+    channels.push_back({&resampled_kernel1.channel_LR, &resampled_kernel2.channel_LR, &combined_kernel.channel_LR});
+    channels.push_back({&resampled_kernel1.channel_RL, &resampled_kernel2.channel_RL, &combined_kernel.channel_RL});
   }
 
+  // Each channel is convolved in its own thread. Their progress is averaged before being reported.
+
+  std::vector<std::atomic<double>> channels_progress(channels.size());
+  std::atomic<int> last_percentage = 0;
+
+  auto each = [&](const size_t& n) {
+    *channels[n].output = fftConvolution(*channels[n].a, *channels[n].b, [&](const double& fraction) {
+      channels_progress[n].store(fraction, std::memory_order_relaxed);
+
+      if (on_progress == nullptr) {
+        return;
+      }
+
+      double sum = 0.0;
+
+      for (const auto& p : channels_progress) {
+        sum += p.load(std::memory_order_relaxed);
+      }
+
+      const auto percentage = static_cast<int>(100.0 * sum / static_cast<double>(channels_progress.size()));
+
+      auto previous = last_percentage.load();
+
+      while (percentage > previous) {
+        if (last_percentage.compare_exchange_weak(previous, percentage)) {
+          on_progress(percentage);
+
+          break;
+        }
+      }
+    });
+  };
+
+  std::vector<size_t> indices(channels.size());
+
+  std::iota(indices.begin(), indices.end(), 0U);
+
+#if defined(ENABLE_LIBCPP_WORKAROUNDS) || defined(_LIBCPP_HAS_NO_INCOMPLETE_PSTL) || \
+    (defined(_LIBCPP_VERSION) && _LIBCPP_VERSION < 170000)
+  std::for_each(indices.begin(), indices.end(), each);
+#else
+  std::for_each(std::execution::par, indices.begin(), indices.end(), each);
+#endif
+
   combined_kernel.name = QString::fromStdString(output_name);
 
   // Save the combined kernel
@@ -174,6 +445,12 @@ auto ConvolverKernelManager::combineKernels(const std::string& kernel1_name,
 auto ConvolverKernelManager::searchKernelPath(const std::string& name) -> std::string {
   // Given the irs name without extension, search the full path on the filesystem.
 
+  // Absolute paths are used as given. This is how the benchmark and command line tools pass their kernels.
+  if (const auto given_path = std::filesystem::path{name};
+      given_path.is_absolute() && std::filesystem::is_regular_file(given_path)) {
+    return given_path.string();
+  }
+
   const std::vector<std::string> extensions = {irs_ext, sofa_ext};
 
   const auto community_package = (pipeline_type == PipelineType::input) ? DbMain::lastLoadedInputCommunityPackage()
@@ -311,6 +588,89 @@ void ConvolverKernelManager::normalizeKernel(KernelData& kernel) {
   }
 }
 
+void ConvolverKernelManager::applyAutogain(KernelData& kernel) {
+  if (!kernel.isValid()) {
+    return;
+  }
+
+  normalizeKernel(kernel);
+
+  // find average power
+
+  float power_LL = 0.0F;
+  float power_RR = 0.0F;
+  float power_LR = 0.0F;
+  float power_RL = 0.0F;
+
+  for (uint i = 0; i < kernel.sampleCount(); i++) {
+    power_LL += kernel.channel_L[i] * kernel.channel_L[i];
+    power_RR += kernel.channel_R[i] * kernel.channel_R[i];
+
+    if (kernel.channels == 4) {
+      power_LR += kernel.channel_LR[i] * kernel.channel_LR[i];
+      power_RL += kernel.channel_RL[i] * kernel.channel_RL[i];
+    }
+  }
+
+  const float power = std::max({power_LL, power_RR, power_LR, power_RL});
+
+  const float autogain = std::min(1.0F, 1.0F / std::sqrt(power));
+
+  util::debug(std::format("autogain factor: {}", autogain));
+
+  for (uint i = 0; i < kernel.sampleCount(); i++) {
+    kernel.channel_L[i] *= autogain;
+    kernel.channel_R[i] *= autogain;
+
+    if (kernel.channels == 4) {
+      kernel.channel_LR[i] *= autogain;
+      kernel.channel_RL[i] *= autogain;
+    }
+  }
+}
+
+/**
+ * Mid-Side based Stereo width effect
+ * taken from https://github.com/tomszilagyi/ir.lv2/blob/automatable/ir.cc
+ */
+void ConvolverKernelManager::applyStereoWidth(KernelData& kernel, const int& ir_width) {
+  if (!kernel.isValid()) {
+    return;
+  }
+
+  const float w = static_cast<float>(ir_width) * 0.01F;
+  const float x = (1.0F - w) / (1.0F + w);  // M-S coeff.; L_out = L + x*R; R_out = R + x*L
+
+  for (uint i = 0; i < kernel.sampleCount(); i++) {
+    const float LL = kernel.channel_L[i];
+    const float RR = kernel.channel_R[i];
+
+    float LR = 0.0F;
+    float RL = 0.0F;
+
+    if (kernel.channels == 4) {
+      LR = kernel.channel_LR[i];
+      RL = kernel.channel_RL[i];
+    }
+
+    // Apply width to direct paths
+    float new_LL = LL + (x * RR);
+    float new_RR = RR + (x * LL);
+
+    // Apply complementary width to cross paths
+    float new_LR = LR - (x * RL);
+    float new_RL = RL - (x * LR);
+
+    kernel.channel_L[i] = new_LL;
+    kernel.channel_R[i] = new_RR;
+
+    if (kernel.channels == 4) {
+      kernel.channel_LR[i] = new_LR;
+      kernel.channel_RL[i] = new_RL;
+    }
+  }
+}
+
 auto ConvolverKernelManager::saveKernel(const KernelData& kernel, const std::string& file_name) -> bool {
   if (!kernel.isValid() || file_name.empty()) {
     return false;
@@ -492,222 +852,117 @@ auto ConvolverKernelManager::findKernelInDirectory(const std::filesystem::path&
   return "";
 }
 
-auto ConvolverKernelManager::directConvolution(const std::vector<float>& a, const std::vector<float>& b)
+auto ConvolverKernelManager::fftConvolution(const std::vector<float>& a,
+                                            const std::vector<float>& b,
+                                            const std::function<void(const double&)>& on_progress)
     -> std::vector<float> {
   if (a.empty() || b.empty()) {
     return {};
   }
 
-  const auto output_size = a.size() + b.size() - 1;
-
-  std::vector<float> result(output_size, 0.0F);
-
-  std::vector<size_t> indices(output_size);
-
-  std::iota(indices.begin(), indices.end(), 0U);
-
-  auto each = [&](const int n) {
-    result[n] = 0.0F;
+  // Overlap-add: the longer signal is split in blocks with the size of the shorter one
 
-    const int a_size = static_cast<int>(a.size());
-    const int b_size = static_cast<int>(b.size());
+  const auto& signal = (a.size() >= b.size()) ? a : b;
+  const auto& filter = (a.size() >= b.size()) ? b : a;
 
-    for (int m = 0; m < b_size; m++) {
-      if (const auto z = n - m; z >= 0 && z < a_size - 1) {
-        result[n] += b[m] * a[z];
-      }
-    }
-  };
-
-#if defined(ENABLE_LIBCPP_WORKAROUNDS) || defined(_LIBCPP_HAS_NO_INCOMPLETE_PSTL) || \
-    (defined(_LIBCPP_VERSION) && _LIBCPP_VERSION < 170000)
-  std::for_each(indices.begin(), indices.end(), each);
-#else
-  std::for_each(std::execution::par_unseq, indices.begin(), indices.end(), each);
-#endif
+  const auto output_size = signal.size() + filter.size() - 1U;
 
-  return result;
-}
+  const auto block_size = std::bit_ceil(filter.size());
+  const auto fft_size = 2U * block_size;
+  const auto n_bins = (fft_size / 2U) + 1U;
 
-auto ConvolverKernelManager::getFileExtension(const std::string& file_path) -> std::string {
-  std::filesystem::path path(file_path);
-  std::string ext = path.extension().string();
+  std::vector<float> result(output_size, 0.0F);
 
-  // Convert to lowercase for case-insensitive comparison
-  std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return std::tolower(c); });
+  auto* real = static_cast<double*>(fftw_malloc(sizeof(double) * fft_size));
+  auto* spectrum_block = fftw_alloc_complex(n_bins);
+  auto* spectrum_filter = fftw_alloc_complex(n_bins);
 
-  return ext;
-}
+  fftw_plan plan_forward = nullptr;
+  fftw_plan plan_inverse = nullptr;
 
-// https://www.sofaconventions.org/mediawiki/index.php/SOFA_specifications
+  // The fftw planner is not thread safe. Executing different plans is.
 
-auto ConvolverKernelManager::readSofaKernelFile(const std::string& file_path) -> KernelData {
-  KernelData kernel_data;
+  FftwPlanner::self().run([&] {
+    plan_forward = fftw_plan_dft_r2c_1d(static_cast<int>(fft_size), real, spectrum_block, FFTW_ESTIMATE);
+    plan_inverse = fftw_plan_dft_c2r_1d(static_cast<int>(fft_size), spectrum_block, real, FFTW_ESTIMATE);
+  });
 
-  try {
-    int error = 0;
+  std::fill_n(real, fft_size, 0.0);
+  std::ranges::copy(filter, real);
 
-    struct MYSOFA_HRTF* hrtf = mysofa_load(file_path.c_str(), &error);
+  fftw_execute_dft_r2c(plan_forward, real, spectrum_filter);
 
-    if (error != MYSOFA_OK) {
-      util::warning(std::format("Error while trying to load the sofa file: {}", util::mysofa_error_to_string(error)));
-    }
+  const auto norm = 1.0 / static_cast<double>(fft_size);
 
-    if (!hrtf) {
-      util::warning(std::format("Failed to load SOFA file: {} - Error: {}", file_path, error));
-      return kernel_data;
-    }
+  for (size_t offset = 0U; offset < signal.size(); offset += block_size) {
+    const auto count = std::min(block_size, signal.size() - offset);
 
-    // Validate the HRTF structure
-    if (mysofa_check(hrtf) != MYSOFA_OK) {
-      util::warning(std::format("SOFA file validation failed: {}", file_path));
-    }
+    std::fill_n(real, fft_size, 0.0);
+    std::copy_n(signal.begin() + static_cast<std::ptrdiff_t>(offset), count, real);
 
-    kernel_data.rate = 48000;  // Default fallback
-    kernel_data.original_rate = kernel_data.rate;
+    fftw_execute(plan_forward);
 
-    if (hrtf->DataSamplingRate.elements > 0 && hrtf->DataSamplingRate.values) {
-      kernel_data.rate = static_cast<uint>(hrtf->DataSamplingRate.values[0]);
-      kernel_data.original_rate = kernel_data.rate;
+    for (size_t k = 0U; k < n_bins; k++) {
+      const auto re = (spectrum_block[k][0] * spectrum_filter[k][0]) - (spectrum_block[k][1] * spectrum_filter[k][1]);
+      const auto im = (spectrum_block[k][0] * spectrum_filter[k][1]) + (spectrum_block[k][1] * spectrum_filter[k][0]);
 
-      util::debug(std::format("Found SOFA sampling rate: {} Hz", kernel_data.rate));
+      spectrum_block[k][0] = re;
+      spectrum_block[k][1] = im;
     }
 
-    // Get dimensions
-    int M = hrtf->M;  // Number of measurements (source positions)
-    int R = hrtf->R;  // Number of receivers (ears, usually 2)
-    int N = hrtf->N;  // Filter length (samples per IR)
-    int E = hrtf->E;  // Number of emitters
-
-    util::debug(std::format("SOFA file measurements: {}", M));
-    util::debug(std::format("SOFA file receivers: {}", R));
-    util::debug(std::format("SOFA file filter length: {}", N));
-    util::debug(std::format("SOFA file emitters: {}", E));
-
-    // Set SOFA metadata
-    kernel_data.is_sofa = true;
-    kernel_data.sofaMetadata.measurements = M;
-    kernel_data.sofaMetadata.database = mysofa_getAttribute(hrtf->attributes, const_cast<char*>("DatabaseName"));
+    fftw_execute(plan_inverse);
 
-    util::debug(std::format("Database: {}", kernel_data.sofaMetadata.database.toStdString()));
+    const auto n_out = std::min(count + filter.size() - 1U, output_size - offset);
 
-    if (M <= 0 || R < 1 || N <= 0) {
-      util::warning(std::format("Invalid SOFA file structure: M={}, R={}, N={}", M, R, N));
-
-      mysofa_free(hrtf);
-
-      return kernel_data;
+    for (size_t n = 0U; n < n_out; n++) {
+      result[offset + n] += static_cast<float>(real[n] * norm);
     }
 
-    int m = 0;
-
-    mysofa_tocartesian(hrtf);
-
-    struct MYSOFA_LOOKUP* lookup = mysofa_lookup_init(hrtf);
-
-    if (!lookup) {
-      util::warning("Failed to create SOFA lookup structure.");
-    } else {
-      util::debug(std::format("Theta min: {}, max: {}", lookup->theta_min, lookup->theta_max));
-      util::debug(std::format("Phi min: {}, max: {}", lookup->phi_min, lookup->phi_max));
-      util::debug(std::format("Radius min: {}, max: {}", lookup->radius_min, lookup->radius_max));
-
-      kernel_data.sofaMetadata.min_azimuth = lookup->phi_min;
-      kernel_data.sofaMetadata.max_azimuth = lookup->phi_max;
-      kernel_data.sofaMetadata.min_elevation = lookup->theta_min;
-      kernel_data.sofaMetadata.max_elevation = lookup->theta_max;
-      kernel_data.sofaMetadata.min_radius = lookup->radius_min;
-      kernel_data.sofaMetadata.max_radius = lookup->radius_max;
-
-      float coords[3] = {static_cast<float>(settings->targetSofaAzimuth()),
-                         static_cast<float>(settings->targetSofaElevation()),
-                         static_cast<float>(settings->targetSofaRadius())};
-
-      mysofa_s2c(coords);
-
-      m = mysofa_lookup(lookup, coords);
-
-      kernel_data.sofaMetadata.index = m;
-
-      util::debug(std::format(
-          "For the desired azimuth = {}, elevation = {} and radius = {} the nearest SOFA measurement index is {}",
-          settings->targetSofaAzimuth(), settings->targetSofaElevation(), settings->targetSofaRadius(), m));
-
-      mysofa_lookup_free(lookup);
-
-      mysofa_tospherical(hrtf);
-
-      float selected_azimuth = hrtf->SourcePosition.values[(m * 3) + 0];
-      float selected_elevation = hrtf->SourcePosition.values[(m * 3) + 1];
-      float selected_radius = hrtf->SourcePosition.values[(m * 3) + 2];
-
-      kernel_data.sofaMetadata.azimuth = selected_azimuth;
-      kernel_data.sofaMetadata.elevation = selected_elevation;
-      kernel_data.sofaMetadata.radius = selected_radius;
-
-      util::debug(std::format("For measurement {} we have azimuth = {}, elevation = {} and radius = {}", m,
-                              selected_azimuth, selected_elevation, selected_radius));
+    if (on_progress != nullptr) {
+      on_progress(static_cast<double>(offset + count) / static_cast<double>(signal.size()));
     }
+  }
 
-    const int RxE_times_N = R * E * N;
-
-    if (E == 1) {
-      kernel_data.channel_L.resize(N);
-      kernel_data.channel_R.resize(N);
-      kernel_data.channels = 2;
-
-      // Left ear (receiver 0)
-      for (int n = 0; n < N; n++) {
-        kernel_data.channel_L[n] = hrtf->DataIR.values[(m * RxE_times_N) + (0 * N) + n];
-      }
+  FftwPlanner::self().run([&] {
+    fftw_destroy_plan(plan_forward);
+    fftw_destroy_plan(plan_inverse);
+  });
 
-      // Right ear (receiver 1)
-      if (R > 1) {
-        for (int n = 0; n < N; n++) {
-          kernel_data.channel_R[n] = hrtf->DataIR.values[(m * RxE_times_N) + (1 * N) + n];
-        }
-      } else {
-        kernel_data.channel_R = kernel_data.channel_L;
-      }
-    }
+  fftw_free(real);
+  fftw_free(spectrum_block);
+  fftw_free(spectrum_filter);
 
-    if (R == 2 && E == 2) {
-      // Assuming it is True Stereo HRTF: 4 channels
+  return result;
+}
 
-      kernel_data.channels = 4;
-      kernel_data.channel_L.resize(N);   // LL
-      kernel_data.channel_LR.resize(N);  // LR
-      kernel_data.channel_RL.resize(N);  // RL
-      kernel_data.channel_R.resize(N);   // RR
+auto ConvolverKernelManager::getFileExtension(const std::string& file_path) -> std::string {
+  std::filesystem::path path(file_path);
+  std::string ext = path.extension().string();
 
-      // Left Channel (LL: Emitter 0 to Receiver 0)
-      for (int n = 0; n < N; n++) {
-        kernel_data.channel_L[n] = hrtf->DataIR.values[(m * RxE_times_N) + (0 * E * N) + (0 * N) + n];
-      }
+  // Convert to lowercase for case-insensitive comparison
+  std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return std::tolower(c); });
 
-      // Left-to-Right Crosstalk (LR: Emitter 0 to Receiver 1)
-      for (int n = 0; n < N; n++) {
-        kernel_data.channel_LR[n] = hrtf->DataIR.values[(m * RxE_times_N) + (1 * E * N) + (0 * N) + n];
-      }
+  return ext;
+}
 
-      // Right-to-Left Crosstalk (RL: Emitter 1 to Receiver 0)
-      for (int n = 0; n < N; n++) {
-        kernel_data.channel_RL[n] = hrtf->DataIR.values[(m * RxE_times_N) + (0 * E * N) + (1 * N) + n];
-      }
+auto ConvolverKernelManager::readSofaKernelFile(const std::string& file_path, const uint& target_rate) -> KernelData {
+  // The database stays in memory while this manager uses it. Changing the orientation does not read the file again.
 
-      // Right Channel (RR: Emitter 1 to Receiver 1)
-      for (int n = 0; n < N; n++) {
-        kernel_data.channel_R[n] = hrtf->DataIR.values[(m * RxE_times_N) + (1 * E * N) + (1 * N) + n];
-      }
-    }
+  if (sofa_database == nullptr || sofa_database_path != file_path) {
+    sofa_database = ConvolverSofaDatabase::open(file_path);
+    sofa_database_path = file_path;
+  }
 
-    mysofa_free(hrtf);
+  if (sofa_database == nullptr) {
+    return KernelData{};
+  }
 
-    util::debug(std::format("Successfully loaded SOFA file '{}': {} Hz, {} samples", file_path, kernel_data.rate, N));
+  auto kernel_data = sofa_database->getKernel(
+      static_cast<float>(settings->targetSofaAzimuth()), static_cast<float>(settings->targetSofaElevation()),
+      static_cast<float>(settings->targetSofaRadius()), settings->sofaInterpolation(), target_rate);
 
-  } catch (const std::exception& e) {
-    util::warning(std::format("Exception while reading SOFA file {}: {}", file_path, e.what()));
-  }
+  util::debug(std::format("Successfully loaded SOFA kernel from '{}': {} Hz, {} samples", file_path, kernel_data.rate,
+                          kernel_data.sampleCount()));
 
   return kernel_data;
 }
@@ -22,12 +22,18 @@
 #include <qtypes.h>
 #include <QString>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "easyeffects_db_convolver.h"
 #include "pipeline_type.hpp"
 
+class ConvolverSofaDatabase;
+
 class ConvolverKernelManager {
  public:
   static constexpr std::string irs_ext = ".irs";
@@ -76,10 +82,21 @@ class ConvolverKernelManager {
 
   ConvolverKernelManager(DbConvolver* settings, const PipelineType& pipeline_type);
 
-  auto loadKernel(const std::string& name) -> KernelData;
-
-  auto combineKernels(const std::string& kernel1_name, const std::string& kernel2_name, const std::string& output_name)
-      -> bool;
+  /**
+   * Loads the kernel and, when target_rate is not zero, resamples it to this
+   * rate. Resampled impulse files are cached in the user cache directory so
+   * that loading them again at the same rate does not resample them again.
+   */
+  auto loadKernel(const std::string& name, const uint& target_rate = 0U) -> KernelData;
+
+  /**
+   * on_progress receives the completed percentage. It is called from the
+   * threads convolving the channels.
+   */
+  auto combineKernels(const std::string& kernel1_name,
+                      const std::string& kernel2_name,
+                      const std::string& output_name,
+                      const std::function<void(const int&)>& on_progress = nullptr) -> bool;
 
   auto searchKernelPath(const std::string& name) -> std::string;
 
@@ -87,9 +104,16 @@ class ConvolverKernelManager {
 
   static void normalizeKernel(KernelData& kernel);
 
+  static void applyAutogain(KernelData& kernel);
+
+  // Mid-Side stereo width. 100 leaves the kernel unchanged.
+  static void applyStereoWidth(KernelData& kernel, const int& ir_width);
+
   auto saveKernel(const KernelData& kernel, const std::string& file_name) -> bool;
 
-  auto readSofaKernelFile(const std::string& file_path) -> KernelData;
+  auto readSofaKernelFile(const std::string& file_path, const uint& target_rate) -> KernelData;
+
+  static auto getFileExtension(const std::string& file_path) -> std::string;
 
  private:
   DbConvolver* settings = nullptr;
@@ -98,17 +122,56 @@ class ConvolverKernelManager {
 
   std::string app_data_dir;
   std::string local_dir_irs;
+  std::string cache_dir_irs;
 
   std::vector<std::string> system_data_dir_irs;
 
+  std::string sofa_database_path;
+
+  std::shared_ptr<ConvolverSofaDatabase> sofa_database;
+
   static auto readKernelFile(const std::string& file_path) -> KernelData;
 
+  /**
+   * Header of the files in cache_dir_irs. The channels follow it as raw floats
+   * in the order L, R, LR, RL. It is written as it is in memory, so it must not
+   * have padding bytes. Their content would be undefined.
+   */
+
+  struct CacheHeader {
+    char magic[4] = {'E', 'E', 'I', 'R'};
+
+    quint32 version = 1U;
+    quint32 rate = 0U;
+    quint32 original_rate = 0U;
+    quint32 channels = 0U;
+    quint32 reserved = 0U;  // aligns n_samples
+
+    quint64 n_samples = 0U;
+  };
+
+  static_assert(std::has_unique_object_representations_v<CacheHeader>);
+
+  /**
+   * Limit for the total size of the files in cache_dir_irs. The least recently
+   * used files are removed when a new one makes the cache larger than this.
+   */
+  static constexpr std::uintmax_t max_cache_size = 512U * 1024U * 1024U;
+
+  auto getCachePath(const std::string& file_path, const uint& target_rate) const -> std::string;
+
+  static auto readCachedKernel(const std::string& cache_path) -> KernelData;
+
+  static void writeCachedKernel(const KernelData& kernel, const std::string& cache_path);
+
+  static void pruneCache(const std::filesystem::path& directory, const std::filesystem::path& keep_path);
+
   static auto validateKernel(const KernelData& kernel) -> bool;
 
   static auto findKernelInDirectory(const std::filesystem::path& directory, const std::string& kernel_name)
       -> std::string;
 
-  static auto directConvolution(const std::vector<float>& a, const std::vector<float>& b) -> std::vector<float>;
-
-  static auto getFileExtension(const std::string& file_path) -> std::string;
+  static auto fftConvolution(const std::vector<float>& a,
+                             const std::vector<float>& b,
+                             const std::function<void(const double&)>& on_progress) -> std::vector<float>;
 };
@@ -0,0 +1,65 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "convolver_kernel_store.hpp"
+#include <format>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "convolver_kernel_manager.hpp"
+#include "util.hpp"
+
+auto ConvolverKernelStore::get(const Key& key, const std::function<ConvolverKernelManager::KernelData()>& make)
+    -> Handle {
+  {
+    std::scoped_lock<std::mutex> lock(mutex);
+
+    if (auto it = kernels.find(key); it != kernels.end()) {
+      if (auto kernel = it->second.lock(); kernel != nullptr) {
+        return kernel;
+      }
+    }
+  }
+
+  // Loading and resampling can take a while. Other convolvers are not blocked meanwhile.
+
+  auto kernel = std::make_shared<const ConvolverKernelManager::KernelData>(make());
+
+  if (!kernel->isValid()) {
+    return nullptr;
+  }
+
+  std::scoped_lock<std::mutex> lock(mutex);
+
+  // Another instance may have created the same kernel in the meantime
+
+  if (auto it = kernels.find(key); it != kernels.end()) {
+    if (auto stored = it->second.lock(); stored != nullptr) {
+      return stored;
+    }
+  }
+
+  std::erase_if(kernels, [](const auto& item) { return item.second.expired(); });
+
+  kernels[key] = kernel;
+
+  util::debug(std::format("Kernel store: {} kernels in use", kernels.size()));
+
+  return kernel;
+}
@@ -0,0 +1,75 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <qtypes.h>
+#include <compare>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "convolver_kernel_manager.hpp"
+
+/**
+ * Process wide store of immutable kernels. Convolver instances loading the
+ * same impulse with the same settings share a single copy of it. A kernel is
+ * released when the last handle to it is destroyed.
+ */
+class ConvolverKernelStore {
+ public:
+  using Handle = std::shared_ptr<const ConvolverKernelManager::KernelData>;
+
+  struct Key {
+    std::string source;  // File path. SOFA kernels also have the selected position.
+
+    uint rate = 0U;  // Zero when the kernel keeps its original rate
+
+    int ir_width = 100;
+
+    bool autogain = false;
+
+    auto operator<=>(const Key&) const = default;
+  };
+
+  ConvolverKernelStore(const ConvolverKernelStore&) = delete;
+  auto operator=(const ConvolverKernelStore&) -> ConvolverKernelStore& = delete;
+  ConvolverKernelStore(const ConvolverKernelStore&&) = delete;
+  auto operator=(const ConvolverKernelStore&&) -> ConvolverKernelStore& = delete;
+  ~ConvolverKernelStore() = default;
+
+  static auto self() -> ConvolverKernelStore& {
+    static ConvolverKernelStore store;
+    return store;
+  }
+
+  /**
+   * Returns the kernel stored under key. When nobody holds it make is called
+   * to create it. A null handle is returned if make creates an invalid kernel.
+   */
+  auto get(const Key& key, const std::function<ConvolverKernelManager::KernelData()>& make) -> Handle;
+
+ private:
+  ConvolverKernelStore() = default;
+
+  std::mutex mutex;
+
+  std::map<Key, std::weak_ptr<const ConvolverKernelManager::KernelData>> kernels;
+};
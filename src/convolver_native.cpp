@@ -0,0 +1,475 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "convolver_native.hpp"
+#include <fftw3.h>
+#include <pthread.h>
+#include <qtypes.h>
+#include <sched.h>
+#include <algorithm>
+#include <barrier>
+#include <cstddef>
+#include <format>
+#include <memory>
+#include <semaphore>
+#include <span>
+#include <thread>
+#include <vector>
+#include "convolver_kernel_manager.hpp"
+#include "fftw_planner.hpp"
+#include "split_complex.hpp"
+#include "util.hpp"
+
+PartitionedConvolution::~PartitionedConvolution() {
+  destroy_plans();
+}
+
+void PartitionedConvolution::destroy_plans() {
+  FftwPlanner::self().run([this] {
+    if (forward != nullptr) {
+      fftwf_destroy_plan(forward);
+    }
+
+    if (backward != nullptr) {
+      fftwf_destroy_plan(backward);
+    }
+  });
+
+  forward = nullptr;
+  backward = nullptr;
+}
+
+auto PartitionedConvolution::partitions() const -> size_t {
+  return n_partitions;
+}
+
+auto PartitionedConvolution::make_spectrum() const -> Spectrum {
+  return {.re = split_complex::allocate(stride), .im = split_complex::allocate(stride)};
+}
+
+auto PartitionedConvolution::init(const ConvolverKernelManager::KernelData& kernel,
+                                  const size_t offset,
+                                  const size_t length,
+                                  const uint block) -> bool {
+  destroy_plans();
+
+  this->block = block;
+
+  const auto fft_size = 2U * static_cast<size_t>(block);
+
+  cross_channels = kernel.channels == 4;
+  n_partitions = (length + block - 1U) / block;
+  n_bins = block + 1U;
+  stride = split_complex::padded_size(n_bins);
+  fdl_position = 0U;
+
+  time = split_complex::allocate(fft_size);
+
+  for (size_t c = 0U; c < 2U; c++) {
+    window[c] = split_complex::allocate(fft_size);
+    fdl_re[c] = split_complex::allocate(n_partitions * stride);
+    fdl_im[c] = split_complex::allocate(n_partitions * stride);
+  }
+
+  FftwPlanner::self().run([&] {
+    fftwf_iodim dim{.n = static_cast<int>(fft_size), .is = 1, .os = 1};
+
+    forward = fftwf_plan_guru_split_dft_r2c(1, &dim, 0, nullptr, window[0].get(), fdl_re[0].get(), fdl_im[0].get(),
+                                            FFTW_ESTIMATE);
+
+    backward = fftwf_plan_guru_split_dft_c2r(1, &dim, 0, nullptr, fdl_re[1].get(), fdl_im[1].get(), time.get(),
+                                             FFTW_ESTIMATE);
+  });
+
+  if (forward == nullptr || backward == nullptr) {
+    util::warning(std::format("Native convolver: could not create the fftw plans for {} samples", fft_size));
+
+    return false;
+  }
+
+  // The inverse transform is not normalized. Its scale is applied to the filter spectra.
+
+  const auto scale = 1.0F / static_cast<float>(fft_size);
+
+  const std::array<const std::vector<float>*, 4> paths = {&kernel.channel_L, &kernel.channel_R, &kernel.channel_LR,
+                                                          &kernel.channel_RL};
+
+  const auto n_paths = cross_channels ? 4U : 2U;
+
+  for (size_t p = 0U; p < n_paths; p++) {
+    filter_re[p] = split_complex::allocate(n_partitions * stride);
+    filter_im[p] = split_complex::allocate(n_partitions * stride);
+
+    const auto& taps = *paths[p];
+
+    for (size_t j = 0U; j < n_partitions; j++) {
+      std::fill_n(time.get(), fft_size, 0.0F);
+
+      const auto first = offset + (j * block);
+      const auto last = std::min({first + block, offset + length, taps.size()});
+
+      for (size_t n = first; n < last; n++) {
+        time[n - first] = scale * taps[n];
+      }
+
+      fftwf_execute_split_dft_r2c(forward, time.get(), filter_re[p].get() + (j * stride),
+                                  filter_im[p].get() + (j * stride));
+    }
+  }
+
+  for (size_t p = n_paths; p < filter_re.size(); p++) {
+    filter_re[p].reset();
+    filter_im[p].reset();
+  }
+
+  std::fill_n(time.get(), fft_size, 0.0F);
+
+  return true;
+}
+
+void PartitionedConvolution::transform_input(std::span<const float> left, std::span<const float> right) {
+  fdl_position = (fdl_position + 1U) % n_partitions;
+
+  const auto inputs = std::array{left, right};
+
+  for (size_t c = 0U; c < 2U; c++) {
+    auto* w = window[c].get();
+
+    std::copy(w + block, w + (2U * block), w);
+
+    std::ranges::copy(inputs[c], w + block);
+
+    fftwf_execute_split_dft_r2c(forward, w, fdl_re[c].get() + (fdl_position * stride),
+                                fdl_im[c].get() + (fdl_position * stride));
+  }
+}
+
+void PartitionedConvolution::accumulate(const size_t first, const size_t last, Spectrum& left, Spectrum& right) const {
+  using split_complex::multiply_accumulate;
+
+  for (size_t j = first; j < last; j++) {
+    // The partition j is applied to the input block received j blocks ago
+
+    const auto x = ((fdl_position + n_partitions - j) % n_partitions) * stride;
+    const auto h = j * stride;
+
+    multiply_accumulate(fdl_re[0].get() + x, fdl_im[0].get() + x, filter_re[0].get() + h, filter_im[0].get() + h,
+                        left.re.get(), left.im.get(), stride);
+
+    multiply_accumulate(fdl_re[1].get() + x, fdl_im[1].get() + x, filter_re[1].get() + h, filter_im[1].get() + h,
+                        right.re.get(), right.im.get(), stride);
+
+    if (cross_channels) {
+      multiply_accumulate(fdl_re[0].get() + x, fdl_im[0].get() + x, filter_re[2].get() + h, filter_im[2].get() + h,
+                          right.re.get(), right.im.get(), stride);
+
+      multiply_accumulate(fdl_re[1].get() + x, fdl_im[1].get() + x, filter_re[3].get() + h, filter_im[3].get() + h,
+                          left.re.get(), left.im.get(), stride);
+    }
+  }
+}
+
+void PartitionedConvolution::merge(Spectrum& from, Spectrum& target) const {
+  for (size_t k = 0U; k < stride; k++) {
+    target.re[k] += from.re[k];
+    target.im[k] += from.im[k];
+  }
+
+  std::fill_n(from.re.get(), stride, 0.0F);
+  std::fill_n(from.im.get(), stride, 0.0F);
+}
+
+void PartitionedConvolution::transform_output(Spectrum& spectrum, std::span<float> output) {
+  fftwf_execute_split_dft_c2r(backward, spectrum.re.get(), spectrum.im.get(), time.get());
+
+  // Only the second half of the overlap-save window is free of circular aliasing
+
+  std::copy_n(time.get() + block, output.size(), output.begin());
+
+  std::fill_n(spectrum.re.get(), stride, 0.0F);
+  std::fill_n(spectrum.im.get(), stride, 0.0F);
+}
+
+namespace {
+
+/**
+ * Same class and priority zita-convolver ends up with for its threads. It is
+ * the lowest realtime priority, so the workers stay below the PipeWire data
+ * thread while still running before the normal threads.
+ */
+constexpr auto WORKER_SCHED_CLASS = SCHED_FIFO;
+
+void set_worker_priority(std::thread& thread) {
+  sched_param param{};
+
+  param.sched_priority = sched_get_priority_min(WORKER_SCHED_CLASS);
+
+  if (const auto ret = pthread_setschedparam(thread.native_handle(), WORKER_SCHED_CLASS, &param); ret != 0) {
+    util::debug(std::format("Native convolver: could not give the worker a realtime priority: {}", std::strerror(ret)));
+  }
+}
+
+}  // namespace
+
+ConvolverNative::ConvolverNative(const uint n_threads) : n_threads(std::max(n_threads, 1U)) {}
+
+ConvolverNative::~ConvolverNative() {
+  stop();
+}
+
+void ConvolverNative::stop() {
+  ready = false;
+
+  if (workers.empty()) {
+    return;
+  }
+
+  // The workers have to be idle. Otherwise they could leave while the others wait in the barrier.
+
+  while (jobs_collected != jobs_posted) {
+    job_finished.acquire();
+
+    jobs_collected++;
+  }
+
+  quit = true;
+
+  for (auto& s : job_started) {
+    s->release();
+  }
+
+  for (auto& t : workers) {
+    t.join();
+  }
+
+  workers.clear();
+  job_started.clear();
+  job_barrier.reset();
+
+  quit = false;
+
+  if (const auto missed = missed_tails.exchange(0U); missed > 0U) {
+    util::warning(std::format("Native convolver: the workers missed the deadline of {} tail periods", missed));
+  }
+}
+
+auto ConvolverNative::init(const ConvolverKernelManager::KernelData& kernel, uint bufferSize) -> bool {
+  stop();
+
+  const auto n_frames = kernel.sampleCount();
+
+  if (bufferSize == 0U || n_frames == 0U) {
+    return false;
+  }
+
+  this->bufferSize = bufferSize;
+
+  tail_block = bufferSize * std::max(tail_factor, (min_tail_block + bufferSize - 1U) / bufferSize);
+
+  /**
+   * The tail starts two tail blocks after the kernel beginning. Its output for
+   * one period is only needed one period after the input was complete. This
+   * is the time the workers have to compute it.
+   */
+
+  const auto head_length = std::min<size_t>(n_frames, 2U * static_cast<size_t>(tail_block));
+
+  if (!head.init(kernel, 0U, head_length, bufferSize)) {
+    return false;
+  }
+
+  head_L = head.make_spectrum();
+  head_R = head.make_spectrum();
+
+  has_tail = n_frames > head_length;
+
+  tail_position = 0U;
+  tail_late = false;
+  tail_dropped = false;
+  jobs_posted = 0U;
+  jobs_collected = 0U;
+
+  if (has_tail) {
+    if (!tail.init(kernel, head_length, n_frames - head_length, tail_block)) {
+      return false;
+    }
+
+    for (auto* buffers : {&tail_in_L, &tail_in_R, &tail_out_L, &tail_out_R}) {
+      for (auto& b : *buffers) {
+        b.assign(tail_block, 0.0F);
+      }
+    }
+
+    tail_in_job.fill(0U);
+
+    tail_silence.assign(tail_block, 0.0F);
+
+    tail_acc_L.clear();
+    tail_acc_R.clear();
+
+    for (uint n = 0U; n < n_threads; n++) {
+      tail_acc_L.push_back(tail.make_spectrum());
+      tail_acc_R.push_back(tail.make_spectrum());
+
+      job_started.push_back(std::make_unique<std::counting_semaphore<>>(0));
+    }
+
+    job_barrier = std::make_unique<std::barrier<>>(n_threads);
+
+    for (uint n = 0U; n < n_threads; n++) {
+      workers.emplace_back([this, n] { work(n); });
+
+      set_worker_priority(workers.back());
+    }
+  }
+
+  util::debug(std::format("Native convolver: {} head partitions of {} samples, {} tail partitions of {} samples",
+                          head.partitions(), bufferSize, has_tail ? tail.partitions() : 0U, tail_block));
+
+  ready = true;
+
+  return ready;
+}
+
+auto ConvolverNative::process(std::span<float> left, std::span<float> right) -> bool {
+  if (!ready) {
+    return false;
+  }
+
+  if (left.size() != bufferSize || right.size() != bufferSize) {
+    util::warning(std::format("Native convolver: expected {} samples but received {}. Aborting!", bufferSize,
+                              left.size()));
+
+    ready = false;
+
+    return false;
+  }
+
+  // The input goes to the slot of the next job and the output comes from the slot of the job posted two periods ago
+
+  const auto input_slot = jobs_posted % tail_slots;
+  const auto output_slot = (jobs_posted + 1U) % tail_slots;
+
+  if (has_tail) {
+    if (tail_position == 0U) {
+      // The workers finish the jobs in order
+      while (jobs_posted - jobs_collected > 1U && job_finished.try_acquire()) {
+        jobs_collected++;
+      }
+
+      tail_late = jobs_posted - jobs_collected > 1U;
+
+      // The input slot is still used by the job before the late one
+      tail_dropped = jobs_posted - jobs_collected > 2U;
+
+      if (tail_late) {
+        missed_tails.fetch_add(1U, std::memory_order_relaxed);
+      }
+    }
+
+    if (!tail_dropped) {
+      std::ranges::copy(left, tail_in_L[input_slot].begin() + tail_position);
+      std::ranges::copy(right, tail_in_R[input_slot].begin() + tail_position);
+    }
+  }
+
+  head.transform_input(left, right);
+
+  head.accumulate(0U, head.partitions(), head_L, head_R);
+
+  head.transform_output(head_L, left);
+  head.transform_output(head_R, right);
+
+  if (!has_tail) {
+    return true;
+  }
+
+  if (!tail_late) {
+    for (size_t n = 0U; n < bufferSize; n++) {
+      left[n] += tail_out_L[output_slot][tail_position + n];
+      right[n] += tail_out_R[output_slot][tail_position + n];
+    }
+  }
+
+  tail_position += bufferSize;
+
+  if (tail_position == tail_block) {
+    if (!tail_dropped) {
+      tail_in_job[input_slot] = jobs_posted;
+    }
+
+    for (auto& s : job_started) {
+      s->release();
+    }
+
+    jobs_posted++;
+
+    tail_position = 0U;
+  }
+
+  return true;
+}
+
+void ConvolverNative::work(const uint id) {
+  const auto n_partitions = tail.partitions();
+  const auto chunk = (n_partitions + n_threads - 1U) / n_threads;
+  const auto first = std::min<size_t>(id * chunk, n_partitions);
+  const auto last = std::min<size_t>(first + chunk, n_partitions);
+
+  uint job = 0U;
+  uint index = 0U;
+
+  while (true) {
+    job_started[id]->acquire();
+
+    if (quit) {
+      return;
+    }
+
+    if (id == 0U) {
+      // The input slot of a dropped job still holds the input of an older one
+      if (tail_in_job[index] == job) {
+        tail.transform_input(tail_in_L[index], tail_in_R[index]);
+      } else {
+        tail.transform_input(tail_silence, tail_silence);
+      }
+    }
+
+    job_barrier->arrive_and_wait();
+
+    tail.accumulate(first, last, tail_acc_L[id], tail_acc_R[id]);
+
+    job_barrier->arrive_and_wait();
+
+    if (id == 0U) {
+      for (uint n = 1U; n < n_threads; n++) {
+        tail.merge(tail_acc_L[n], tail_acc_L[0]);
+        tail.merge(tail_acc_R[n], tail_acc_R[0]);
+      }
+
+      tail.transform_output(tail_acc_L[0], tail_out_L[index]);
+      tail.transform_output(tail_acc_R[0], tail_out_R[index]);
+
+      job_finished.release();
+    }
+
+    job++;
+    index = (index + 1U) % tail_slots;
+  }
+}
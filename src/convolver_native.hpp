@@ -0,0 +1,179 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <fftw3.h>
+#include <qtypes.h>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <cstddef>
+#include <memory>
+#include <semaphore>
+#include <span>
+#include <thread>
+#include <vector>
+#include "convolver_engine.hpp"
+#include "convolver_kernel_manager.hpp"
+#include "split_complex.hpp"
+
+/**
+ * Uniformly partitioned overlap-save convolution of a stereo signal with the
+ * kernel taps in [offset, offset + length). The spectra are kept in split
+ * complex form.
+ */
+class PartitionedConvolution {
+ public:
+  using Buffer = split_complex::Buffer;
+
+  struct Spectrum {
+    Buffer re, im;
+  };
+
+  PartitionedConvolution() = default;
+  PartitionedConvolution(const PartitionedConvolution&) = delete;
+  auto operator=(const PartitionedConvolution&) -> PartitionedConvolution& = delete;
+  PartitionedConvolution(const PartitionedConvolution&&) = delete;
+  auto operator=(const PartitionedConvolution&&) -> PartitionedConvolution& = delete;
+  ~PartitionedConvolution();
+
+  auto init(const ConvolverKernelManager::KernelData& kernel, size_t offset, size_t length, uint block) -> bool;
+
+  [[nodiscard]] auto partitions() const -> size_t;
+
+  [[nodiscard]] auto make_spectrum() const -> Spectrum;
+
+  // Adds the next block of both channels to the frequency domain delay line
+  void transform_input(std::span<const float> left, std::span<const float> right);
+
+  // Accumulates the contribution of the partitions in [first, last) to each output
+  void accumulate(size_t first, size_t last, Spectrum& left, Spectrum& right) const;
+
+  // Adds from to target and clears from
+  void merge(Spectrum& from, Spectrum& target) const;
+
+  // Writes the block resulting from the accumulated spectrum and clears it
+  void transform_output(Spectrum& spectrum, std::span<float> output);
+
+ private:
+  bool cross_channels = false;
+
+  uint block = 0U;
+
+  size_t n_partitions = 0U;
+  size_t n_bins = 0U;
+  size_t stride = 0U;  // Spectrum size rounded up to whole SIMD registers
+  size_t fdl_position = 0U;
+
+  fftwf_plan forward = nullptr;
+  fftwf_plan backward = nullptr;
+
+  Buffer time;
+
+  std::array<Buffer, 2> window;  // The previous and the current input block of each channel
+
+  std::array<Buffer, 2> fdl_re, fdl_im;
+
+  std::array<Buffer, 4> filter_re, filter_im;  // LL, RR, LR and RL paths
+
+  void destroy_plans();
+};
+
+/**
+ * Convolution engine accepting any block size without adding latency. The
+ * first partitions have the block size and are processed in the realtime
+ * thread. The rest of the kernel is processed in larger partitions by a pool
+ * of worker threads that has one tail period to deliver each result. A late
+ * result is left out instead of waited for.
+ */
+class ConvolverNative : public ConvolverEngine {
+ public:
+  explicit ConvolverNative(uint n_threads = 1U);
+  ConvolverNative(const ConvolverNative&) = delete;
+  auto operator=(const ConvolverNative&) -> ConvolverNative& = delete;
+  ConvolverNative(const ConvolverNative&&) = delete;
+  auto operator=(const ConvolverNative&&) -> ConvolverNative& = delete;
+  ~ConvolverNative() override;
+
+  auto init(const ConvolverKernelManager::KernelData& kernel, uint bufferSize) -> bool override;
+
+  auto process(std::span<float> left, std::span<float> right) -> bool override;
+
+  void stop() override;
+
+ private:
+  bool ready = false;
+  bool has_tail = false;
+
+  uint n_threads = 1U;
+  uint bufferSize = 0U;
+  uint tail_block = 0U;
+  uint tail_position = 0U;
+  uint jobs_posted = 0U;
+  uint jobs_collected = 0U;
+
+  static constexpr uint tail_factor = 8U;
+  static constexpr uint min_tail_block = 4096U;
+  static constexpr uint tail_slots = 3U;
+
+  /**
+   * Set at the start of a tail period. The realtime thread never waits for the
+   * workers. When the job due in this period is not done its output is left
+   * out. When the workers are so late that no input slot is free the job of
+   * the period is still posted but with silence as input. This way the tail
+   * delay line and the output slots stay aligned with the periods.
+   */
+  bool tail_late = false;
+  bool tail_dropped = false;
+
+  std::atomic<bool> quit = false;
+
+  // Tail periods left out because the workers missed their deadline
+  std::atomic<uint> missed_tails = 0U;
+
+  PartitionedConvolution head, tail;
+
+  PartitionedConvolution::Spectrum head_L, head_R;
+
+  std::vector<PartitionedConvolution::Spectrum> tail_acc_L, tail_acc_R;  // One per worker
+
+  /**
+   * Job n uses the slot n % tail_slots. While the realtime thread fills one
+   * slot a late job can still use another and the output of the job due in
+   * this period is in the third.
+   */
+
+  std::array<std::vector<float>, tail_slots> tail_in_L, tail_in_R, tail_out_L, tail_out_R;
+
+  // Job whose input is in each slot. A job that does not find its own index there uses tail_silence.
+  std::array<uint, tail_slots> tail_in_job{};
+
+  std::vector<float> tail_silence;
+
+  std::vector<std::thread> workers;
+
+  std::vector<std::unique_ptr<std::counting_semaphore<>>> job_started;
+
+  std::counting_semaphore<> job_finished{0};
+
+  std::unique_ptr<std::barrier<>> job_barrier;
+
+  void work(uint id);
+};
@@ -56,6 +56,12 @@ void ConvolverPreset::save(nlohmann::json& json) {
   json[section][instance_name]["sofa"]["elevation"] = settings->targetSofaElevation();
 
   json[section][instance_name]["sofa"]["radius"] = settings->targetSofaRadius();
+
+  json[section][instance_name]["sofa"]["interpolation"] = settings->sofaInterpolation();
+
+  json[section][instance_name]["engine"] = settings->defaultEngineLabelsValue()[settings->engine()].toStdString();
+
+  json[section][instance_name]["native-engine-threads"] = settings->nativeEngineThreads();
 }
 
 void ConvolverPreset::load(const nlohmann::json& json) {
@@ -66,10 +72,14 @@ void ConvolverPreset::load(const nlohmann::json& json) {
   UPDATE_PROPERTY("autogain", Autogain);
   UPDATE_PROPERTY("dry", Dry);
   UPDATE_PROPERTY("wet", Wet);
+  UPDATE_PROPERTY("native-engine-threads", NativeEngineThreads);
+
+  UPDATE_ENUM_LIKE_PROPERTY("engine", Engine);
 
   UPDATE_PROPERTY_INSIDE_SUBSECTION("sofa", "azimuth", TargetSofaAzimuth);
   UPDATE_PROPERTY_INSIDE_SUBSECTION("sofa", "elevation", TargetSofaElevation);
   UPDATE_PROPERTY_INSIDE_SUBSECTION("sofa", "radius", TargetSofaRadius);
+  UPDATE_PROPERTY_INSIDE_SUBSECTION("sofa", "interpolation", SofaInterpolation);
 
   // kernel-path deprecation
   const auto* kernel_name_key = "kernel-name";
@@ -0,0 +1,346 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "convolver_sofa_database.hpp"
+#include <mysofa.h>
+#include <qtypes.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include "convolver_kernel_manager.hpp"
+#include "resampler.hpp"
+#include "util.hpp"
+
+// https://www.sofaconventions.org/mediawiki/index.php/SOFA_specifications
+
+ConvolverSofaDatabase::ConvolverSofaDatabase(const std::string& file_path) : file_path(file_path) {
+  int error = 0;
+
+  hrtf = mysofa_load(file_path.c_str(), &error);
+
+  if (error != MYSOFA_OK) {
+    util::warning(std::format("Error while trying to load the sofa file: {}", util::mysofa_error_to_string(error)));
+  }
+
+  if (!hrtf) {
+    util::warning(std::format("Failed to load SOFA file: {} - Error: {}", file_path, error));
+    return;
+  }
+
+  // Validate the HRTF structure
+  if (mysofa_check(hrtf) != MYSOFA_OK) {
+    util::warning(std::format("SOFA file validation failed: {}", file_path));
+  }
+
+  if (hrtf->DataSamplingRate.elements > 0 && hrtf->DataSamplingRate.values) {
+    rate = static_cast<uint>(hrtf->DataSamplingRate.values[0]);
+
+    util::debug(std::format("Found SOFA sampling rate: {} Hz", rate));
+  }
+
+  M = static_cast<int>(hrtf->M);
+  R = static_cast<int>(hrtf->R);
+  N = static_cast<int>(hrtf->N);
+  E = static_cast<int>(hrtf->E);
+
+  util::debug(std::format("SOFA file measurements: {}", M));
+  util::debug(std::format("SOFA file receivers: {}", R));
+  util::debug(std::format("SOFA file filter length: {}", N));
+  util::debug(std::format("SOFA file emitters: {}", E));
+
+  metadata.measurements = M;
+  metadata.database = mysofa_getAttribute(hrtf->attributes, const_cast<char*>("DatabaseName"));
+
+  util::debug(std::format("Database: {}", metadata.database.toStdString()));
+
+  if (M <= 0 || R < 1 || N <= 0) {
+    util::warning(std::format("Invalid SOFA file structure: M={}, R={}, N={}", M, R, N));
+    return;
+  }
+
+  // The lookup tree and the neighborhood are built over the cartesian source positions
+
+  mysofa_tocartesian(hrtf);
+
+  lookup = mysofa_lookup_init(hrtf);
+
+  if (!lookup) {
+    util::warning("Failed to create SOFA lookup structure.");
+  } else {
+    util::debug(std::format("Theta min: {}, max: {}", lookup->theta_min, lookup->theta_max));
+    util::debug(std::format("Phi min: {}, max: {}", lookup->phi_min, lookup->phi_max));
+    util::debug(std::format("Radius min: {}, max: {}", lookup->radius_min, lookup->radius_max));
+
+    metadata.min_azimuth = lookup->phi_min;
+    metadata.max_azimuth = lookup->phi_max;
+    metadata.min_elevation = lookup->theta_min;
+    metadata.max_elevation = lookup->theta_max;
+    metadata.min_radius = lookup->radius_min;
+    metadata.max_radius = lookup->radius_max;
+
+    neighborhood = mysofa_neighborhood_init(hrtf, lookup);
+
+    if (!neighborhood) {
+      util::warning("Failed to create the SOFA neighborhood. Interpolation will not be available.");
+    }
+  }
+
+  loaded = true;
+}
+
+ConvolverSofaDatabase::~ConvolverSofaDatabase() {
+  if (neighborhood) {
+    mysofa_neighborhood_free(neighborhood);
+  }
+
+  if (lookup) {
+    mysofa_lookup_free(lookup);
+  }
+
+  if (hrtf) {
+    mysofa_free(hrtf);
+  }
+}
+
+auto ConvolverSofaDatabase::open(const std::string& file_path) -> std::shared_ptr<ConvolverSofaDatabase> {
+  static std::mutex databases_mutex;
+  static std::map<std::string, std::weak_ptr<ConvolverSofaDatabase>> databases;
+
+  std::scoped_lock<std::mutex> lock(databases_mutex);
+
+  if (auto it = databases.find(file_path); it != databases.end()) {
+    if (auto database = it->second.lock(); database != nullptr) {
+      return database;
+    }
+  }
+
+  // The constructor is private so std::make_shared can not be used
+
+  auto database = std::shared_ptr<ConvolverSofaDatabase>(new ConvolverSofaDatabase(file_path));
+
+  if (!database->loaded) {
+    return nullptr;
+  }
+
+  std::erase_if(databases, [](const auto& item) { return item.second.expired(); });
+
+  databases[file_path] = database;
+
+  return database;
+}
+
+auto ConvolverSofaDatabase::getImpulses(const uint& target_rate) -> std::shared_ptr<const Impulses> {
+  const auto output_rate = (target_rate == 0U) ? rate : target_rate;
+
+  std::scoped_lock<std::mutex> lock(impulses_mutex);
+
+  if (auto it = impulses.find(output_rate); it != impulses.end()) {
+    return it->second;
+  }
+
+  const auto n_impulses = static_cast<size_t>(M) * static_cast<size_t>(R) * static_cast<size_t>(E);
+  const auto n_frames = static_cast<size_t>(N);
+
+  const auto all_data = std::span<const float>(hrtf->DataIR.values, n_impulses * n_frames);
+
+  auto resampled = std::make_shared<Impulses>();
+
+  if (output_rate == rate) {
+    resampled->n_samples = n_frames;
+    resampled->data.assign(all_data.begin(), all_data.end());
+  } else {
+    util::debug(std::format("Resampling the {} impulses of {} from {} Hz to {} Hz", n_impulses, file_path, rate,
+                            output_rate));
+
+    for (size_t n = 0U; n < n_impulses; n++) {
+      Resampler resampler(static_cast<int>(rate), static_cast<int>(output_rate));
+
+      const auto& output = resampler.process(all_data.subspan(n * n_frames, n_frames));
+
+      // The first impulse sets the length of all the others
+
+      if (n == 0U) {
+        resampled->n_samples = output.size();
+        resampled->data.resize(n_impulses * resampled->n_samples, 0.0F);
+      }
+
+      std::copy_n(output.begin(), std::min(output.size(), resampled->n_samples),
+                  resampled->data.begin() + static_cast<std::ptrdiff_t>(n * resampled->n_samples));
+    }
+  }
+
+  impulses[output_rate] = resampled;
+
+  return resampled;
+}
+
+auto ConvolverSofaDatabase::findMeasurements(const float (&target)[3], const bool& interpolate) const
+    -> std::vector<std::pair<int, float>> {
+  if (!lookup) {
+    return {{0, 1.0F}};
+  }
+
+  // mysofa_lookup clamps the coordinate to the range covered by the database
+
+  float query[3] = {target[0], target[1], target[2]};
+
+  const auto nearest = mysofa_lookup(lookup, query);
+
+  if (nearest < 0) {
+    return {{0, 1.0F}};
+  }
+
+  if (!interpolate || !neighborhood) {
+    return {{nearest, 1.0F}};
+  }
+
+  // The 3 closest measurements are searched among the nearest one and its neighbors
+
+  std::vector<int> candidates = {nearest};
+
+  const auto* neighbors = mysofa_neighborhood(neighborhood, nearest);
+
+  for (int n = 0; neighbors != nullptr && n < 6; n++) {
+    if (neighbors[n] >= 0 && std::ranges::find(candidates, neighbors[n]) == candidates.end()) {
+      candidates.push_back(neighbors[n]);
+    }
+  }
+
+  std::vector<std::pair<int, float>> measurements;
+
+  for (const auto& m : candidates) {
+    const auto* position = hrtf->SourcePosition.values + (static_cast<size_t>(m) * 3U);
+
+    const auto distance = std::hypot(position[0] - query[0], position[1] - query[1], position[2] - query[2]);
+
+    measurements.emplace_back(m, distance);
+  }
+
+  std::ranges::sort(measurements, {}, &std::pair<int, float>::second);
+
+  if (measurements.front().second < 1e-6F) {
+    return {{measurements.front().first, 1.0F}};
+  }
+
+  measurements.resize(std::min<size_t>(measurements.size(), 3U));
+
+  float total = 0.0F;
+
+  for (auto& [m, weight] : measurements) {
+    weight = 1.0F / weight;
+
+    total += weight;
+  }
+
+  for (auto& [m, weight] : measurements) {
+    weight /= total;
+  }
+
+  return measurements;
+}
+
+auto ConvolverSofaDatabase::getKernel(const float& azimuth,
+                                      const float& elevation,
+                                      const float& radius,
+                                      const bool& interpolate,
+                                      const uint& target_rate) -> ConvolverKernelManager::KernelData {
+  ConvolverKernelManager::KernelData kernel_data;
+
+  if (!loaded) {
+    return kernel_data;
+  }
+
+  float target[3] = {azimuth, elevation, radius};
+
+  mysofa_s2c(target);
+
+  const auto measurements = findMeasurements(target, interpolate);
+
+  const auto impulses_data = getImpulses(target_rate);
+
+  const auto n_samples = impulses_data->n_samples;
+
+  const auto mix = [&](std::vector<float>& channel, const int& r, const int& e) {
+    channel.assign(n_samples, 0.0F);
+
+    for (const auto& [m, weight] : measurements) {
+      const auto offset = ((((static_cast<size_t>(m) * R) + r) * E) + e) * n_samples;
+
+      for (size_t n = 0U; n < n_samples; n++) {
+        channel[n] += weight * impulses_data->data[offset + n];
+      }
+    }
+  };
+
+  const auto m = measurements.front().first;
+
+  kernel_data.is_sofa = true;
+  kernel_data.rate = (target_rate == 0U) ? rate : target_rate;
+  kernel_data.original_rate = rate;
+  kernel_data.sofaMetadata = metadata;
+  kernel_data.sofaMetadata.index = m;
+
+  float selected[3] = {hrtf->SourcePosition.values[(m * 3) + 0], hrtf->SourcePosition.values[(m * 3) + 1],
+                       hrtf->SourcePosition.values[(m * 3) + 2]};
+
+  mysofa_c2s(selected);
+
+  kernel_data.sofaMetadata.azimuth = selected[0];
+  kernel_data.sofaMetadata.elevation = selected[1];
+  kernel_data.sofaMetadata.radius = selected[2];
+
+  util::debug(std::format("For the desired azimuth = {}, elevation = {} and radius = {} the nearest SOFA measurement "
+                          "index is {}. Interpolating {} measurements.",
+                          azimuth, elevation, radius, m, measurements.size()));
+
+  if (E == 1) {
+    kernel_data.channels = 2;
+
+    // Left ear (receiver 0)
+    mix(kernel_data.channel_L, 0, 0);
+
+    // Right ear (receiver 1)
+    if (R > 1) {
+      mix(kernel_data.channel_R, 1, 0);
+    } else {
+      kernel_data.channel_R = kernel_data.channel_L;
+    }
+  }
+
+  if (R == 2 && E == 2) {
+    // Assuming it is True Stereo HRTF: 4 channels
+
+    kernel_data.channels = 4;
+
+    mix(kernel_data.channel_L, 0, 0);   // LL: Emitter 0 to Receiver 0
+    mix(kernel_data.channel_LR, 1, 0);  // LR: Emitter 0 to Receiver 1
+    mix(kernel_data.channel_RL, 0, 1);  // RL: Emitter 1 to Receiver 0
+    mix(kernel_data.channel_R, 1, 1);   // RR: Emitter 1 to Receiver 1
+  }
+
+  return kernel_data;
+}
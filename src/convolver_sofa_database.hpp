@@ -0,0 +1,96 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <mysofa.h>
+#include <qtypes.h>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "convolver_kernel_manager.hpp"
+
+/**
+ * A SOFA file kept in memory together with the libmysofa lookup tree and the
+ * neighborhood of each measurement. Kernels for a new direction are built
+ * from it without reading the file again. The impulses are resampled once
+ * for each graph rate they are requested at.
+ */
+class ConvolverSofaDatabase {
+ public:
+  ConvolverSofaDatabase(const ConvolverSofaDatabase&) = delete;
+  auto operator=(const ConvolverSofaDatabase&) -> ConvolverSofaDatabase& = delete;
+  ConvolverSofaDatabase(const ConvolverSofaDatabase&&) = delete;
+  auto operator=(const ConvolverSofaDatabase&&) -> ConvolverSofaDatabase& = delete;
+  ~ConvolverSofaDatabase();
+
+  // Returns the database already loaded by another user or reads the file. Returns nullptr on failure.
+  static auto open(const std::string& file_path) -> std::shared_ptr<ConvolverSofaDatabase>;
+
+  /**
+   * Kernel for the direction closest to the target position. With interpolate
+   * set the impulses of the 3 closest measurements are mixed weighted by the
+   * inverse of their distance. A target_rate of zero keeps the file rate.
+   */
+  auto getKernel(const float& azimuth,
+                 const float& elevation,
+                 const float& radius,
+                 const bool& interpolate,
+                 const uint& target_rate) -> ConvolverKernelManager::KernelData;
+
+ private:
+  explicit ConvolverSofaDatabase(const std::string& file_path);
+
+  bool loaded = false;
+
+  uint rate = 48000U;
+
+  int M = 0;  // Number of measurements (source positions)
+  int R = 0;  // Number of receivers (ears, usually 2)
+  int N = 0;  // Filter length (samples per IR)
+  int E = 0;  // Number of emitters
+
+  std::string file_path;
+
+  ConvolverKernelManager::KernelData::SofaMetadata metadata;
+
+  MYSOFA_HRTF* hrtf = nullptr;
+  MYSOFA_LOOKUP* lookup = nullptr;
+  MYSOFA_NEIGHBORHOOD* neighborhood = nullptr;
+
+  // All impulses at a given rate. Each one has n_samples and they are stored in the DataIR order.
+
+  struct Impulses {
+    size_t n_samples = 0U;
+
+    std::vector<float> data;
+  };
+
+  std::mutex impulses_mutex;
+
+  std::map<uint, std::shared_ptr<const Impulses>> impulses;
+
+  auto getImpulses(const uint& target_rate) -> std::shared_ptr<const Impulses>;
+
+  auto findMeasurements(const float (&target)[3], const bool& interpolate) const -> std::vector<std::pair<int, float>>;
+};
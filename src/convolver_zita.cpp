@@ -23,12 +23,11 @@
 #include <zita-convolver.h>
 #include <algorithm>
 #include <chrono>
-#include <cmath>
 #include <format>
-#include <mutex>
 #include <span>
 #include <thread>
 #include "convolver_kernel_manager.hpp"
+#include "fftw_planner.hpp"
 #include "util.hpp"
 
 namespace {
@@ -43,14 +42,14 @@ ConvolverZita::ConvolverZita() = default;
 ConvolverZita::~ConvolverZita() {
   stop();
 
-  delete conv;
+  // Instances may be deleted outside the thread that created them. The fftw plans are destroyed in this call.
+
+  FftwPlanner::self().run([this] { delete conv; });
 
   conv = nullptr;
 }
 
 void ConvolverZita::stop() {
-  std::scoped_lock<std::mutex> lock(util::fftw_lock());
-
   ready = false;
 
   if (conv) {
@@ -62,12 +61,13 @@ void ConvolverZita::stop() {
   }
 }
 
-auto ConvolverZita::init(ConvolverKernelManager::KernelData data,
-                         uint bufferSize,
-                         const int& ir_width,
-                         const bool& apply_autogain) -> bool {
-  std::scoped_lock<std::mutex> lock(util::fftw_lock());
+auto ConvolverZita::init(const ConvolverKernelManager::KernelData& kernel, uint bufferSize) -> bool {
+  // Zita creates and destroys fftw plans in most of the calls below
+
+  return FftwPlanner::self().run([&] { return configure(kernel, bufferSize); });
+}
 
+auto ConvolverZita::configure(const ConvolverKernelManager::KernelData& kernel, uint bufferSize) -> bool {
   ready = false;
 
   if (conv != nullptr) {
@@ -91,13 +91,8 @@ auto ConvolverZita::init(ConvolverKernelManager::KernelData data,
 
   conv->set_options(0);
 
-  kernel = data;
-  original_kernel = kernel;
-
   this->bufferSize = bufferSize;
 
-  update_ir_width_and_autogain(ir_width, apply_autogain, false);
-
   float density = 0.5F;
 
   if (auto ret = conv->configure(2, 2, kernel.sampleCount(), bufferSize, bufferSize, Convproc::MAXPART, density);
@@ -107,8 +102,16 @@ auto ConvolverZita::init(ConvolverKernelManager::KernelData data,
     return false;
   }
 
-  if (auto ret = conv->impdata_create(0, 0, 1, kernel.channel_L.data(), 0, static_cast<int>(kernel.sampleCount()));
-      ret != 0) {
+  // Zita only reads the kernel. It copies it to its own partitions.
+
+  auto* kernel_L = const_cast<float*>(kernel.channel_L.data());
+  auto* kernel_R = const_cast<float*>(kernel.channel_R.data());
+  auto* kernel_LR = const_cast<float*>(kernel.channel_LR.data());
+  auto* kernel_RL = const_cast<float*>(kernel.channel_RL.data());
+
+  const auto n_frames = static_cast<int>(kernel.sampleCount());
+
+  if (auto ret = conv->impdata_create(0, 0, 1, kernel_L, 0, n_frames); ret != 0) {
     util::warning(std::format("Zita: left impdata_create failed: {}", ret));
 
     delete conv;
@@ -117,8 +120,7 @@ auto ConvolverZita::init(ConvolverKernelManager::KernelData data,
     return false;
   }
 
-  if (auto ret = conv->impdata_create(1, 1, 1, kernel.channel_R.data(), 0, static_cast<int>(kernel.sampleCount()));
-      ret != 0) {
+  if (auto ret = conv->impdata_create(1, 1, 1, kernel_R, 0, n_frames); ret != 0) {
     util::warning(std::format("Zita: right impdata_create failed: {}", ret));
 
     delete conv;
@@ -128,8 +130,7 @@ auto ConvolverZita::init(ConvolverKernelManager::KernelData data,
   }
 
   if (kernel.channels == 4) {
-    if (auto ret = conv->impdata_create(0, 1, 1, kernel.channel_LR.data(), 0, static_cast<int>(kernel.sampleCount()));
-        ret != 0) {
+    if (auto ret = conv->impdata_create(0, 1, 1, kernel_LR, 0, n_frames); ret != 0) {
       util::warning(std::format("Zita: LR impdata_create failed: {}", ret));
 
       delete conv;
@@ -138,8 +139,7 @@ auto ConvolverZita::init(ConvolverKernelManager::KernelData data,
       return false;
     }
 
-    if (auto ret = conv->impdata_create(1, 0, 1, kernel.channel_RL.data(), 0, static_cast<int>(kernel.sampleCount()));
-        ret != 0) {
+    if (auto ret = conv->impdata_create(1, 0, 1, kernel_RL, 0, n_frames); ret != 0) {
       util::warning(std::format("Zita: RL impdata_create failed: {}", ret));
 
       delete conv;
@@ -188,8 +188,6 @@ auto ConvolverZita::process(std::span<float> left, std::span<float> right) -> bo
   std::ranges::copy(left, convLeftIn.begin());
   std::ranges::copy(right, convRightIn.begin());
 
-  std::scoped_lock<std::mutex> lock(util::fftw_lock());
-
   if (auto ret = conv->process(true); ret != 0) {
     util::warning(std::format("Zita: process failed: {}", ret));
 
@@ -203,118 +201,3 @@ auto ConvolverZita::process(std::span<float> left, std::span<float> right) -> bo
 
   return true;
 }
-
-void ConvolverZita::reset_kernel_to_original() {
-  kernel = original_kernel;
-}
-
-void ConvolverZita::apply_kernel_autogain() {
-  if (!kernel.isValid()) {
-    return;
-  }
-
-  ConvolverKernelManager::normalizeKernel(kernel);
-
-  // find average power
-
-  float power_LL = 0.0F;
-  float power_RR = 0.0F;
-  float power_LR = 0.0F;
-  float power_RL = 0.0F;
-
-  for (uint i = 0; i < kernel.sampleCount(); i++) {
-    power_LL += kernel.channel_L[i] * kernel.channel_L[i];
-    power_RR += kernel.channel_R[i] * kernel.channel_R[i];
-
-    if (kernel.channels == 4) {
-      power_LR += kernel.channel_LR[i] * kernel.channel_LR[i];
-      power_RL += kernel.channel_RL[i] * kernel.channel_RL[i];
-    }
-  }
-
-  const float power = std::max({power_LL, power_RR, power_LR, power_RL});
-
-  const float autogain = std::min(1.0F, 1.0F / std::sqrt(power));
-
-  util::debug(std::format("autogain factor: {}", autogain));
-
-  for (uint i = 0; i < kernel.sampleCount(); i++) {
-    kernel.channel_L[i] *= autogain;
-    kernel.channel_R[i] *= autogain;
-
-    if (kernel.channels == 4) {
-      kernel.channel_LR[i] *= autogain;
-      kernel.channel_RL[i] *= autogain;
-    }
-  }
-}
-
-/**
- * Mid-Side based Stereo width effect
- * taken from https://github.com/tomszilagyi/ir.lv2/blob/automatable/ir.cc
- */
-void ConvolverZita::set_kernel_stereo_width(const int& ir_width) {
-  if (!kernel.isValid()) {
-    return;
-  }
-
-  const float w = static_cast<float>(ir_width) * 0.01F;
-  const float x = (1.0F - w) / (1.0F + w);  // M-S coeff.; L_out = L + x*R; R_out = R + x*L
-
-  for (uint i = 0; i < kernel.sampleCount(); i++) {
-    const float LL = kernel.channel_L[i];
-    const float RR = kernel.channel_R[i];
-
-    float LR = 0.0F;
-    float RL = 0.0F;
-
-    if (kernel.channels == 4) {
-      LR = kernel.channel_LR[i];
-      RL = kernel.channel_RL[i];
-    }
-
-    // Apply width to direct paths
-    float new_LL = LL + (x * RR);
-    float new_RR = RR + (x * LL);
-
-    // Apply complementary width to cross paths
-    float new_LR = LR - (x * RL);
-    float new_RL = RL - (x * LR);
-
-    kernel.channel_L[i] = new_LL;
-    kernel.channel_R[i] = new_RR;
-
-    if (kernel.channels == 4) {
-      kernel.channel_LR[i] = new_LR;
-      kernel.channel_RL[i] = new_RL;
-    }
-  }
-}
-
-void ConvolverZita::update_ir_width_and_autogain(const int& ir_width,
-                                                 const bool& apply_autogain,
-                                                 const bool& clear_zita) {
-  reset_kernel_to_original();
-
-  set_kernel_stereo_width(ir_width);
-
-  if (apply_autogain) {
-    apply_kernel_autogain();
-  }
-
-  if (clear_zita && conv) {
-    conv->impdata_clear(0, 0);
-    conv->impdata_clear(1, 1);
-
-    conv->impdata_update(0, 0, 1, kernel.channel_L.data(), 0, static_cast<int>(kernel.sampleCount()));
-    conv->impdata_update(1, 1, 1, kernel.channel_R.data(), 0, static_cast<int>(kernel.sampleCount()));
-
-    if (kernel.channels == 4) {
-      conv->impdata_clear(0, 1);
-      conv->impdata_clear(1, 0);
-
-      conv->impdata_update(0, 1, 1, kernel.channel_LR.data(), 0, static_cast<int>(kernel.sampleCount()));
-      conv->impdata_update(1, 0, 1, kernel.channel_RL.data(), 0, static_cast<int>(kernel.sampleCount()));
-    }
-  }
-}
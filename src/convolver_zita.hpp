@@ -22,41 +22,30 @@
 #include <qtypes.h>
 #include <zita-convolver.h>
 #include <span>
+#include "convolver_engine.hpp"
 #include "convolver_kernel_manager.hpp"
 
-class ConvolverZita {
+class ConvolverZita : public ConvolverEngine {
  public:
   ConvolverZita();
-  ~ConvolverZita();
-
   ConvolverZita(const ConvolverZita&) = delete;
   auto operator=(const ConvolverZita&) -> ConvolverZita& = delete;
+  ConvolverZita(const ConvolverZita&&) = delete;
+  auto operator=(const ConvolverZita&&) -> ConvolverZita& = delete;
+  ~ConvolverZita() override;
 
-  // Movable if needed
-  ConvolverZita(ConvolverZita&&) noexcept = default;
-  auto operator=(ConvolverZita&&) noexcept -> ConvolverZita& = default;
-
-  auto init(ConvolverKernelManager::KernelData data, uint bufferSize, const int& ir_width, const bool& apply_autogain)
-      -> bool;
-
-  auto process(std::span<float> dataLeft, std::span<float> dataRight) -> bool;
+  auto init(const ConvolverKernelManager::KernelData& kernel, uint bufferSize) -> bool override;
 
-  void stop();
+  auto process(std::span<float> dataLeft, std::span<float> dataRight) -> bool override;
 
-  void reset_kernel_to_original();
-
-  void update_ir_width_and_autogain(const int& ir_width, const bool& apply_autogain, const bool& clear_zita);
+  void stop() override;
 
  private:
   bool ready = false;
 
   uint bufferSize = 0;
 
-  ConvolverKernelManager::KernelData kernel, original_kernel;
-
   Convproc* conv = nullptr;
 
-  void apply_kernel_autogain();
-
-  void set_kernel_stereo_width(const int& ir_width);
+  auto configure(const ConvolverKernelManager::KernelData& kernel, uint bufferSize) -> bool;
 };
@@ -19,9 +19,11 @@
 
 #include "crossfeed.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <format>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include "db_manager.hpp"
@@ -29,6 +31,7 @@
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
+#include "rt_macros.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
 
@@ -48,17 +51,9 @@ Crossfeed::Crossfeed(const std::string& tag, pw::Manager* pipe_manager, Pipeline
 
   // specific plugin controls
 
-  connect(settings, &DbCrossfeed::fcutChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(data_mutex);
+  BIND_RT_VALUE_NOTIFY(fcut, fcut, DbCrossfeed::fcutChanged, level_changed);
 
-    bs2b.set_level_feed(settings->fcut());
-  });
-
-  connect(settings, &DbCrossfeed::feedChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(data_mutex);
-
-    bs2b.set_level_feed(10 * static_cast<int>(settings->feed()));
-  });
+  BIND_RT_VALUE_NOTIFY(feed, feed, DbCrossfeed::feedChanged, level_changed);
 }
 
 Crossfeed::~Crossfeed() {
@@ -85,7 +80,7 @@ void Crossfeed::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   data.resize(2U * static_cast<size_t>(n_samples));
 
@@ -98,15 +93,20 @@ void Crossfeed::process(std::span<float>& left_in,
                         std::span<float>& right_in,
                         std::span<float>& left_out,
                         std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass) {
+  if (bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
     return;
   }
 
+  if (level_changed.exchange(false, std::memory_order_acquire)) {
+    bs2b.set_level_fcut(fcut.load(std::memory_order_relaxed));
+    bs2b.set_level_feed(10 * feed.load(std::memory_order_relaxed));
+  }
+
   if (input_gain != 1.0F) {
     apply_gain(left_in, right_in, input_gain);
   }
@@ -23,6 +23,7 @@
 #include <qqmlintegration.h>
 #include <qtmetamacros.h>
 #include <QString>
+#include <atomic>
 #include <span>
 #include <string>
 #include <vector>
@@ -69,5 +70,11 @@ class Crossfeed : public PluginBase {
 
   bs2b_base bs2b;
 
+  // The bs2b levels only recompute its coefficients. process() applies them when level_changed is set.
+
+  std::atomic<int> fcut = {0}, feed = {0};
+
+  std::atomic<bool> level_changed = {false};
+
   DbCrossfeed* settings = nullptr;
 };
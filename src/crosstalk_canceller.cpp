@@ -20,9 +20,12 @@
 
 #include "crosstalk_canceller.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <format>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include "db_manager.hpp"
@@ -30,6 +33,7 @@
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
+#include "rt_macros.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
 
@@ -52,12 +56,12 @@ CrosstalkCanceller::CrosstalkCanceller(const std::string& tag,
 
   // specific plugin controls
 
-  connect(settings, &DbCrosstalkCanceller::delayUsChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(data_mutex);
+  BIND_RT_VALUE(phantom_center_only, phantomCenterOnly, DbCrosstalkCanceller::phantomCenterOnlyChanged);
 
-    a.configure(settings->delayUs(), rate);
-    b.configure(settings->delayUs(), rate);
-  });
+  BIND_RT_VALUE_TRANSFORM(decay_gain, decayDb, DbCrosstalkCanceller::decayDbChanged,
+                          [](const double& v) { return std::pow(10.0, v / 20.0); });
+
+  BIND_RT_VALUE_NOTIFY(delay_us, delayUs, DbCrosstalkCanceller::delayUsChanged, delay_changed);
 }
 
 CrosstalkCanceller::~CrosstalkCanceller() {
@@ -84,38 +88,52 @@ void CrosstalkCanceller::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   data.resize(2U * static_cast<size_t>(n_samples));
 
-  a.configure(settings->delayUs(), rate);
-  b.configure(settings->delayUs(), rate);
+  const auto max_delay_us = settings->getMaxValue("delayUs");
+
+  a.reserve(max_delay_us, rate);
+  b.reserve(max_delay_us, rate);
+
+  delay_changed.store(false, std::memory_order_relaxed);
+
+  a.configure(delay_us.load(std::memory_order_relaxed), rate);
+  b.configure(delay_us.load(std::memory_order_relaxed), rate);
 }
 
 void CrosstalkCanceller::process(std::span<float>& left_in,
                                  std::span<float>& right_in,
                                  std::span<float>& left_out,
                                  std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass) {
+  if (bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
     return;
   }
 
+  // The delay lines were reserved for the longest delay in setup
+
+  if (delay_changed.exchange(false, std::memory_order_acquire)) {
+    a.configure(delay_us.load(std::memory_order_relaxed), rate);
+    b.configure(delay_us.load(std::memory_order_relaxed), rate);
+  }
+
   if (input_gain != 1.0F) {
     apply_gain(left_in, right_in, input_gain);
   }
 
-  const auto decay_gain = static_cast<float>(std::pow(10, settings->decayDb() / 20));
+  const auto decay = decay_gain.load(std::memory_order_relaxed);
 
-  if (settings->phantomCenterOnly()) {
+  if (phantom_center_only.load(std::memory_order_relaxed)) {
     for (size_t n = 0U; n < left_in.size(); n++) {
       const float middle = left_in[n] + right_in[n];
       const float side = left_in[n] - right_in[n];
-      const auto mo = middle - (decay_gain * a.get_sample());
+      const auto mo = middle - (decay * a.get_sample());
       const auto so = side;
       left_out[n] = (mo + so) * .5f;
       right_out[n] = (mo - so) * .5f;
@@ -124,8 +142,8 @@ void CrosstalkCanceller::process(std::span<float>& left_in,
     }
   } else {
     for (size_t n = 0U; n < left_in.size(); n++) {
-      const auto ao = left_in[n] - (decay_gain * b.get_sample());
-      const auto bo = right_in[n] - (decay_gain * a.get_sample());
+      const auto ao = left_in[n] - (decay * b.get_sample());
+      const auto bo = right_in[n] - (decay * a.get_sample());
       left_out[n] = ao;
       right_out[n] = bo;
       a.put_sample(ao);
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cmath>
 #include <span>
 #include <string>
@@ -158,6 +159,14 @@ class FilterState {
   Biquad f6;
 
  public:
+  /**
+   * Allocate the delay line for the longest delay, so later calls to configure
+   * with a shorter one do not allocate.
+   */
+  void reserve(const double max_delay_us, const double rate) {
+    data.reserve(static_cast<size_t>(std::round(max_delay_us / 1.0e6 * rate)));
+  }
+
   /**
    * Set up filtering line for specific delay and configure filters with sample rate.
    */
@@ -258,4 +267,14 @@ class CrosstalkCanceller : public PluginBase {
   FilterState b;
 
   DbCrosstalkCanceller* settings = nullptr;
+
+  std::atomic<bool> phantom_center_only = {false};
+
+  std::atomic<float> decay_gain = {1.0F};
+
+  // Applied to the delay lines by process() when delay_changed is set
+
+  std::atomic<double> delay_us = {313.0};
+
+  std::atomic<bool> delay_changed = {false};
 };
@@ -93,7 +93,7 @@ void Crusher::clear_data() {
   }
 
   {
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
     lv2_wrapper->destroy_instance_locked();
   }
@@ -107,7 +107,7 @@ void Crusher::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   ready = false;
 
@@ -123,7 +123,7 @@ void Crusher::setup() {
       [this] {
         lv2_wrapper->create_instance(rate);
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         ready = true;
       },
@@ -21,24 +21,28 @@
 #include <qlist.h>
 #include <qnamespace.h>
 #include <qobjectdefs.h>
+#include <qtimer.h>
 #include <qtypes.h>
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <cstddef>
 #include <format>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include <vector>
 #include "db_manager.hpp"
 #include "easyeffects_db_crystalizer.h"
 #include "fir_filter_bandpass.hpp"
+#include "oversampler.hpp"
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
-#include "resampler.hpp"
+#include "rt_macros.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
 
@@ -66,11 +70,8 @@ Crystalizer::Crystalizer(const std::string& tag, pw::Manager* pipe_manager, Pipe
       settings(db::Manager::self().get_plugin_db<DbCrystalizer>(
           pipe_type,
           tags::plugin_name::BaseName::crystalizer + "#" + instance_id)),
+      filterbank(log_tag + name.toStdString() + " "),
       adaptive_intensities(nbands, 1.0F) {
-  for (uint n = 0U; n < nbands; n++) {
-    filters.at(n) = std::make_unique<FirFilterBandpass>(log_tag + name.toStdString() + " band" + util::to_string(n));
-  }
-
   std::ranges::fill(band_mute, false);
   std::ranges::fill(band_bypass, false);
   std::ranges::fill(band_intensity, 1.0F);
@@ -107,37 +108,21 @@ Crystalizer::Crystalizer(const std::string& tag, pw::Manager* pipe_manager, Pipe
   BIND_BAND(11);
   BIND_BAND(12);
 
+  BIND_RT_VALUE(adaptive_intensity, adaptiveIntensity, DbCrystalizer::adaptiveIntensityChanged);
+
   connect(settings, &DbCrystalizer::useFixedQuantumChanged, [&]() { setup(); });
 
   connect(settings, &DbCrystalizer::oversamplingChanged, [&]() { setup(); });
 
   connect(settings, &DbCrystalizer::transitionBandChanged, [&]() { setup(); });
 
-  connect(settings, &DbCrystalizer::oversamplingQualityChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(data_mutex);
-
-    if (resampler_inL) {
-      resampler_inL->set_quality(settings->oversamplingQuality());
-    }
-
-    if (resampler_inR) {
-      resampler_inR->set_quality(settings->oversamplingQuality());
-    }
-
-    if (resampler_outL) {
-      resampler_outL->set_quality(settings->oversamplingQuality());
-    }
-
-    if (resampler_outR) {
-      resampler_outR->set_quality(settings->oversamplingQuality());
-    }
-  });
+  connect(settings, &DbCrystalizer::oversamplingQualityChanged, [&]() { rebuild_oversampler(); });
 }
 
 Crystalizer::~Crystalizer() {
   stop_worker();
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   if (connected_to_pw) {
     disconnect_from_pw();
@@ -147,6 +132,8 @@ Crystalizer::~Crystalizer() {
 
   filters_are_ready = false;
 
+  delete_pending_oversamplers();
+
   util::debug(std::format("{}{} destroyed", log_tag, name.toStdString()));
 }
 
@@ -164,7 +151,7 @@ void Crystalizer::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   auto same_blocksize = settings->useFixedQuantum() ? n_samples == default_quantum : n_samples == blocksize;
 
@@ -175,10 +162,8 @@ void Crystalizer::setup() {
   filters_are_ready = false;
 
   /**
-   * As zita uses fftw we have to be careful when reinitializing it.
-   * The thread that creates the fftw plan has to be the same that destroys it.
-   * Otherwise segmentation faults can happen. As we do not want to do this
-   * initializing in the plugin realtime thread we send it to the main thread.
+   * Designing the kernels and transforming them is too expensive for the
+   * plugin realtime thread. So we send this initialization to the main thread.
    */
 
   // NOLINTBEGIN(clang-analyzer-cplusplus.NewDeleteLeaks)
@@ -213,8 +198,13 @@ void Crystalizer::setup() {
           }
         }
 
-        blocksize = std::max<uint>(blocksize, 64);    // zita does not work with less than 64
-        blocksize = std::min<uint>(blocksize, 8192);  // zita does not work with more that 8192
+        /**
+         * The bank partitions the kernels at the block size. Small blocks would need too many partitions and the
+         * band analysis needs a reasonable amount of samples.
+         */
+
+        blocksize = std::max<uint>(blocksize, 64);
+        blocksize = std::min<uint>(blocksize, 8192);
 
         util::debug(std::format("{}{} blocksize: {}", log_tag, name.toStdString(), blocksize));
 
@@ -257,30 +247,36 @@ void Crystalizer::setup() {
           global_second_derivative_R.resize(blocksize);
         }
 
+        FirFilterBandpass designer(log_tag + name.toStdString() + " ");
+
+        designer.set_rate(blockrate);
+        designer.set_transition_band(settings->transitionBand());
+
+        std::vector<std::vector<float>> kernels(nbands);
+
         for (uint n = 0U; n < nbands; n++) {
-          filters.at(n)->set_n_samples(blocksize);
-          filters.at(n)->set_rate(blockrate);
-          filters.at(n)->set_min_frequency(frequencies.at(n));
-          filters.at(n)->set_max_frequency(frequencies.at(n + 1U));
-          filters.at(n)->set_transition_band(settings->transitionBand());
-          filters.at(n)->setup();
+          designer.set_min_frequency(frequencies.at(n));
+          designer.set_max_frequency(frequencies.at(n + 1U));
+          designer.create_kernel();
+
+          kernels[n] = designer.get_kernel();
         }
 
-        resampler_inL = std::make_unique<Resampler>(rate, 2 * rate);
-        resampler_inR = std::make_unique<Resampler>(rate, 2 * rate);
+        filterbank.setup(kernels, blocksize);
 
-        resampler_outL = std::make_unique<Resampler>(2 * rate, rate);
-        resampler_outR = std::make_unique<Resampler>(2 * rate, rate);
+        delete_pending_oversamplers();
 
-        resampler_inL->set_quality(settings->oversamplingQuality());
+        oversampler = std::make_unique<Oversampler>(2U);
 
-        resampler_inR->set_quality(settings->oversamplingQuality());
+        oversampler->set_quality(static_cast<int>(settings->oversamplingQuality()));
 
-        resampler_outL->set_quality(settings->oversamplingQuality());
+        upsampled_L.resize(2U * n_samples);
+        upsampled_R.resize(2U * n_samples);
 
-        resampler_outR->set_quality(settings->oversamplingQuality());
+        downsampled_L.resize(blocksize / 2U);
+        downsampled_R.resize(blocksize / 2U);
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         filters_are_ready = true;
       },
@@ -293,9 +289,9 @@ void Crystalizer::process(std::span<float>& left_in,
                           std::span<float>& right_in,
                           std::span<float>& left_out,
                           std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass) {
+  if (bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
@@ -317,6 +313,18 @@ void Crystalizer::process(std::span<float>& left_in,
     return;
   }
 
+  // A new oversampler is only taken after the previous replaced one was deleted
+
+  if (oversampler_retired.load(std::memory_order_acquire) == nullptr) {
+    if (auto* next = oversampler_pending.exchange(nullptr, std::memory_order_acq_rel); next != nullptr) {
+      oversampler_retired.store(oversampler.release(), std::memory_order_release);
+
+      oversampler.reset(next);
+
+      notify_latency = true;
+    }
+  }
+
   if (n_samples_is_power_of_2 && blocksize == n_samples && !do_oversampling) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
@@ -327,11 +335,11 @@ void Crystalizer::process(std::span<float>& left_in,
       buf_in_L.insert(buf_in_L.end(), left_in.begin(), left_in.end());
       buf_in_R.insert(buf_in_R.end(), right_in.begin(), right_in.end());
     } else {
-      const auto resampled_inL = resampler_inL->process(left_in);
-      const auto resampled_inR = resampler_inR->process(right_in);
+      oversampler->upsample(0U, left_in, upsampled_L);
+      oversampler->upsample(1U, right_in, upsampled_R);
 
-      buf_in_L.insert(buf_in_L.end(), resampled_inL.begin(), resampled_inL.end());
-      buf_in_R.insert(buf_in_R.end(), resampled_inR.begin(), resampled_inR.end());
+      buf_in_L.insert(buf_in_L.end(), upsampled_L.begin(), upsampled_L.begin() + (2U * left_in.size()));
+      buf_in_R.insert(buf_in_R.end(), upsampled_R.begin(), upsampled_R.begin() + (2U * right_in.size()));
     }
 
     // util::warning(std::format("size 1: {}, size 2: {}, size 3: {}", buf_in_L.size(), left_in.size(), data_L.size()));
@@ -346,11 +354,11 @@ void Crystalizer::process(std::span<float>& left_in,
         buf_out_L.insert(buf_out_L.end(), data_L.begin(), data_L.end());
         buf_out_R.insert(buf_out_R.end(), data_R.begin(), data_R.end());
       } else {
-        auto resampled_outL = resampler_outL->process(data_L);
-        auto resampled_outR = resampler_outR->process(data_R);
+        oversampler->downsample(0U, data_L, downsampled_L);
+        oversampler->downsample(1U, data_R, downsampled_R);
 
-        buf_out_L.insert(buf_out_L.end(), resampled_outL.begin(), resampled_outL.end());
-        buf_out_R.insert(buf_out_R.end(), resampled_outR.begin(), resampled_outR.end());
+        buf_out_L.insert(buf_out_L.end(), downsampled_L.begin(), downsampled_L.end());
+        buf_out_R.insert(buf_out_R.end(), downsampled_R.begin(), downsampled_R.end());
       }
     }
 
@@ -385,7 +393,9 @@ void Crystalizer::process(std::span<float>& left_in,
   }
 
   if (notify_latency) {
-    latency_value = static_cast<float>(latency_n_frames) / static_cast<float>(rate);
+    const auto oversampler_latency = do_oversampling && oversampler ? oversampler->get_latency_frames() : 0U;
+
+    latency_value = static_cast<float>(latency_n_frames + oversampler_latency) / static_cast<float>(rate);
 
     util::debug(std::format("{}{} latency: {} s", log_tag, name.toStdString(), latency_value));
 
@@ -406,6 +416,38 @@ void Crystalizer::process([[maybe_unused]] std::span<float>& left_in,
                           [[maybe_unused]] std::span<float>& probe_left,
                           [[maybe_unused]] std::span<float>& probe_right) {}
 
+void Crystalizer::rebuild_oversampler() {
+  // NOLINTBEGIN(clang-analyzer-cplusplus.NewDeleteLeaks)
+  QMetaObject::invokeMethod(
+      baseWorker,
+      [this] {
+        if (!filters_are_ready) {
+          // setup() creates the oversampler with the current quality
+          return;
+        }
+
+        auto next = std::make_unique<Oversampler>(2U);
+
+        next->set_quality(static_cast<int>(settings->oversamplingQuality()));
+
+        delete oversampler_retired.exchange(nullptr, std::memory_order_acq_rel);
+
+        delete oversampler_pending.exchange(next.release(), std::memory_order_acq_rel);
+
+        // The realtime thread may have been between taking the previous instance and retiring it
+
+        QTimer::singleShot(retire_delay, baseWorker,
+                           [this]() { delete oversampler_retired.exchange(nullptr, std::memory_order_acq_rel); });
+      },
+      Qt::QueuedConnection);
+  // NOLINTEND(clang-analyzer-cplusplus.NewDeleteLeaks)
+}
+
+void Crystalizer::delete_pending_oversamplers() {
+  delete oversampler_pending.exchange(nullptr);
+  delete oversampler_retired.exchange(nullptr);
+}
+
 auto Crystalizer::get_latency_seconds() -> float {
   return this->latency_value;
 }
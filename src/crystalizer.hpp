@@ -26,16 +26,18 @@
 #include <QString>
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <span>
 #include <string>
 #include <vector>
 #include "easyeffects_db_crystalizer.h"
-#include "fir_filter_base.hpp"
+#include "fir_filter_bank.hpp"
+#include "oversampler.hpp"
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
-#include "resampler.hpp"
 #include "util.hpp"
 
 class Crystalizer : public PluginBase {
@@ -110,6 +112,8 @@ class Crystalizer : public PluginBase {
 
   DbCrystalizer* settings = nullptr;
 
+  std::atomic<bool> adaptive_intensity = {false};
+
   std::vector<float> data_L;
   std::vector<float> data_R;
 
@@ -143,13 +147,29 @@ class Crystalizer : public PluginBase {
 
   std::array<std::vector<float>, nbands> band_previous_data_L, band_previous_data_R;
 
-  std::array<std::unique_ptr<FirFilterBase>, nbands> filters;
+  FirFilterBank filterbank;
 
   std::vector<float> buf_in_L, buf_in_R;
   std::vector<float> buf_out_L, buf_out_R;
 
-  std::unique_ptr<Resampler> resampler_inL, resampler_outL;
-  std::unique_ptr<Resampler> resampler_inR, resampler_outR;
+  std::vector<float> upsampled_L, upsampled_R;
+  std::vector<float> downsampled_L, downsampled_R;
+
+  std::unique_ptr<Oversampler> oversampler;
+
+  /**
+   * A quality change redesigns the oversampling filter. The worker builds the
+   * new instance and process() swaps it in. The replaced one is deleted by the
+   * worker before it publishes another and once more after retire_delay.
+   */
+  std::atomic<Oversampler*> oversampler_pending = nullptr;
+  std::atomic<Oversampler*> oversampler_retired = nullptr;
+
+  static constexpr auto retire_delay = std::chrono::seconds(1);
+
+  void rebuild_oversampler();
+
+  void delete_pending_oversamplers();
 
   QList<float> adaptive_intensities;
 
@@ -178,15 +198,14 @@ class Crystalizer : public PluginBase {
 
   template <typename T1>
   void enhance_peaks(T1& data_left, T1& data_right) {
+    // The bank transforms each channel once and derives all the bands from the same spectrum
+
+    filterbank.process(data_left, data_right, band_data_L, band_data_R);
+
     for (uint n = 0U; n < nbands; n++) {
       auto& bandn_L = band_data_L.at(n);
       auto& bandn_R = band_data_R.at(n);
 
-      std::copy(data_left.begin(), data_left.end(), bandn_L.begin());
-      std::copy(data_right.begin(), data_right.end(), bandn_R.begin());
-
-      filters.at(n)->process(bandn_L, bandn_R);
-
       /**
        * Later we will need to calculate the second derivative of each band.
        * This is done through the central difference method. In order to
@@ -206,7 +225,7 @@ class Crystalizer : public PluginBase {
       }
     }
 
-    if (settings->adaptiveIntensity()) {
+    if (adaptive_intensity.load(std::memory_order_relaxed)) {
       if (is_first_buffer) {
         global_previous_L = data_left[0];
         global_previous_R = data_right[0];
@@ -274,7 +293,7 @@ class Crystalizer : public PluginBase {
         float intensity_L = intensity;
         float intensity_R = intensity;
 
-        if (settings->adaptiveIntensity()) {
+        if (adaptive_intensity.load(std::memory_order_relaxed)) {
           intensity_L = compute_adaptive_intensity(n, intensity, bandn_second_derivative_L, true);
           intensity_R = compute_adaptive_intensity(n, intensity, bandn_second_derivative_R, false);
 
@@ -128,6 +128,10 @@ Manager::~Manager() {
 }
 
 void Manager::saveAll() const {
+  if (read_only) {
+    return;
+  }
+
   util::debug("Saving settings...");
 
   graph->save();
@@ -310,6 +314,14 @@ void Manager::create_plugin_db(const QString& parentGroup,
   }
 }
 
+void Manager::setReadOnly(const bool& state) {
+  read_only = state;
+
+  if (read_only) {
+    timer->stop();
+  }
+}
+
 void Manager::enableAutosave(const bool& state) {
   if (state) {
     timer->start();
@@ -89,6 +89,13 @@ class Manager : public QObject {
 
   Q_INVOKABLE void enableAutosave(const bool& state);
 
+  /**
+   * When enabled the settings changed in memory are never written to disk.
+   * Used by the offline renderer so that loading a preset does not change the
+   * user configuration.
+   */
+  void setReadOnly(const bool& state);
+
   DbGraph* graph;
   DbMain* main;
   DbSpectrum* spectrum;
@@ -118,6 +125,8 @@ class Manager : public QObject {
  private:
   QTimer* timer = nullptr;
 
+  bool read_only = false;
+
   void create_plugin_db(const QString& parentGroup, const auto& plugins_list, QMap<QString, QVariant>& plugins_map);
 };
 
@@ -21,9 +21,11 @@
 #include <qnamespace.h>
 #include <qobject.h>
 #include <algorithm>
+#include <atomic>
 #include <format>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include <vector>
@@ -55,6 +57,8 @@ DeepFilterNet::DeepFilterNet(const std::string& tag,
 
   packageInstalled = ladspa_wrapper->found_plugin();
 
+  native_rate = 48000U;
+
   if (!packageInstalled) {
     util::debug(std::format("{}libdeep_filter_ladspa is not installed", log_tag));
   }
@@ -103,7 +107,7 @@ void DeepFilterNet::clear_data() {
   //     return;
   //   }
 
-  //   std::scoped_lock<std::mutex> lock(data_mutex);
+  //   std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   //   if (ready && ladspa_wrapper->has_instance()) {
   //     ready = false;
@@ -121,7 +125,7 @@ void DeepFilterNet::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   ready = false;
 
@@ -132,6 +136,8 @@ void DeepFilterNet::setup() {
   resample = rate != 48000;
   resampler_ready = !resample;
 
+  resampler_latency.store(0.0F, std::memory_order_relaxed);
+
   // NOLINTBEGIN(clang-analyzer-cplusplus.NewDeleteLeaks)
 
   QMetaObject::invokeMethod(
@@ -141,33 +147,17 @@ void DeepFilterNet::setup() {
         ladspa_wrapper->create_instance(48000);
 
         if (resample && !resampler_ready) {
-          resampler_inL = std::make_unique<Resampler>(rate, 48000);
-          resampler_inR = std::make_unique<Resampler>(rate, 48000);
-          resampler_outL = std::make_unique<Resampler>(48000, rate);
-          resampler_outR = std::make_unique<Resampler>(48000, rate);
-
-          std::vector<float> dummy(n_samples);
-
-          const auto resampled_inL = resampler_inL->process(dummy);
-          const auto resampled_inR = resampler_inR->process(dummy);
+          resampler_in = std::make_unique<Resampler>(rate, 48000, 2U);
+          resampler_out = std::make_unique<Resampler>(48000, rate, 2U);
 
-          resampled_outL.resize(resampled_inL.size());
-          resampled_outR.resize(resampled_inR.size());
-
-          resampler_outL->process(resampled_inL);
-          resampler_outR->process(resampled_inR);
-
-          carryover_l.clear();
-          carryover_r.clear();
-          carryover_l.reserve(4);  // chosen by fair dice roll.
-          carryover_r.reserve(4);  // guaranteed to be random.
-          carryover_l.push_back(0.0F);
-          carryover_r.push_back(0.0F);
+          // process() resizes them to the resampler output size. This capacity avoids allocations there.
+          resampled_outL.reserve(resampler_in->get_max_output_frames());
+          resampled_outR.reserve(resampler_in->get_max_output_frames());
 
           resampler_ready = true;
         }
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         ready = true;
       },
@@ -180,9 +170,9 @@ void DeepFilterNet::process(std::span<float>& left_in,
                             std::span<float>& right_in,
                             std::span<float>& left_out,
                             std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (!ready || bypass) {
+  if (!ready || bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
@@ -194,8 +184,8 @@ void DeepFilterNet::process(std::span<float>& left_in,
   }
 
   if (resample) {
-    const auto& resampled_inL = resampler_inL->process(left_in);
-    const auto& resampled_inR = resampler_inR->process(right_in);
+    const auto resampled_inL = resampler_in->process(0U, left_in);
+    const auto resampled_inR = resampler_in->process(1U, right_in);
 
     resampled_outL.resize(resampled_inL.size());
     resampled_outR.resize(resampled_inR.size());
@@ -210,37 +200,14 @@ void DeepFilterNet::process(std::span<float>& left_in,
   ladspa_wrapper->run();
 
   if (resample) {
-    const auto& outL = resampler_outL->process(resampled_outL);
-    const auto& outR = resampler_outR->process(resampled_outR);
-
-    const auto carryover_end_l = std::min(carryover_l.size(), left_out.size());
-    const auto carryover_end_r = std::min(carryover_r.size(), right_out.size());
-
-    const auto left_offset =
-        carryover_end_l + outL.size() > left_out.size() ? carryover_end_l : left_out.size() - outL.size();
-    const auto right_offset =
-        carryover_end_r + outR.size() > right_out.size() ? carryover_end_r : right_out.size() - outR.size();
-
-    const auto left_count = std::min(outL.size(), left_out.size() - left_offset);
-    const auto right_count = std::min(outR.size(), right_out.size() - right_offset);
-
-    std::copy(carryover_l.begin(), carryover_l.begin() + carryover_end_l, left_out.begin());
-    std::copy(carryover_r.begin(), carryover_r.begin() + carryover_end_r, right_out.begin());
-
-    carryover_l.erase(carryover_l.begin(), carryover_l.begin() + carryover_end_l);
-    carryover_r.erase(carryover_r.begin(), carryover_r.begin() + carryover_end_r);
-
-    std::fill(left_out.begin() + carryover_end_l, left_out.begin() + left_offset, 0);
-    std::fill(right_out.begin() + carryover_end_r, right_out.begin() + right_offset, 0);
-
-    std::copy(outL.begin(), outL.begin() + left_count, left_out.begin() + left_offset);
-    std::copy(outR.begin(), outR.begin() + right_count, right_out.begin() + right_offset);
+    // The output resampler keeps the frames exceeding the quantum for the next cycle
 
-    carryover_l.insert(carryover_l.end(), outL.begin() + left_count, outL.end());
-    carryover_r.insert(carryover_r.end(), outR.begin() + right_count, outR.end());
+    resampler_out->process(0U, resampled_outL, left_out);
+    resampler_out->process(1U, resampled_outR, right_out);
 
-    std::fill(left_out.begin() + left_offset + left_count, left_out.end(), 0);
-    std::fill(right_out.begin() + right_offset + right_count, right_out.end(), 0);
+    resampler_latency.store((static_cast<float>(resampler_in->get_latency_frames()) / 48000.0F) +
+                                (static_cast<float>(resampler_out->get_latency_frames()) / static_cast<float>(rate)),
+                            std::memory_order_relaxed);
   }
 
   if (output_gain != 1.0F) {
@@ -260,7 +227,7 @@ void DeepFilterNet::process([[maybe_unused]] std::span<float>& left_in,
                             [[maybe_unused]] std::span<float>& probe_right) {}
 
 auto DeepFilterNet::get_latency_seconds() -> float {
-  return 0.02F + (1.0F / rate);
+  return 0.02F + (resample ? resampler_latency.load(std::memory_order_relaxed) : 0.0F);
 }
 
 void DeepFilterNet::resetHistory() {
@@ -271,7 +238,7 @@ void DeepFilterNet::resetHistory() {
       return;
     }
 
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
     if (ready && ladspa_wrapper->has_instance()) {
       ready = false;
@@ -22,6 +22,7 @@
 #include <qobject.h>
 #include <qqmlintegration.h>
 #include <qtmetamacros.h>
+#include <atomic>
 #include <memory>
 #include <span>
 #include <string>
@@ -77,9 +78,9 @@ class DeepFilterNet : public PluginBase {
   bool resample = false;
   bool resampler_ready = true;
 
-  std::unique_ptr<Resampler> resampler_inL, resampler_outL;
-  std::unique_ptr<Resampler> resampler_inR, resampler_outR;
+  std::unique_ptr<Resampler> resampler_in, resampler_out;
 
   std::vector<float> resampled_outL, resampled_outR;
-  std::vector<float> carryover_l, carryover_r;
+
+  std::atomic<float> resampler_latency = 0.0F;  // seconds
 };
@@ -23,9 +23,11 @@
 #include <sys/types.h>
 #include <QApplication>
 #include <algorithm>
+#include <cmath>
 #include <format>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include "db_manager.hpp"
@@ -87,6 +89,16 @@ Delay::Delay(const std::string& tag, pw::Manager* pipe_manager, PipelineType pip
 
   BIND_LV2_PORT_DB("wet_l", wetL, setWetL, DbDelay::wetLChanged, true);
   BIND_LV2_PORT_DB("wet_r", wetR, setWetR, DbDelay::wetRChanged, true);
+
+  update_tail_seconds();
+
+  for (const auto& signal : {&DbDelay::modeLChanged, &DbDelay::modeRChanged, &DbDelay::timeLChanged,
+                             &DbDelay::timeRChanged, &DbDelay::sampleLChanged, &DbDelay::sampleRChanged,
+                             &DbDelay::metersLChanged, &DbDelay::metersRChanged, &DbDelay::centimetersLChanged,
+                             &DbDelay::centimetersRChanged, &DbDelay::temperatureLChanged,
+                             &DbDelay::temperatureRChanged}) {
+    connect(settings, signal, [this]() { update_tail_seconds(); });
+  }
 }
 
 Delay::~Delay() {
@@ -111,7 +123,7 @@ void Delay::clear_data() {
   }
 
   {
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
     lv2_wrapper->destroy_instance_locked();
   }
@@ -125,7 +137,7 @@ void Delay::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   if (!lv2_wrapper->found_plugin) {
     return;
@@ -133,6 +145,9 @@ void Delay::setup() {
 
   lv2_wrapper->set_n_samples(n_samples);
 
+  // The delay given in samples depends on the rate
+  update_tail_seconds();
+
   if (lv2_wrapper->has_instance() && rate == lv2_wrapper->get_rate()) {
     return;
   }
@@ -145,7 +160,7 @@ void Delay::setup() {
       [this] {
         lv2_wrapper->create_instance(rate);
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         ready = true;
       },
@@ -157,9 +172,9 @@ void Delay::process(std::span<float>& left_in,
                     std::span<float>& right_in,
                     std::span<float>& left_out,
                     std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass) {
+  if (bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
@@ -217,3 +232,29 @@ void Delay::process([[maybe_unused]] std::span<float>& left_in,
 auto Delay::get_latency_seconds() -> float {
   return latency_value;
 }
+
+void Delay::update_tail_seconds() {
+  // Same modes as the plugin: samples, distance and time
+  auto channel_delay = [&](const int& mode, const double& time, const double& samples, const double& meters,
+                           const double& centimeters, const double& temperature) -> double {
+    switch (mode) {
+      case 0:
+        return rate != 0U ? samples / static_cast<double>(rate) : 0.0;
+      case 1: {
+        const auto sound_speed = 331.3 * std::sqrt(1.0 + (temperature / 273.15));
+
+        return (meters + (centimeters / 100.0)) / sound_speed;
+      }
+      default:
+        return time / 1000.0;
+    }
+  };
+
+  const auto left = channel_delay(settings->modeL(), settings->timeL(), settings->sampleL(), settings->metersL(),
+                                  settings->centimetersL(), settings->temperatureL());
+
+  const auto right = channel_delay(settings->modeR(), settings->timeR(), settings->sampleR(), settings->metersR(),
+                                   settings->centimetersR(), settings->temperatureR());
+
+  tail_seconds = static_cast<float>(std::max(left, right) + 0.1);
+}
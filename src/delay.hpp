@@ -69,4 +69,7 @@ class Delay : public PluginBase {
   bool ready = false;
 
   uint latency_n_frames = 0U;
+
+  // The longest of the two channel delays plus a small margin
+  void update_tail_seconds();
 };
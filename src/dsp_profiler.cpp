@@ -0,0 +1,148 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dsp_profiler.hpp"
+#include <sys/types.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+DspProfiler::Scope::Scope(DspProfiler& profiler, const uint& n_samples, const uint& rate)
+    : profiler(profiler),
+      budget_ns(rate > 0U ? static_cast<uint64_t>(n_samples) * 1000000000U / rate : 0U),
+      start(std::chrono::steady_clock::now()) {}
+
+DspProfiler::Scope::~Scope() {
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  profiler.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                  budget_ns);
+}
+
+auto DspProfiler::bucket_index(const uint64_t& ns) -> size_t {
+  if (ns < (1U << min_octave)) {
+    return 0U;
+  }
+
+  const auto msb = static_cast<uint>(std::bit_width(ns)) - 1U;
+
+  if (msb > max_octave) {
+    return n_buckets - 1U;
+  }
+
+  const auto sub = (ns >> (msb - sub_bucket_bits)) & ((1U << sub_bucket_bits) - 1U);
+
+  return 1U + ((msb - min_octave) << sub_bucket_bits) + sub;
+}
+
+auto DspProfiler::bucket_value(const size_t& index) -> uint64_t {
+  if (index == 0U) {
+    return (1U << min_octave) / 2U;
+  }
+
+  const auto octave = static_cast<uint>((index - 1U) >> sub_bucket_bits) + min_octave;
+  const auto sub = static_cast<uint64_t>((index - 1U) & ((1U << sub_bucket_bits) - 1U));
+
+  // middle of the bucket
+  const auto width = uint64_t{1U} << (octave - sub_bucket_bits);
+
+  return ((uint64_t{1U} << octave) + (sub * width)) + (width / 2U);
+}
+
+void DspProfiler::record(const uint64_t& elapsed_ns, const uint64_t& budget_ns) {
+  if (reset_requested.load(std::memory_order_acquire)) {
+    for (auto& b : buckets) {
+      b.store(0U, std::memory_order_relaxed);
+    }
+
+    max_ns.store(0U, std::memory_order_relaxed);
+
+    reset_requested.store(false, std::memory_order_release);
+  }
+
+  /**
+   * There is only one writer. A load followed by a store is enough and avoids
+   * the read-modify-write instructions.
+   */
+
+  auto& bucket = buckets[bucket_index(elapsed_ns)];
+
+  bucket.store(bucket.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+
+  if (elapsed_ns > max_ns.load(std::memory_order_relaxed)) {
+    max_ns.store(elapsed_ns, std::memory_order_relaxed);
+  }
+
+  last_budget_ns.store(budget_ns, std::memory_order_relaxed);
+}
+
+void DspProfiler::reset() {
+  reset_requested.store(true, std::memory_order_release);
+}
+
+auto DspProfiler::percentile(const uint64_t& count, const double& p) const -> uint64_t {
+  const auto target = static_cast<uint64_t>(p * static_cast<double>(count));
+
+  uint64_t sum = 0U;
+
+  for (size_t n = 0U; n < buckets.size(); n++) {
+    sum += buckets[n].load(std::memory_order_relaxed);
+
+    if (sum > target) {
+      return bucket_value(n);
+    }
+  }
+
+  return bucket_value(buckets.size() - 1U);
+}
+
+auto DspProfiler::get_stats() const -> Stats {
+  Stats stats;
+
+  for (const auto& b : buckets) {
+    stats.count += b.load(std::memory_order_relaxed);
+  }
+
+  if (stats.count == 0U) {
+    return stats;
+  }
+
+  const auto max = max_ns.load(std::memory_order_relaxed);
+  const auto budget = last_budget_ns.load(std::memory_order_relaxed);
+
+  // The bucket midpoints can be above the exact maximum
+  const auto p50 = std::min(percentile(stats.count, 0.5), max);
+  const auto p99 = std::min(percentile(stats.count, 0.99), max);
+
+  stats.p50_ms = static_cast<double>(p50) * 1.0e-6;
+  stats.p99_ms = static_cast<double>(p99) * 1.0e-6;
+  stats.max_ms = static_cast<double>(max) * 1.0e-6;
+  stats.budget_ms = static_cast<double>(budget) * 1.0e-6;
+
+  if (budget > 0U) {
+    stats.load_p50 = static_cast<double>(p50) / static_cast<double>(budget);
+    stats.load_p99 = static_cast<double>(p99) / static_cast<double>(budget);
+    stats.load_max = static_cast<double>(max) / static_cast<double>(budget);
+  }
+
+  return stats;
+}
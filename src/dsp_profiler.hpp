@@ -0,0 +1,104 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Measures how long a plugin spends in process() and keeps a histogram of the
+ * measurements. Only the realtime thread writes to it. Each record() is a
+ * fixed number of relaxed loads and stores, so the realtime side is wait-free.
+ * Other threads read approximate statistics with get_stats().
+ *
+ * The buckets are log-linear: every power of two between 1 µs and 1 s is
+ * split into 8 buckets. The resolution is about 12 % of the measured value.
+ */
+class DspProfiler {
+ public:
+  struct Stats {
+    uint64_t count = 0U;
+
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+    double budget_ms = 0.0;  // n_samples / rate
+
+    // Fraction of the quantum budget used
+    double load_p50 = 0.0;
+    double load_p99 = 0.0;
+    double load_max = 0.0;
+  };
+
+  /**
+   * Times the lifetime of the object and records it in the profiler. It is
+   * meant to wrap the call to process() in the realtime thread.
+   */
+  class Scope {
+   public:
+    Scope(DspProfiler& profiler, const uint& n_samples, const uint& rate);
+    Scope(const Scope&) = delete;
+    auto operator=(const Scope&) -> Scope& = delete;
+    Scope(const Scope&&) = delete;
+    auto operator=(const Scope&&) -> Scope& = delete;
+    ~Scope();
+
+   private:
+    DspProfiler& profiler;
+
+    uint64_t budget_ns = 0U;
+
+    std::chrono::steady_clock::time_point start;
+  };
+
+  void record(const uint64_t& elapsed_ns, const uint64_t& budget_ns);
+
+  /**
+   * Asks the realtime thread to clear the histogram before its next
+   * measurement. Statistics read before that still show the old values.
+   */
+  void reset();
+
+  [[nodiscard]] auto get_stats() const -> Stats;
+
+ private:
+  static constexpr uint sub_bucket_bits = 3U;
+  static constexpr uint min_octave = 10U;  // 1024 ns
+  static constexpr uint max_octave = 30U;  // ~1 s
+
+  static constexpr size_t n_buckets = 1U + ((max_octave - min_octave + 1U) << sub_bucket_bits);
+
+  std::array<std::atomic<uint32_t>, n_buckets> buckets{};
+
+  std::atomic<uint64_t> max_ns = {0U};
+  std::atomic<uint64_t> last_budget_ns = {0U};
+
+  std::atomic<bool> reset_requested = {false};
+
+  static auto bucket_index(const uint64_t& ns) -> size_t;
+
+  static auto bucket_value(const size_t& index) -> uint64_t;
+
+  [[nodiscard]] auto percentile(const uint64_t& count, const double& p) const -> uint64_t;
+};
@@ -24,6 +24,8 @@
 #include <algorithm>
 #include <format>
 #include <mutex>
+#include <numeric>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include <vector>
@@ -70,106 +72,90 @@ EchoCanceller::EchoCanceller(const std::string& tag,
   // Echo Canceller
 
   connect(settings, &DbEchoCanceller::enableEchoCancellerChanged, [&]() {
-    if (!ap_builder) {
-      return;
-    }
-
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<std::mutex> lock(config_mutex);
 
     ap_cfg.echo_canceller.enabled = settings->enableEchoCanceller();
 
-    ap_builder->ApplyConfig(ap_cfg);
+    if (ap_builder) {
+      ap_builder->ApplyConfig(ap_cfg);
+    }
   });
 
   connect(settings, &DbEchoCanceller::echoCancellerMobileModeChanged, [&]() {
-    if (!ap_builder) {
-      return;
-    }
-
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<std::mutex> lock(config_mutex);
 
     ap_cfg.echo_canceller.mobile_mode = settings->echoCancellerMobileMode();
 
-    ap_builder->ApplyConfig(ap_cfg);
+    if (ap_builder) {
+      ap_builder->ApplyConfig(ap_cfg);
+    }
   });
 
   connect(settings, &DbEchoCanceller::echoCancellerEnforceHighPassChanged, [&]() {
-    if (!ap_builder) {
-      return;
-    }
-
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<std::mutex> lock(config_mutex);
 
     ap_cfg.echo_canceller.enforce_high_pass_filtering = settings->echoCancellerEnforceHighPass();
 
-    ap_builder->ApplyConfig(ap_cfg);
+    if (ap_builder) {
+      ap_builder->ApplyConfig(ap_cfg);
+    }
   });
 
   // Noise Suppression
 
   connect(settings, &DbEchoCanceller::enableNoiseSuppressionChanged, [&]() {
-    if (!ap_builder) {
-      return;
-    }
-
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<std::mutex> lock(config_mutex);
 
     ap_cfg.noise_suppression.enabled = settings->enableNoiseSuppression();
 
-    ap_builder->ApplyConfig(ap_cfg);
+    if (ap_builder) {
+      ap_builder->ApplyConfig(ap_cfg);
+    }
   });
 
   connect(settings, &DbEchoCanceller::noiseSuppressionLevelChanged, [&]() {
-    if (!ap_builder) {
-      return;
-    }
-
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<std::mutex> lock(config_mutex);
 
     ap_cfg.noise_suppression.level =
         static_cast<webrtc::AudioProcessing::Config::NoiseSuppression::Level>(settings->noiseSuppressionLevel());
 
-    ap_builder->ApplyConfig(ap_cfg);
+    if (ap_builder) {
+      ap_builder->ApplyConfig(ap_cfg);
+    }
   });
 
   // High-pass Filter
 
   connect(settings, &DbEchoCanceller::enableHighPassFilterChanged, [&]() {
-    if (!ap_builder) {
-      return;
-    }
-
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<std::mutex> lock(config_mutex);
 
     ap_cfg.high_pass_filter.enabled = settings->enableHighPassFilter();
 
-    ap_builder->ApplyConfig(ap_cfg);
+    if (ap_builder) {
+      ap_builder->ApplyConfig(ap_cfg);
+    }
   });
 
   connect(settings, &DbEchoCanceller::highPassFilterFullBandChanged, [&]() {
-    if (!ap_builder) {
-      return;
-    }
-
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<std::mutex> lock(config_mutex);
 
     ap_cfg.high_pass_filter.apply_in_full_band = settings->highPassFilterFullBand();
 
-    ap_builder->ApplyConfig(ap_cfg);
+    if (ap_builder) {
+      ap_builder->ApplyConfig(ap_cfg);
+    }
   });
 
   // Automatic gain control
 
   connect(settings, &DbEchoCanceller::enableAGCChanged, [&]() {
-    if (!ap_builder) {
-      return;
-    }
-
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<std::mutex> lock(config_mutex);
 
     ap_cfg.gain_controller1.enabled = settings->enableAGC();
 
-    ap_builder->ApplyConfig(ap_cfg);
+    if (ap_builder) {
+      ap_builder->ApplyConfig(ap_cfg);
+    }
   });
 }
 
@@ -199,7 +185,7 @@ void EchoCanceller::clear_data() {
   }
 
   {
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
     lv2_wrapper->destroy_instance_locked();
   }
@@ -213,7 +199,7 @@ void EchoCanceller::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   ready = false;
 
@@ -235,9 +221,9 @@ void EchoCanceller::process(std::span<float>& left_in,
                             std::span<float>& right_out,
                             std::span<float>& probe_left,
                             std::span<float>& probe_right) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass || !ready) {
+  if (bypass || !ready || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
@@ -248,16 +234,16 @@ void EchoCanceller::process(std::span<float>& left_in,
     apply_gain(left_in, right_in, input_gain);
   }
 
-  buf_near_L.insert(buf_near_L.end(), left_in.begin(), left_in.end());
-  buf_near_R.insert(buf_near_R.end(), right_in.begin(), right_in.end());
-  buf_far_L.insert(buf_far_L.end(), probe_left.begin(), probe_left.end());
-  buf_far_R.insert(buf_far_R.end(), probe_right.begin(), probe_right.end());
+  buf_near_L.push(left_in);
+  buf_near_R.push(right_in);
+  buf_far_L.push(probe_left);
+  buf_far_R.push(probe_right);
 
   while (buf_near_L.size() >= near_L.size()) {
-    util::copy_bulk(buf_near_L, near_L);
-    util::copy_bulk(buf_near_R, near_R);
-    util::copy_bulk(buf_far_L, far_L);
-    util::copy_bulk(buf_far_R, far_R);
+    buf_near_L.pop(near_L);
+    buf_near_R.pop(near_R);
+    buf_far_L.pop(far_L);
+    buf_far_R.pop(far_R);
 
     float* near_ptrs[2] = {near_L.data(), near_R.data()};
     float* far_ptrs[2] = {far_L.data(), far_R.data()};
@@ -265,31 +251,15 @@ void EchoCanceller::process(std::span<float>& left_in,
     ap_builder->ProcessReverseStream(far_ptrs, stream_config, stream_config, far_ptrs);
     ap_builder->ProcessStream(near_ptrs, stream_config, stream_config, near_ptrs);
 
-    buf_out_L.insert(buf_out_L.end(), near_L.begin(), near_L.end());
-    buf_out_R.insert(buf_out_R.end(), near_R.begin(), near_R.end());
+    buf_out_L.push(near_L);
+    buf_out_R.push(near_R);
   }
 
-  if (buf_out_L.size() >= n_samples) {
-    util::copy_bulk(buf_out_L, left_out);
-    util::copy_bulk(buf_out_R, right_out);
-  } else {
-    const uint offset = n_samples - buf_out_L.size();
-
-    if (offset != latency_n_frames) {
-      latency_n_frames = offset;
+  // The zeros added in init_webrtc guarantee a full quantum here
 
-      notify_latency = true;
-    }
-
-    // Fill beginning with zeros
-    std::fill_n(left_out.begin(), offset, 0.0F);
-    std::fill_n(right_out.begin(), offset, 0.0F);
-
-    std::ranges::copy(buf_out_L, left_out.begin() + offset);
-    std::ranges::copy(buf_out_R, right_out.begin() + offset);
-
-    buf_out_L.clear();
-    buf_out_R.clear();
+  if (!buf_out_L.pop(left_out) || !buf_out_R.pop(right_out)) {
+    std::ranges::fill(left_out, 0.0F);
+    std::ranges::fill(right_out, 0.0F);
   }
 
   if (output_gain != 1.0F) {
@@ -297,7 +267,7 @@ void EchoCanceller::process(std::span<float>& left_in,
   }
 
   if (notify_latency) {
-    const float latency_value = static_cast<float>(latency_n_frames) / static_cast<float>(rate);
+    latency_value = static_cast<float>(latency_n_frames) / static_cast<float>(rate);
 
     util::debug(std::format("{}{} latency: {} s", log_tag, name.toStdString(), latency_value));
 
@@ -325,16 +295,26 @@ void EchoCanceller::init_webrtc() {
   far_L.resize(blocksize);
   far_R.resize(blocksize);
 
-  buf_near_L.clear();
-  buf_near_R.clear();
-  buf_far_L.clear();
-  buf_far_R.clear();
-  buf_out_L.clear();
-  buf_out_R.clear();
+  /**
+   * The output is primed with the smallest amount of zeros that keeps a full
+   * quantum always available. This makes the latency constant.
+   */
+  latency_n_frames = blocksize - std::gcd(n_samples, blocksize);
+
+  for (auto* buf : {&buf_near_L, &buf_near_R, &buf_far_L, &buf_far_R, &buf_out_L, &buf_out_R}) {
+    buf->set_capacity(2U * (static_cast<size_t>(n_samples) + blocksize));
+  }
 
-  ap_builder = webrtc::AudioProcessingBuilder().Create();
+  buf_out_L.push_zeros(latency_n_frames);
+  buf_out_R.push_zeros(latency_n_frames);
 
-  ap_builder->ApplyConfig(ap_cfg);
+  {
+    std::scoped_lock<std::mutex> lock(config_mutex);
+
+    ap_builder = webrtc::AudioProcessingBuilder().Create();
+
+    ap_builder->ApplyConfig(ap_cfg);
+  }
 
   stream_config = webrtc::StreamConfig(rate, 2);
 
@@ -25,6 +25,7 @@
 #include <qqmlintegration.h>
 #include <qtmetamacros.h>
 #include <qtypes.h>
+#include <mutex>
 #include <span>
 #include <string>
 #include <vector>
@@ -32,6 +33,7 @@
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
+#include "rt_ring_buffer.hpp"
 
 class EchoCanceller : public PluginBase {
   Q_OBJECT
@@ -78,9 +80,16 @@ class EchoCanceller : public PluginBase {
   std::vector<float> near_L, near_R;
   std::vector<float> far_L, far_R;
 
-  std::vector<float> buf_near_L, buf_near_R;
-  std::vector<float> buf_far_L, buf_far_R;
-  std::vector<float> buf_out_L, buf_out_R;
+  rt::RingBuffer<float> buf_near_L, buf_near_R;
+  rt::RingBuffer<float> buf_far_L, buf_far_R;
+  rt::RingBuffer<float> buf_out_L, buf_out_R;
+
+  /**
+   * ap_cfg and the ap_builder pointer are guarded by config_mutex, which
+   * process() does not take. AudioProcessing serializes ApplyConfig() with
+   * ProcessStream() internally.
+   */
+  std::mutex config_mutex;
 
   webrtc::AudioProcessing::Config ap_cfg;
 
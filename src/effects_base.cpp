@@ -20,11 +20,13 @@
 #include "effects_base.hpp"
 #include <gsl/gsl_interp.h>
 #include <gsl/gsl_spline.h>
+#include <pipewire/proxy.h>
 #include <qcontainerfwd.h>
 #include <qnamespace.h>
 #include <qobjectdefs.h>
 #include <qpoint.h>
 #include <qthread.h>
+#include <qtimer.h>
 #include <qtmetamacros.h>
 #include <qtypes.h>
 #include <spa/utils/defs.h>
@@ -32,9 +34,12 @@
 #include <QString>
 #include <algorithm>
 #include <cstddef>
+#include <format>
+#include <functional>
 #include <map>
 #include <memory>
 #include <ranges>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -53,6 +58,7 @@
 #include "deesser.hpp"
 #include "delay.hpp"
 #include "echo_canceller.hpp"
+#include "effects_chain.hpp"
 #include "equalizer.hpp"
 #include "exciter.hpp"
 #include "midside_equalizer.hpp"
@@ -70,6 +76,7 @@
 #include "pitch.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
+#include "pw_objects.hpp"
 #include "reverb.hpp"
 #include "rnnoise.hpp"
 #include "spectrum.hpp"
@@ -83,9 +90,13 @@ EffectsBase::EffectsBase(pw::Manager* pipe_manager, PipelineType pipe_type)
     : log_tag(pipe_type == PipelineType::output ? "soe: " : "sie: "),
       pm(pipe_manager),
       pipeline_type(pipe_type),
-      baseWorker(new EffectsBaseWorker) {
+      baseWorker(new EffectsBaseWorker),
+      hard_bypass_timer(new QTimer(this)) {
   using namespace std::string_literals;
 
+  hard_bypass_timer->setSingleShot(true);
+  hard_bypass_timer->setInterval(100);
+
   output_level = std::make_shared<OutputLevel>(log_tag, pm, pipeline_type, "0");
 
   spectrum = std::make_shared<Spectrum>(log_tag, pm, pipeline_type, "0");
@@ -141,119 +152,128 @@ EffectsBase::~EffectsBase() {
   util::debug("effects_base: destroyed");
 }
 
-void EffectsBase::create_filters_if_necessary() {
-  auto list = (pipeline_type == PipelineType::output ? DbStreamOutputs::plugins() : DbStreamInputs::plugins());
+auto EffectsBase::create_plugin(const QString& name,
+                                const std::string& tag,
+                                pw::Manager* pipe_manager,
+                                PipelineType pipe_type) -> std::unique_ptr<PluginBase> {
+  auto instance_id = tags::plugin_name::get_id(name);
 
-  if (list.empty()) {
-    return;
-  }
+  std::unique_ptr<PluginBase> filter = nullptr;
 
-  for (const auto& name : list) {
-    if (plugins.contains(name)) {
-      continue;
-    }
+  if (name.startsWith(tags::plugin_name::BaseName::autogain)) {
+    filter = std::make_unique<Autogain>(tag, pipe_manager, pipe_type, instance_id);
 
-    auto instance_id = tags::plugin_name::get_id(name);
+  } else if (name.startsWith(tags::plugin_name::BaseName::autotune)) {
+    filter = std::make_unique<Autotune>(tag, pipe_manager, pipe_type, instance_id);
 
-    std::unique_ptr<PluginBase> filter = nullptr;
+  } else if (name.startsWith(tags::plugin_name::BaseName::bassEnhancer)) {
+    filter = std::make_unique<BassEnhancer>(tag, pipe_manager, pipe_type, instance_id);
 
-    if (name.startsWith(tags::plugin_name::BaseName::autogain)) {
-      filter = std::make_unique<Autogain>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::bassLoudness)) {
+    filter = std::make_unique<BassLoudness>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::autotune)) {
-      filter = std::make_unique<Autotune>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::compressor)) {
+    filter = std::make_unique<Compressor>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::bassEnhancer)) {
-      filter = std::make_unique<BassEnhancer>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::convolver)) {
+    filter = std::make_unique<Convolver>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::bassLoudness)) {
-      filter = std::make_unique<BassLoudness>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::crossfeed)) {
+    filter = std::make_unique<Crossfeed>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::compressor)) {
-      filter = std::make_unique<Compressor>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::crusher)) {
+    filter = std::make_unique<Crusher>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::convolver)) {
-      filter = std::make_unique<Convolver>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::crystalizer)) {
+    filter = std::make_unique<Crystalizer>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::crossfeed)) {
-      filter = std::make_unique<Crossfeed>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::deepfilternet)) {
+    filter = std::make_unique<DeepFilterNet>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::crusher)) {
-      filter = std::make_unique<Crusher>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::deesser)) {
+    filter = std::make_unique<Deesser>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::crystalizer)) {
-      filter = std::make_unique<Crystalizer>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::delay)) {
+    filter = std::make_unique<Delay>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::deepfilternet)) {
-      filter = std::make_unique<DeepFilterNet>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::echoCanceller)) {
+    filter = std::make_unique<EchoCanceller>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::deesser)) {
-      filter = std::make_unique<Deesser>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::exciter)) {
+    filter = std::make_unique<Exciter>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::delay)) {
-      filter = std::make_unique<Delay>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::expander)) {
+    filter = std::make_unique<Expander>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::echoCanceller)) {
-      filter = std::make_unique<EchoCanceller>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::equalizer)) {
+    filter = std::make_unique<Equalizer>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::exciter)) {
-      filter = std::make_unique<Exciter>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::midsideEqualizer)) {
+    filter = std::make_unique<MidSideEqualizer>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::expander)) {
-      filter = std::make_unique<Expander>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::filter)) {
+    filter = std::make_unique<Filter>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::equalizer)) {
-      filter = std::make_unique<Equalizer>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::gate)) {
+    filter = std::make_unique<Gate>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::midsideEqualizer)) {
-      filter = std::make_unique<MidSideEqualizer>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::voiceSuppressor)) {
+    filter = std::make_unique<VoiceSuppressor>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::filter)) {
-      filter = std::make_unique<Filter>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::crosstalkCanceller)) {
+    filter = std::make_unique<CrosstalkCanceller>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::gate)) {
-      filter = std::make_unique<Gate>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::levelMeter)) {
+    filter = std::make_unique<LevelMeter>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::voiceSuppressor)) {
-      filter = std::make_unique<VoiceSuppressor>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::limiter)) {
+    filter = std::make_unique<Limiter>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::crosstalkCanceller)) {
-      filter = std::make_unique<CrosstalkCanceller>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::loudness)) {
+    filter = std::make_unique<Loudness>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::levelMeter)) {
-      filter = std::make_unique<LevelMeter>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::maximizer)) {
+    filter = std::make_unique<Maximizer>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::limiter)) {
-      filter = std::make_unique<Limiter>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::multibandCompressor)) {
+    filter = std::make_unique<MultibandCompressor>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::loudness)) {
-      filter = std::make_unique<Loudness>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::multibandGate)) {
+    filter = std::make_unique<MultibandGate>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::maximizer)) {
-      filter = std::make_unique<Maximizer>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::pitch)) {
+    filter = std::make_unique<Pitch>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::multibandCompressor)) {
-      filter = std::make_unique<MultibandCompressor>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::reverb)) {
+    filter = std::make_unique<Reverb>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::multibandGate)) {
-      filter = std::make_unique<MultibandGate>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::rnnoise)) {
+    filter = std::make_unique<RNNoise>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::pitch)) {
-      filter = std::make_unique<Pitch>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::speex)) {
+    filter = std::make_unique<Speex>(tag, pipe_manager, pipe_type, instance_id);
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::reverb)) {
-      filter = std::make_unique<Reverb>(log_tag, pm, pipeline_type, instance_id);
+  } else if (name.startsWith(tags::plugin_name::BaseName::stereoTools)) {
+    filter = std::make_unique<StereoTools>(tag, pipe_manager, pipe_type, instance_id);
+  }
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::rnnoise)) {
-      filter = std::make_unique<RNNoise>(log_tag, pm, pipeline_type, instance_id);
+  return filter;
+}
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::speex)) {
-      filter = std::make_unique<Speex>(log_tag, pm, pipeline_type, instance_id);
+void EffectsBase::create_filters_if_necessary() {
+  auto list = (pipeline_type == PipelineType::output ? DbStreamOutputs::plugins() : DbStreamInputs::plugins());
 
-    } else if (name.startsWith(tags::plugin_name::BaseName::stereoTools)) {
-      filter = std::make_unique<StereoTools>(log_tag, pm, pipeline_type, instance_id);
+  if (list.empty()) {
+    return;
+  }
+
+  for (const auto& name : list) {
+    if (plugins.contains(name)) {
+      continue;
     }
 
+    auto filter = create_plugin(name, log_tag, pm, pipeline_type);
+
     if (filter != nullptr) {
       /**
        * The filters inherit from QObject and we do not want QML to take
@@ -263,6 +283,12 @@ void EffectsBase::create_filters_if_necessary() {
        * backend already have a parent by the time they are used on QML.
        */
       filter->setParent(this);
+
+      connect(filter.get(), &PluginBase::bypassChanged, this, [this]() {
+        if (DbMain::hardBypass() && filtersLinked) {
+          hard_bypass_timer->start();
+        }
+      });
     }
 
     plugins.insert(std::make_pair(name, std::move(filter)));
@@ -303,16 +329,255 @@ void EffectsBase::remove_unused_filters() {
   }
 }
 
+auto EffectsBase::prepare_plugins_nodes(const QStringList& list) -> std::vector<uint> {
+  std::vector<uint> node_ids;
+
+  std::vector<PluginBase*> segment;
+
+  size_t n_chains = 0U;
+
+  const auto fused = DbMain::fusedEffectsChain();
+
+  auto add_chain = [&]() {
+    if (segment.empty()) {
+      return;
+    }
+
+    if (n_chains == effects_chains.size()) {
+      effects_chains.push_back(
+          std::make_unique<EffectsChain>(log_tag, pm, pipeline_type, QString::number(effects_chains.size())));
+    }
+
+    auto& chain = effects_chains[n_chains];
+
+    n_chains++;
+
+    chain->set_plugins(segment);
+
+    segment.clear();
+
+    if (!chain->connected_to_pw ? chain->connect_to_pw() : true) {
+      node_ids.push_back(chain->get_node_id());
+
+      pipeline_nodes.push_back({.plugin = nullptr, .node_id = chain->get_node_id(), .linked = true});
+    }
+  };
+
+  pipeline_nodes.clear();
+
+  for (const auto& name : list) {
+    if (!plugins.contains(name) || plugins[name] == nullptr) {
+      continue;
+    }
+
+    auto& plugin = plugins[name];
+
+    if (fused && !plugin->enable_probe) {
+      // The plugin may still have its own node from a previous non fused pipeline
+      if (plugin->connected_to_pw) {
+        plugin->disconnect_from_pw();
+      }
+
+      /**
+       * A bypassed plugin stays in the chain even when hard bypass is enabled.
+       * Its process() only copies the input, so toggling it never rebuilds the
+       * chain.
+       */
+      segment.push_back(plugin.get());
+
+      continue;
+    }
+
+    add_chain();
+
+    if (is_hard_bypassed(plugin.get())) {
+      // The node is kept in PipeWire. Enabling the plugin again only needs new links.
+      plugin->set_active(false);
+
+      pipeline_nodes.push_back({.plugin = plugin.get(), .node_id = plugin->get_node_id(), .linked = false});
+
+      continue;
+    }
+
+    if (!plugin->connected_to_pw ? plugin->connect_to_pw() : true) {
+      // It may have been deactivated while hard bypassed
+      plugin->set_active(true);
+
+      node_ids.push_back(plugin->get_node_id());
+
+      pipeline_nodes.push_back({.plugin = plugin.get(), .node_id = plugin->get_node_id(), .linked = true});
+    }
+  }
+
+  add_chain();
+
+  return node_ids;
+}
+
+void EffectsBase::release_effects_chains() {
+  /**
+   * The realtime thread reads the plugins list of the chain without locks. So
+   * it can only be changed after the chain node is disconnected from PipeWire.
+   */
+
+  for (auto& chain : effects_chains) {
+    if (chain->connected_to_pw) {
+      chain->disconnect_from_pw();
+    }
+
+    chain->set_plugins({});
+  }
+}
+
+auto EffectsBase::is_hard_bypassed(const PluginBase* plugin) -> bool {
+  return DbMain::hardBypass() && plugin->bypass_requested;
+}
+
+void EffectsBase::update_hard_bypass_links() {
+  auto changed = false;
+
+  for (size_t n = 0U; n < pipeline_nodes.size(); n++) {
+    auto& node = pipeline_nodes[n];
+
+    if (node.plugin == nullptr || node.linked != is_hard_bypassed(node.plugin)) {
+      continue;
+    }
+
+    uint prev_node_id = pipeline_head_id;
+    uint next_node_id = pipeline_tail_id;
+
+    for (size_t k = n; k > 0U; k--) {
+      if (pipeline_nodes[k - 1U].linked) {
+        prev_node_id = pipeline_nodes[k - 1U].node_id;
+
+        break;
+      }
+    }
+
+    for (size_t k = n + 1U; k < pipeline_nodes.size(); k++) {
+      if (pipeline_nodes[k].linked) {
+        next_node_id = pipeline_nodes[k].node_id;
+
+        break;
+      }
+    }
+
+    if (node.linked) {
+      // The plugin has already faded to its dry signal. Its neighbours are linked directly.
+
+      const auto id = node.node_id;
+
+      destroy_links_if([&](const pw::LinkInfo& link) { return link.input_node_id == id || link.output_node_id == id; });
+
+      link_and_store(prev_node_id, next_node_id);
+
+      node.plugin->set_active(false);
+
+      node.linked = false;
+    } else {
+      if (!node.plugin->connected_to_pw && !node.plugin->connect_to_pw()) {
+        continue;
+      }
+
+      node.node_id = node.plugin->get_node_id();
+
+      node.plugin->set_active(true);
+
+      destroy_links_if([&](const pw::LinkInfo& link) {
+        return link.output_node_id == prev_node_id && link.input_node_id == next_node_id;
+      });
+
+      link_and_store(prev_node_id, node.node_id);
+      link_and_store(node.node_id, next_node_id);
+
+      if (node.plugin->name.startsWith(tags::plugin_name::BaseName::echoCanceller)) {
+        const auto output_device = pm->model_nodes.get_node_by_name(DbStreamOutputs::outputDevice());
+
+        for (auto* link : pm->link_nodes(output_device.id, node.node_id, true)) {
+          list_proxies.push_back(link);
+        }
+      }
+
+      node.plugin->update_probe_links();
+
+      node.linked = true;
+    }
+
+    util::debug(std::format("{}{} {} the pipeline", log_tag, node.plugin->name.toStdString(),
+                            node.linked ? "added back to" : "removed from"));
+
+    changed = true;
+  }
+
+  if (changed) {
+    Q_EMIT pipelineChanged();
+  }
+}
+
+void EffectsBase::link_and_store(const uint& output_node_id, const uint& input_node_id) {
+  const auto links = pm->link_nodes(output_node_id, input_node_id);
+
+  for (auto* link : links) {
+    list_proxies.push_back(link);
+  }
+
+  if (links.empty()) {
+    util::warning(std::format("{}Link from node {} to node {} failed", log_tag, output_node_id, input_node_id));
+  }
+}
+
+void EffectsBase::destroy_links_if(const std::function<bool(const pw::LinkInfo&)>& predicate) {
+  std::set<uint> link_id_list;
+
+  for (const auto& link : pm->get_links()) {
+    if (predicate(link)) {
+      link_id_list.insert(link.id);
+    }
+  }
+
+  // Our own proxies are destroyed and dropped so the links are not destroyed twice later
+
+  std::vector<pw_proxy*> own_links;
+
+  std::erase_if(list_proxies, [&](pw_proxy* proxy) {
+    const auto id = pw_proxy_get_bound_id(proxy);
+
+    if (!link_id_list.contains(id)) {
+      return false;
+    }
+
+    link_id_list.erase(id);
+
+    own_links.push_back(proxy);
+
+    return true;
+  });
+
+  pm->destroy_links(own_links);
+
+  for (const auto& id : link_id_list) {
+    pm->destroy_object(static_cast<int>(id));
+  }
+}
+
 void EffectsBase::activate_filters() {
   for (auto& plugin : plugins | std::views::values) {
     plugin->set_active(true);
   }
+
+  for (auto& chain : effects_chains) {
+    chain->set_active(true);
+  }
 }
 
 void EffectsBase::deactivate_filters() {
   for (auto& plugin : plugins | std::views::values) {
     plugin->set_active(false);
   }
+
+  for (auto& chain : effects_chains) {
+    chain->set_active(false);
+  }
 }
 
 auto EffectsBase::get_plugins_map() -> std::map<QString, std::unique_ptr<PluginBase>>& {
@@ -488,10 +753,12 @@ void EffectsBase::requestSpectrumData() {
 
         const qsizetype n_bands = list.size();
 
-        // Reuse or resize frequency cache based on band count
-        if (cached_spectrum_frequencies.size() != n_bands) {
+        // The fft size sets the band count and together with the sampling rate the band spacing
+        if (cached_spectrum_frequencies.size() != n_bands || cached_spectrum_bin_hz != bin_hz) {
           cached_spectrum_frequencies.resize(n_bands);
 
+          cached_spectrum_bin_hz = bin_hz;
+
           for (qsizetype n = 0; n < n_bands; n++) {
             cached_spectrum_frequencies[n] = static_cast<double>(n) * static_cast<double>(bin_hz);
           }
@@ -528,9 +795,16 @@ void EffectsBase::requestSpectrumData() {
           cached_spectrum_log_axis = log_axis;
         }
 
-        if (spline == nullptr) {
-          // The spectrum plugin sends arrays that always have the same size. So we can do this only once.
+        if (spline == nullptr || spline->size != static_cast<size_t>(n_bands)) {
+          // The array size only changes with the fft size
+
+          if (spline != nullptr) {
+            gsl_spline_free(spline);
+          }
+
           spline = gsl_spline_alloc(gsl_interp_steffen, n_bands);
+
+          gsl_interp_accel_reset(gsl_acc);
         }
 
         gsl_spline_init(spline, cached_spectrum_frequencies.data(), list.data(), n_bands);
@@ -23,20 +23,26 @@
 #include <gsl/gsl_spline.h>
 #include <kconfigskeleton.h>
 #include <pipewire/proxy.h>
+#include <qcontainerfwd.h>
 #include <qlist.h>
 #include <qobject.h>
 #include <qpoint.h>
 #include <qtmetamacros.h>
+#include <qtimer.h>
 #include <qtypes.h>
+#include <spa/utils/defs.h>
 #include <QString>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
+#include "effects_chain.hpp"
 #include "output_level.hpp"
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
+#include "pw_objects.hpp"
 #include "spectrum.hpp"
 
 class EffectsBaseWorker : public QObject {
@@ -69,6 +75,15 @@ class EffectsBase : public QObject {
 
   auto get_plugins_map() -> std::map<QString, std::unique_ptr<PluginBase>>&;
 
+  /**
+   * Instantiates the plugin matching the name in the pipeline list. Passing a
+   * nullptr pipe_manager creates a plugin without a PipeWire filter.
+   */
+  static auto create_plugin(const QString& name,
+                            const std::string& tag,
+                            pw::Manager* pipe_manager,
+                            PipelineType pipe_type) -> std::unique_ptr<PluginBase>;
+
   Q_INVOKABLE QVariant getPluginInstance(const QString& pluginName);
 
   Q_INVOKABLE [[nodiscard]] uint getPipeLineRate() const;
@@ -97,23 +112,74 @@ class EffectsBase : public QObject {
 
   std::vector<pw_proxy*> list_proxies, list_proxies_listen_mic;
 
+  std::vector<std::unique_ptr<EffectsChain>> effects_chains;
+
   EffectsBaseWorker* baseWorker;
 
+  /**
+   * Started when a plugin is bypassed or enabled while DbMain::hardBypass is
+   * set. update_hard_bypass_links runs on timeout. The delay lets the plugin
+   * fade its output before its node leaves the graph and merges quick toggles.
+   */
+  QTimer* hard_bypass_timer;
+
   QThread workerThread;
 
+  struct PipelineNode {
+    PluginBase* plugin = nullptr;  // nullptr for an effects chain
+
+    uint node_id = SPA_ID_INVALID;
+
+    bool linked = false;
+  };
+
+  /**
+   * Plugin nodes in the order the audio goes through them, hard bypassed ones
+   * included. Filled by prepare_plugins_nodes.
+   */
+  std::vector<PipelineNode> pipeline_nodes;
+
+  // Nodes linked before the first and after the last plugin node
+  uint pipeline_head_id = SPA_ID_INVALID, pipeline_tail_id = SPA_ID_INVALID;
+
   void create_filters_if_necessary();
 
   void remove_unused_filters();
 
+  /**
+   * Connects to PipeWire the nodes needed by the plugins in the list and
+   * returns their ids in the same order. In fused mode consecutive plugins
+   * share a single effects chain node. Plugins with probe ports always use
+   * their own node.
+   */
+  auto prepare_plugins_nodes(const QStringList& list) -> std::vector<uint>;
+
+  void release_effects_chains();
+
+  // True when the plugin is bypassed and has to be left out of the links
+  [[nodiscard]] static auto is_hard_bypassed(const PluginBase* plugin) -> bool;
+
+  /**
+   * Called when hard_bypass_timer fires. Only the links around the nodes whose
+   * bypass state changed are updated. The other plugins keep running.
+   */
+  void update_hard_bypass_links();
+
   void activate_filters();
 
   void deactivate_filters();
 
  private:
+  void link_and_store(const uint& output_node_id, const uint& input_node_id);
+
+  // Destroys the links selected by the predicate, including the ones created by us
+  void destroy_links_if(const std::function<bool(const pw::LinkInfo&)>& predicate);
+
   int cached_spectrum_npoints = -1;
   float cached_spectrum_min_freq = -1.0F;
   float cached_spectrum_max_freq = -1.0F;
   bool cached_spectrum_log_axis = false;
+  float cached_spectrum_bin_hz = 0.0F;
 
   gsl_interp_accel* gsl_acc = gsl_interp_accel_alloc();
   gsl_spline* spline = nullptr;
@@ -0,0 +1,320 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "effects_chain.hpp"
+#include <sys/types.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <vector>
+#include "dsp_profiler.hpp"
+#include "lv2_wrapper.hpp"
+#include "pipeline_type.hpp"
+#include "plugin_base.hpp"
+#include "pw_manager.hpp"
+#include "resampler.hpp"
+#include "rt_checks.hpp"
+#include "rt_sync.hpp"
+#include "tags_plugin_name.hpp"
+#include "util.hpp"
+
+EffectsChain::EffectsChain(const std::string& tag,
+                           pw::Manager* pipe_manager,
+                           PipelineType pipe_type,
+                           QString instance_id)
+    : PluginBase(tag, "effects_chain", tags::plugin_package::Package::ee, instance_id, pipe_manager, pipe_type) {
+  for (size_t n = 0U; n < scratch_left.size(); n++) {
+    scratch_left[n].reserve(lv2::Lv2Wrapper::max_quantum);
+    scratch_right[n].reserve(lv2::Lv2Wrapper::max_quantum);
+  }
+}
+
+EffectsChain::~EffectsChain() {
+  if (connected_to_pw) {
+    disconnect_from_pw();
+  }
+
+  util::debug(std::format("{}{} destroyed", log_tag, name.toStdString()));
+}
+
+void EffectsChain::reset() {}
+
+void EffectsChain::clear_data() {}
+
+void EffectsChain::setup() {
+  if (rate == 0 || n_samples == 0) {
+    // Some signals may be emitted before PipeWire calls our setup function
+    return;
+  }
+
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
+
+  for (size_t n = 0U; n < scratch_left.size(); n++) {
+    scratch_left[n].resize(n_samples);
+    scratch_right[n].resize(n_samples);
+
+    std::ranges::fill(scratch_left[n], 0.0F);
+    std::ranges::fill(scratch_right[n], 0.0F);
+  }
+
+  prepare_islands();
+
+  // The plugins do not get a quantum change request of their own in this mode
+  forward_quantum(false);
+
+  util::debug(std::format("{}{}: PipeWire blocksize: {}", log_tag, name.toStdString(), n_samples));
+  util::debug(std::format("{}{}: PipeWire sampling rate: {}", log_tag, name.toStdString(), rate));
+}
+
+void EffectsChain::set_plugins(const std::vector<PluginBase*>& list) {
+  chain = list;
+
+  prepare_islands();
+
+  forward_quantum(true);
+}
+
+void EffectsChain::prepare_islands() {
+  islands.clear();
+
+  if (rate == 0U || n_samples == 0U) {
+    return;
+  }
+
+  for (size_t n = 0U; n < chain.size(); n++) {
+    const auto native = chain[n]->native_rate;
+
+    if (native == 0U || native == rate) {
+      continue;
+    }
+
+    auto island = std::make_unique<Island>();
+
+    island->first = n;
+
+    while (n + 1U < chain.size() && chain[n + 1U]->native_rate == native) {
+      n++;
+    }
+
+    island->last = n;
+    island->rate = native;
+    island->block = static_cast<uint>(
+        (static_cast<uint64_t>(n_samples) * static_cast<uint64_t>(native) + static_cast<uint64_t>(rate) - 1U) / rate);
+
+    island->to_native = std::make_unique<Resampler>(rate, native, 2U);
+    island->from_native = std::make_unique<Resampler>(native, rate, 2U);
+
+    // One block waiting to be processed plus the frames resampled in the next cycle
+
+    const auto capacity = static_cast<size_t>(island->block) + island->to_native->get_max_output_frames();
+
+    island->input_left.set_capacity(capacity);
+    island->input_right.set_capacity(capacity);
+
+    for (size_t k = 0U; k < island->scratch_left.size(); k++) {
+      island->scratch_left[k].assign(island->block, 0.0F);
+      island->scratch_right[k].assign(island->block, 0.0F);
+    }
+
+    util::debug(std::format("{}{}: plugins {} to {} run at {} Hz in blocks of {} frames", log_tag,
+                            name.toStdString(), island->first, island->last, island->rate, island->block));
+
+    islands.push_back(std::move(island));
+  }
+}
+
+void EffectsChain::forward_quantum(const bool& only_if_changed) {
+  if (rate == 0U || n_samples == 0U) {
+    return;
+  }
+
+  for (size_t n = 0U; n < chain.size(); n++) {
+    auto* plugin = chain[n];
+
+    const auto* island = find_island(n);
+
+    const auto plugin_rate = island != nullptr ? island->rate : rate;
+    const auto frames = island != nullptr ? island->block : n_samples;
+
+    if (!only_if_changed || plugin->rate != plugin_rate || plugin->n_samples != frames) {
+      plugin->set_quantum(plugin_rate, frames);
+    }
+  }
+}
+
+auto EffectsChain::find_island(const size_t& index) const -> const Island* {
+  for (const auto& island : islands) {
+    if (index >= island->first && index <= island->last) {
+      return island.get();
+    }
+  }
+
+  return nullptr;
+}
+
+auto EffectsChain::get_plugins() const -> const std::vector<PluginBase*>& {
+  return chain;
+}
+
+void EffectsChain::process(std::span<float>& left_in,
+                           std::span<float>& right_in,
+                           std::span<float>& left_out,
+                           std::span<float>& right_out) {
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
+
+  if (chain.empty() || !lock.owns_lock()) {
+    std::ranges::copy(left_in, left_out.begin());
+    std::ranges::copy(right_in, right_out.begin());
+
+    return;
+  }
+
+  /**
+   * The plugins alternate between the two scratch buffers. The output of one
+   * plugin is the input of the next and the last one writes directly to the
+   * buffers given by PipeWire.
+   */
+
+  std::span<float> l_in = left_in;
+  std::span<float> r_in = right_in;
+
+  size_t next_island = 0U;
+
+  // An island counts as a single step
+  for (size_t n = 0U, step = 0U; n < chain.size(); n++, step++) {
+    auto* island = next_island < islands.size() && islands[next_island]->first == n ? islands[next_island].get()
+                                                                                     : nullptr;
+
+    const auto last = (island != nullptr ? island->last : n) == chain.size() - 1U;
+
+    std::span<float> l_out = last ? left_out : std::span<float>(scratch_left[step % 2U].data(), n_samples);
+    std::span<float> r_out = last ? right_out : std::span<float>(scratch_right[step % 2U].data(), n_samples);
+
+    if (island != nullptr) {
+      process_island(*island, l_in, r_in, l_out, r_out);
+
+      n = island->last;
+
+      next_island++;
+    } else {
+      run_plugin(chain[n], l_in, r_in, l_out, r_out, rate, n_samples);
+    }
+
+    l_in = l_out;
+    r_in = r_out;
+  }
+
+  if (const auto v = get_latency_seconds(); v != latency_value) {
+    latency_value = v;
+
+    update_filter_params();
+  }
+
+  if (updateLevelMeters) {
+    get_peaks(left_in, right_in, left_out, right_out);
+  }
+}
+
+void EffectsChain::run_plugin(PluginBase* plugin,
+                              std::span<float>& left_in,
+                              std::span<float>& right_in,
+                              std::span<float>& left_out,
+                              std::span<float>& right_out,
+                              const uint& plugin_rate,
+                              const uint& frames) {
+  if (plugin->rate != plugin_rate || plugin->n_samples != frames) {
+    // Not set up for this quantum yet. setup() takes care of it outside of the realtime thread.
+    std::ranges::copy(left_in, left_out.begin());
+    std::ranges::copy(right_in, right_out.begin());
+
+    return;
+  }
+
+  // The plugins do not get a process callback of their own in this mode
+  DspProfiler::Scope profiler_scope(plugin->dsp_profiler, frames, plugin_rate);
+
+  rt::checks::Scope rt_checks_scope(plugin->name);
+
+  plugin->run(left_in, right_in, left_out, right_out);
+}
+
+void EffectsChain::process_island(Island& island,
+                                  std::span<float>& left_in,
+                                  std::span<float>& right_in,
+                                  std::span<float>& left_out,
+                                  std::span<float>& right_out) {
+  island.input_left.push(island.to_native->process(0U, left_in));
+  island.input_right.push(island.to_native->process(1U, right_in));
+
+  while (island.input_left.size() >= island.block && island.input_right.size() >= island.block) {
+    std::span<float> l_in(island.scratch_left[0].data(), island.block);
+    std::span<float> r_in(island.scratch_right[0].data(), island.block);
+
+    island.input_left.pop(l_in);
+    island.input_right.pop(r_in);
+
+    for (size_t n = island.first; n <= island.last; n++) {
+      const auto step = n - island.first + 1U;
+
+      std::span<float> l_out(island.scratch_left[step % 2U].data(), island.block);
+      std::span<float> r_out(island.scratch_right[step % 2U].data(), island.block);
+
+      run_plugin(chain[n], l_in, r_in, l_out, r_out, island.rate, island.block);
+
+      l_in = l_out;
+      r_in = r_out;
+    }
+
+    // Only queued here. The frames for PipeWire are taken below.
+    island.from_native->process(0U, l_in, {});
+    island.from_native->process(1U, r_in, {});
+  }
+
+  // Exactly one quantum. Zeros are added at the start while the first block is not complete.
+  island.from_native->process(0U, {}, left_out);
+  island.from_native->process(1U, {}, right_out);
+}
+
+void EffectsChain::process([[maybe_unused]] std::span<float>& left_in,
+                           [[maybe_unused]] std::span<float>& right_in,
+                           [[maybe_unused]] std::span<float>& left_out,
+                           [[maybe_unused]] std::span<float>& right_out,
+                           [[maybe_unused]] std::span<float>& probe_left,
+                           [[maybe_unused]] std::span<float>& probe_right) {}
+
+auto EffectsChain::get_latency_seconds() -> float {
+  float v = 0.0F;
+
+  for (auto* plugin : chain) {
+    v += plugin->get_latency_seconds();
+  }
+
+  for (const auto& island : islands) {
+    v += (static_cast<float>(island->to_native->get_latency_frames()) / static_cast<float>(island->rate)) +
+         (static_cast<float>(island->from_native->get_latency_frames()) / static_cast<float>(rate));
+  }
+
+  return v;
+}
@@ -0,0 +1,128 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <QString>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "pipeline_type.hpp"
+#include "plugin_base.hpp"
+#include "pw_manager.hpp"
+#include "resampler.hpp"
+#include "rt_ring_buffer.hpp"
+
+/**
+ * Single PipeWire node that runs a sequence of plugins inside its own process
+ * callback. The plugins in the sequence do not connect their own filters to the
+ * graph. Their process() is called in order on scratch buffers shared by the
+ * whole chain. This removes one graph node, one wakeup and one set of port
+ * buffers per effect.
+ *
+ * Adjacent plugins working at a fixed native rate, like the noise reduction
+ * models, form an island. The chain resamples into the island once, runs its
+ * plugins at their native rate in blocks of constant size and resamples the
+ * result back once.
+ */
+class EffectsChain : public PluginBase {
+ public:
+  EffectsChain(const std::string& tag, pw::Manager* pipe_manager, PipelineType pipe_type, QString instance_id);
+  EffectsChain(const EffectsChain&) = delete;
+  auto operator=(const EffectsChain&) -> EffectsChain& = delete;
+  EffectsChain(const EffectsChain&&) = delete;
+  auto operator=(const EffectsChain&&) -> EffectsChain& = delete;
+  ~EffectsChain() override;
+
+  void reset() override;
+
+  void clear_data() override;
+
+  void setup() override;
+
+  void process(std::span<float>& left_in,
+               std::span<float>& right_in,
+               std::span<float>& left_out,
+               std::span<float>& right_out) override;
+
+  void process(std::span<float>& left_in,
+               std::span<float>& right_in,
+               std::span<float>& left_out,
+               std::span<float>& right_out,
+               std::span<float>& probe_left,
+               std::span<float>& probe_right) override;
+
+  auto get_latency_seconds() -> float override;
+
+  /**
+   * The list must only be changed while this node is disconnected from
+   * PipeWire. The realtime thread reads it without synchronization.
+   */
+  void set_plugins(const std::vector<PluginBase*>& list);
+
+  [[nodiscard]] auto get_plugins() const -> const std::vector<PluginBase*>&;
+
+ private:
+  // Plugins first to last of the chain running at the native rate they share
+  struct Island {
+    size_t first = 0U;
+    size_t last = 0U;
+
+    uint rate = 0U;
+    uint block = 0U;
+
+    std::unique_ptr<Resampler> to_native, from_native;
+
+    rt::RingBuffer<float> input_left, input_right;
+
+    std::array<std::vector<float>, 2U> scratch_left, scratch_right;
+  };
+
+  std::vector<PluginBase*> chain;
+
+  std::vector<std::unique_ptr<Island>> islands;  // sorted by their first plugin
+
+  std::array<std::vector<float>, 2U> scratch_left, scratch_right;
+
+  // Finds the islands for the current chain and graph rate. Not realtime safe.
+  void prepare_islands();
+
+  // Gives every plugin the quantum it runs at: the graph one or the one of its island
+  void forward_quantum(const bool& only_if_changed);
+
+  [[nodiscard]] auto find_island(const size_t& index) const -> const Island*;
+
+  void run_plugin(PluginBase* plugin,
+                  std::span<float>& left_in,
+                  std::span<float>& right_in,
+                  std::span<float>& left_out,
+                  std::span<float>& right_out,
+                  const uint& plugin_rate,
+                  const uint& frames);
+
+  void process_island(Island& island,
+                      std::span<float>& left_in,
+                      std::span<float>& right_in,
+                      std::span<float>& left_out,
+                      std::span<float>& right_out);
+};
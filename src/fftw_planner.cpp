@@ -0,0 +1,92 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fftw_planner.hpp"
+#include <fftw3.h>
+#include <QStandardPaths>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include "util.hpp"
+
+FftwPlanner::FftwPlanner()
+    : wisdom_file(QStandardPaths::writableLocation(QStandardPaths::CacheLocation).toStdString() + "/fftwf_wisdom"),
+      thread([this] { work(); }) {}
+
+FftwPlanner::~FftwPlanner() {
+  {
+    std::scoped_lock<std::mutex> lock(mutex);
+
+    quit = true;
+  }
+
+  requested.notify_one();
+
+  thread.join();
+}
+
+void FftwPlanner::work() {
+  while (true) {
+    std::function<void()> request;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+
+      requested.wait(lock, [this] { return quit || !requests.empty() || !idle_requests.empty(); });
+
+      if (requests.empty() && idle_requests.empty()) {
+        return;
+      }
+
+      auto& queue = requests.empty() ? idle_requests : requests;
+
+      request = std::move(queue.front());
+
+      queue.pop_front();
+    }
+
+    request();
+  }
+}
+
+void FftwPlanner::load_wisdom() {
+  if (wisdom_loaded) {
+    return;
+  }
+
+  wisdom_loaded = true;
+
+  if (std::filesystem::is_regular_file(wisdom_file) && fftwf_import_wisdom_from_filename(wisdom_file.c_str()) == 0) {
+    util::warning(std::format("could not import the fftw wisdom from {}", wisdom_file));
+  }
+}
+
+void FftwPlanner::save_wisdom() {
+  std::error_code error;
+
+  std::filesystem::create_directories(std::filesystem::path(wisdom_file).parent_path(), error);
+
+  if (error || fftwf_export_wisdom_to_filename(wisdom_file.c_str()) == 0) {
+    util::warning(std::format("could not save the fftw wisdom to {}", wisdom_file));
+  }
+}
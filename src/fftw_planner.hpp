@@ -0,0 +1,115 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+/**
+ * The fftw planner can only be used by one thread at a time while executing
+ * plans is thread safe. Plans are created and destroyed by this service, one
+ * request after the other, in its own thread. This way the realtime threads
+ * execute their plans without waiting for a lock held by a slow plan build.
+ */
+class FftwPlanner {
+ public:
+  FftwPlanner(const FftwPlanner&) = delete;
+  auto operator=(const FftwPlanner&) -> FftwPlanner& = delete;
+  FftwPlanner(const FftwPlanner&&) = delete;
+  auto operator=(const FftwPlanner&&) -> FftwPlanner& = delete;
+  ~FftwPlanner();
+
+  static auto self() -> FftwPlanner& {
+    static FftwPlanner planner;
+    return planner;
+  }
+
+  // Runs f in the planner thread and waits for its result. It must not be called from a realtime thread.
+  template <typename F>
+  auto run(F&& f) -> std::invoke_result_t<F> {
+    return submit(std::forward<F>(f), requests);
+  }
+
+  /**
+   * Like run() but f only starts when no request of run() is waiting. Slow
+   * requests like measuring a plan use it, so the plugins that are waiting for
+   * their plans are not queued behind them.
+   */
+  template <typename F>
+  auto run_when_idle(F&& f) -> std::invoke_result_t<F> {
+    return submit(std::forward<F>(f), idle_requests);
+  }
+
+  /**
+   * Measured plans are slow to create. The single precision wisdom is kept in
+   * the cache directory so each size is only measured once. They must be
+   * called from a function given to run().
+   */
+  void load_wisdom();
+
+  void save_wisdom();
+
+ private:
+  FftwPlanner();
+
+  bool quit = false;
+
+  bool wisdom_loaded = false;
+
+  std::string wisdom_file;
+
+  std::mutex mutex;
+
+  std::condition_variable requested;
+
+  std::deque<std::function<void()>> requests, idle_requests;
+
+  std::thread thread;
+
+  template <typename F>
+  auto submit(F&& f, std::deque<std::function<void()>>& queue) -> std::invoke_result_t<F> {
+    if (std::this_thread::get_id() == thread.get_id()) {
+      return f();
+    }
+
+    std::packaged_task<std::invoke_result_t<F>()> task(std::forward<F>(f));
+
+    auto result = task.get_future();
+
+    {
+      std::scoped_lock<std::mutex> lock(mutex);
+
+      queue.emplace_back([&task] { task(); });
+    }
+
+    requested.notify_one();
+
+    return result.get();
+  }
+
+  void work();
+};
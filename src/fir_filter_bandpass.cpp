@@ -22,37 +22,53 @@
 #include <cstddef>
 #include <string>
 #include <utility>
+#include <vector>
 #include "fir_filter_base.hpp"
+#include "fir_kernel_cache.hpp"
 
 FirFilterBandpass::FirFilterBandpass(std::string tag) : FirFilterBase(std::move(tag)) {}
 
 FirFilterBandpass::~FirFilterBandpass() = default;
 
-void FirFilterBandpass::setup() {
-  const auto lowpass_kernel = create_lowpass_kernel(max_frequency, transition_band);
+void FirFilterBandpass::create_kernel() {
+  const FirKernelCache::Key key{.type = FirKernelCache::Type::bandpass,
+                                .rate = rate,
+                                .min_frequency = min_frequency,
+                                .max_frequency = max_frequency,
+                                .transition_band = transition_band};
 
-  // high-pass kernel
+  kernel = FirKernelCache::self().get(key, [&] {
+    const auto lowpass_kernel = create_lowpass_kernel(max_frequency, transition_band);
 
-  auto highpass_kernel = create_lowpass_kernel(min_frequency, transition_band);
+    // high-pass kernel
 
-  std::ranges::for_each(highpass_kernel, [](auto& v) { v *= -1.0F; });
+    auto highpass_kernel = create_lowpass_kernel(min_frequency, transition_band);
 
-  highpass_kernel[(highpass_kernel.size() - 1U) / 2U] += 1.0F;
+    std::vector<float> output;
 
-  kernel.resize(highpass_kernel.size());
+    if (lowpass_kernel.empty() || highpass_kernel.empty()) {
+      return output;
+    }
 
-  // Creating a bandpass from a band reject through spectral inversion
-  // https://www.dspguide.com/ch16/4.htm
+    std::ranges::for_each(highpass_kernel, [](auto& v) { v *= -1.0F; });
 
-  for (size_t n = 0U; n < kernel.size(); n++) {
-    kernel[n] = lowpass_kernel[n] + highpass_kernel[n];
-  }
+    highpass_kernel[(highpass_kernel.size() - 1U) / 2U] += 1.0F;
 
-  std::ranges::for_each(kernel, [](auto& v) { v *= -1.0F; });
+    output.resize(highpass_kernel.size());
 
-  kernel[(kernel.size() - 1U) / 2U] += 1.0F;
+    // Creating a bandpass from a band reject through spectral inversion
+    // https://www.dspguide.com/ch16/4.htm
 
-  delay = 0.5F * static_cast<float>(kernel.size() - 1U) / static_cast<float>(rate);
+    for (size_t n = 0U; n < output.size(); n++) {
+      output[n] = lowpass_kernel[n] + highpass_kernel[n];
+    }
+
+    std::ranges::for_each(output, [](auto& v) { v *= -1.0F; });
+
+    output[(output.size() - 1U) / 2U] += 1.0F;
 
-  setup_zita();
+    return output;
+  });
+
+  delay = 0.5F * static_cast<float>(kernel.size() - 1U) / static_cast<float>(rate);
 }
@@ -31,5 +31,5 @@ class FirFilterBandpass : public FirFilterBase {
   auto operator=(const FirFilterBandpass&&) -> FirFilterBandpass& = delete;
   ~FirFilterBandpass() override;
 
-  void setup() override;
+  void create_kernel() override;
 };
@@ -0,0 +1,193 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fir_filter_bank.hpp"
+#include <fftw3.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <format>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include "fftw_planner.hpp"
+#include "split_complex.hpp"
+#include "util.hpp"
+
+FirFilterBank::FirFilterBank(std::string tag) : log_tag(std::move(tag)) {}
+
+FirFilterBank::~FirFilterBank() {
+  destroy_plans();
+}
+
+void FirFilterBank::destroy_plans() {
+  FftwPlanner::self().run([this] {
+    if (forward != nullptr) {
+      fftwf_destroy_plan(forward);
+    }
+
+    if (backward != nullptr) {
+      fftwf_destroy_plan(backward);
+    }
+  });
+
+  forward = nullptr;
+  backward = nullptr;
+}
+
+auto FirFilterBank::setup(const std::vector<std::vector<float>>& kernels, const uint& block_size) -> bool {
+  ready = false;
+
+  destroy_plans();
+
+  if (block_size == 0U || kernels.empty()) {
+    return false;
+  }
+
+  block = block_size;
+
+  const auto fft_size = 2U * static_cast<size_t>(block);
+
+  size_t max_length = 0U;
+
+  for (const auto& k : kernels) {
+    max_length = std::max(max_length, k.size());
+  }
+
+  n_partitions = std::max<size_t>((max_length + block - 1U) / block, 1U);
+  stride = split_complex::padded_size(block + 1U);
+  fdl_position = 0U;
+
+  time = split_complex::allocate(fft_size);
+  acc_re = split_complex::allocate(stride);
+  acc_im = split_complex::allocate(stride);
+
+  for (size_t c = 0U; c < 2U; c++) {
+    window[c] = split_complex::allocate(fft_size);
+    fdl_re[c] = split_complex::allocate(n_partitions * stride);
+    fdl_im[c] = split_complex::allocate(n_partitions * stride);
+  }
+
+  FftwPlanner::self().run([&] {
+    fftwf_iodim dim{.n = static_cast<int>(fft_size), .is = 1, .os = 1};
+
+    forward = fftwf_plan_guru_split_dft_r2c(1, &dim, 0, nullptr, window[0].get(), fdl_re[0].get(), fdl_im[0].get(),
+                                            FFTW_ESTIMATE);
+
+    backward = fftwf_plan_guru_split_dft_c2r(1, &dim, 0, nullptr, acc_re.get(), acc_im.get(), time.get(),
+                                             FFTW_ESTIMATE);
+  });
+
+  if (forward == nullptr || backward == nullptr) {
+    util::warning(std::format("{}could not create the fftw plans for {} samples", log_tag, fft_size));
+
+    return false;
+  }
+
+  // The inverse transform is not normalized. Its scale is applied to the filter spectra.
+
+  const auto scale = 1.0F / static_cast<float>(fft_size);
+
+  filter_re.clear();
+  filter_im.clear();
+  filter_partitions.clear();
+
+  for (const auto& k : kernels) {
+    const auto partitions = (k.size() + block - 1U) / block;
+
+    auto re = split_complex::allocate(partitions * stride);
+    auto im = split_complex::allocate(partitions * stride);
+
+    for (size_t j = 0U; j < partitions; j++) {
+      std::fill_n(time.get(), fft_size, 0.0F);
+
+      const auto first = j * block;
+      const auto last = std::min(first + block, k.size());
+
+      for (size_t n = first; n < last; n++) {
+        time[n - first] = scale * k[n];
+      }
+
+      fftwf_execute_split_dft_r2c(forward, time.get(), re.get() + (j * stride), im.get() + (j * stride));
+    }
+
+    filter_re.push_back(std::move(re));
+    filter_im.push_back(std::move(im));
+    filter_partitions.push_back(partitions);
+  }
+
+  ready = true;
+
+  return ready;
+}
+
+void FirFilterBank::process(std::span<const float> left,
+                            std::span<const float> right,
+                            std::span<std::vector<float>> bands_left,
+                            std::span<std::vector<float>> bands_right) {
+  if (!ready || left.size() != block || right.size() != block) {
+    return;
+  }
+
+  // One forward transform per channel is shared by all filters
+
+  fdl_position = (fdl_position + 1U) % n_partitions;
+
+  const auto inputs = std::array{left, right};
+
+  for (size_t c = 0U; c < 2U; c++) {
+    auto* w = window[c].get();
+
+    std::copy(w + block, w + (2U * block), w);
+
+    std::ranges::copy(inputs[c], w + block);
+
+    fftwf_execute_split_dft_r2c(forward, w, fdl_re[c].get() + (fdl_position * stride),
+                                fdl_im[c].get() + (fdl_position * stride));
+  }
+
+  const auto outputs = std::array{bands_left, bands_right};
+
+  const auto n_filters = std::min({filter_partitions.size(), bands_left.size(), bands_right.size()});
+
+  for (size_t f = 0U; f < n_filters; f++) {
+    for (size_t c = 0U; c < 2U; c++) {
+      for (size_t j = 0U; j < filter_partitions[f]; j++) {
+        // The partition j is applied to the input block received j blocks ago
+
+        const auto x = ((fdl_position + n_partitions - j) % n_partitions) * stride;
+        const auto h = j * stride;
+
+        split_complex::multiply_accumulate(fdl_re[c].get() + x, fdl_im[c].get() + x, filter_re[f].get() + h,
+                                           filter_im[f].get() + h, acc_re.get(), acc_im.get(), stride);
+      }
+
+      fftwf_execute_split_dft_c2r(backward, acc_re.get(), acc_im.get(), time.get());
+
+      // Only the second half of the overlap-save window is free of circular aliasing
+
+      std::copy_n(time.get() + block, block, outputs[c][f].begin());
+
+      std::fill_n(acc_re.get(), stride, 0.0F);
+      std::fill_n(acc_im.get(), stride, 0.0F);
+    }
+  }
+}
@@ -0,0 +1,82 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <fftw3.h>
+#include <sys/types.h>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+#include "split_complex.hpp"
+
+/**
+ * Applies several FIR filters to the same stereo signal. Each input block is
+ * transformed once per channel. Every filter then only needs its frequency
+ * domain products and one inverse transform per channel. The kernels are
+ * split in partitions of the block size (uniformly partitioned overlap-save),
+ * so no latency is added.
+ */
+class FirFilterBank {
+ public:
+  explicit FirFilterBank(std::string tag);
+  FirFilterBank(const FirFilterBank&) = delete;
+  auto operator=(const FirFilterBank&) -> FirFilterBank& = delete;
+  FirFilterBank(const FirFilterBank&&) = delete;
+  auto operator=(const FirFilterBank&&) -> FirFilterBank& = delete;
+  ~FirFilterBank();
+
+  // It must not be called while process is running
+  auto setup(const std::vector<std::vector<float>>& kernels, const uint& block_size) -> bool;
+
+  /**
+   * Filters one block of each channel. The output of the filter n is written
+   * to bands_left[n] and bands_right[n].
+   */
+  void process(std::span<const float> left,
+               std::span<const float> right,
+               std::span<std::vector<float>> bands_left,
+               std::span<std::vector<float>> bands_right);
+
+ private:
+  const std::string log_tag;
+
+  bool ready = false;
+
+  uint block = 0U;
+
+  size_t n_partitions = 0U;
+  size_t stride = 0U;
+  size_t fdl_position = 0U;
+
+  fftwf_plan forward = nullptr;
+  fftwf_plan backward = nullptr;
+
+  split_complex::Buffer time, acc_re, acc_im;
+
+  std::array<split_complex::Buffer, 2> window, fdl_re, fdl_im;
+
+  std::vector<split_complex::Buffer> filter_re, filter_im;
+
+  std::vector<size_t> filter_partitions;
+
+  void destroy_plans();
+};
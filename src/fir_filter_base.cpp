@@ -26,12 +26,12 @@
 #include <cmath>
 #include <cstddef>
 #include <format>
-#include <mutex>
 #include <numbers>
 #include <string>
 #include <thread>
 #include <utility>
 #include <vector>
+#include "fftw_planner.hpp"
 #include "util.hpp"
 
 namespace {
@@ -45,11 +45,11 @@ constexpr auto CONVPROC_SCHEDULER_CLASS = SCHED_FIFO;
 FirFilterBase::FirFilterBase(std::string tag) : log_tag(std::move(tag)) {}
 
 FirFilterBase::~FirFilterBase() {
-  std::scoped_lock<std::mutex> lock(util::fftw_lock());
-
   zita_ready = false;
 
-  free_zita();
+  // Zita destroys its fftw plans when deleted
+
+  FftwPlanner::self().run([this] { free_zita(); });
 }
 
 void FirFilterBase::free_zita() {
@@ -86,7 +86,13 @@ void FirFilterBase::set_transition_band(const float& value) {
   transition_band = value;
 }
 
-void FirFilterBase::setup() {}
+void FirFilterBase::setup() {
+  create_kernel();
+
+  setup_zita();
+}
+
+void FirFilterBase::create_kernel() {}
 
 auto FirFilterBase::create_lowpass_kernel(const float& cutoff, const float& transition_band) const
     -> std::vector<float> {
@@ -149,14 +155,18 @@ auto FirFilterBase::create_lowpass_kernel(const float& cutoff, const float& tran
 }
 
 void FirFilterBase::setup_zita() {
-  std::scoped_lock<std::mutex> lock(util::fftw_lock());
-
   zita_ready = false;
 
   if (n_samples == 0U || kernel.empty()) {
     return;
   }
 
+  // Zita creates its fftw plans in configure and impdata_create
+
+  FftwPlanner::self().run([this] { configure_zita(); });
+}
+
+void FirFilterBase::configure_zita() {
   free_zita();
 
   conv = new Convproc();
@@ -222,3 +232,7 @@ void FirFilterBase::direct_conv(const std::vector<float>& a, const std::vector<f
 auto FirFilterBase::get_delay() const -> float {
   return delay;
 }
+
+auto FirFilterBase::get_kernel() const -> const std::vector<float>& {
+  return kernel;
+}
@@ -23,7 +23,6 @@
 #include <zita-convolver.h>
 #include <algorithm>
 #include <format>
-#include <mutex>
 #include <span>
 #include <string>
 #include <vector>
@@ -48,12 +47,18 @@ class FirFilterBase {
 
   void set_transition_band(const float& value);
 
-  virtual void setup();
+  // Creates the kernel and the zita instance applying it
+  void setup();
+
+  // Only creates the kernel. It is applied elsewhere when the filter is part of a FirFilterBank.
+  virtual void create_kernel();
 
   void free_zita();
 
   [[nodiscard]] auto get_delay() const -> float;
 
+  [[nodiscard]] auto get_kernel() const -> const std::vector<float>&;
+
   template <typename T1>
   void process(T1& data_left, T1& data_right) {
     std::span conv_left_in(conv->inpdata(0), n_samples);
@@ -66,8 +71,6 @@ class FirFilterBase {
     std::copy(data_right.begin(), data_right.end(), conv_right_in.begin());
 
     if (zita_ready) {
-      std::scoped_lock<std::mutex> lock(util::fftw_lock());
-
       const int& ret = conv->process(true);  // thread sync mode set to true
 
       if (ret != 0) {
@@ -103,5 +106,7 @@ class FirFilterBase {
 
   void setup_zita();
 
+  void configure_zita();
+
   static void direct_conv(const std::vector<float>& a, const std::vector<float>& b, std::vector<float>& c);
 };
@@ -22,19 +22,33 @@
 #include <string>
 #include <utility>
 #include "fir_filter_base.hpp"
+#include "fir_kernel_cache.hpp"
 
 FirFilterHighpass::FirFilterHighpass(std::string tag) : FirFilterBase(std::move(tag)) {}
 
 FirFilterHighpass::~FirFilterHighpass() = default;
 
-void FirFilterHighpass::setup() {
-  kernel = create_lowpass_kernel(min_frequency, transition_band);
+void FirFilterHighpass::create_kernel() {
+  const FirKernelCache::Key key{.type = FirKernelCache::Type::highpass,
+                                .rate = rate,
+                                .min_frequency = min_frequency,
+                                .transition_band = transition_band};
 
-  std::ranges::for_each(kernel, [](auto& v) { v *= -1.0F; });
+  kernel = FirKernelCache::self().get(key, [&] {
+    auto output = create_lowpass_kernel(min_frequency, transition_band);
 
-  kernel[(kernel.size() - 1U) / 2U] += 1.0F;
+    if (output.empty()) {
+      return output;
+    }
 
-  delay = 0.5F * static_cast<float>(kernel.size() - 1U) / static_cast<float>(rate);
+    // Spectral inversion https://www.dspguide.com/ch16/4.htm
+
+    std::ranges::for_each(output, [](auto& v) { v *= -1.0F; });
+
+    output[(output.size() - 1U) / 2U] += 1.0F;
 
-  setup_zita();
+    return output;
+  });
+
+  delay = 0.5F * static_cast<float>(kernel.size() - 1U) / static_cast<float>(rate);
 }
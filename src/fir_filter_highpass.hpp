@@ -31,5 +31,5 @@ class FirFilterHighpass : public FirFilterBase {
   auto operator=(const FirFilterHighpass&&) -> FirFilterHighpass& = delete;
   ~FirFilterHighpass() override;
 
-  void setup() override;
+  void create_kernel() override;
 };
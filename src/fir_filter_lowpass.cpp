@@ -21,15 +21,19 @@
 #include <string>
 #include <utility>
 #include "fir_filter_base.hpp"
+#include "fir_kernel_cache.hpp"
 
 FirFilterLowpass::FirFilterLowpass(std::string tag) : FirFilterBase(std::move(tag)) {}
 
 FirFilterLowpass::~FirFilterLowpass() = default;
 
-void FirFilterLowpass::setup() {
-  kernel = create_lowpass_kernel(max_frequency, transition_band);
+void FirFilterLowpass::create_kernel() {
+  const FirKernelCache::Key key{.type = FirKernelCache::Type::lowpass,
+                                .rate = rate,
+                                .max_frequency = max_frequency,
+                                .transition_band = transition_band};
 
-  delay = 0.5F * static_cast<float>(kernel.size() - 1U) / static_cast<float>(rate);
+  kernel = FirKernelCache::self().get(key, [&] { return create_lowpass_kernel(max_frequency, transition_band); });
 
-  setup_zita();
+  delay = 0.5F * static_cast<float>(kernel.size() - 1U) / static_cast<float>(rate);
 }
@@ -31,5 +31,5 @@ class FirFilterLowpass : public FirFilterBase {
   auto operator=(const FirFilterLowpass&&) -> FirFilterLowpass& = delete;
   ~FirFilterLowpass() override;
 
-  void setup() override;
+  void create_kernel() override;
 };
@@ -0,0 +1,55 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fir_kernel_cache.hpp"
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+auto FirKernelCache::get(const Key& key, const std::function<std::vector<float>()>& make) -> std::vector<float> {
+  {
+    std::scoped_lock<std::mutex> lock(mutex);
+
+    if (auto it = kernels.find(key); it != kernels.end()) {
+      it->second.last_use = ++use_count;
+
+      return it->second.kernel;
+    }
+  }
+
+  auto kernel = make();
+
+  if (kernel.empty()) {
+    return kernel;
+  }
+
+  std::scoped_lock<std::mutex> lock(mutex);
+
+  if (kernels.size() >= max_entries && !kernels.contains(key)) {
+    // Dropping the least recently used design
+
+    kernels.erase(std::ranges::min_element(kernels, {}, [](const auto& item) { return item.second.last_use; }));
+  }
+
+  kernels[key] = {.kernel = kernel, .last_use = ++use_count};
+
+  return kernel;
+}
@@ -0,0 +1,86 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * Process wide cache of FIR kernel designs. Filters created with the same
+ * parameters, in any plugin instance or pipeline, reuse the kernel designed
+ * first instead of computing the windowed-sinc and its spectral inversions
+ * again. This makes toggling settings back and forth cheap.
+ */
+class FirKernelCache {
+ public:
+  enum class Type { lowpass, highpass, bandpass };
+
+  struct Key {
+    Type type = Type::lowpass;
+
+    uint rate = 0U;
+
+    float min_frequency = 0.0F;  // Zero for lowpass filters
+
+    float max_frequency = 0.0F;  // Zero for highpass filters
+
+    float transition_band = 0.0F;
+
+    auto operator<=>(const Key&) const = default;
+  };
+
+  FirKernelCache(const FirKernelCache&) = delete;
+  auto operator=(const FirKernelCache&) -> FirKernelCache& = delete;
+  FirKernelCache(const FirKernelCache&&) = delete;
+  auto operator=(const FirKernelCache&&) -> FirKernelCache& = delete;
+  ~FirKernelCache() = default;
+
+  static auto self() -> FirKernelCache& {
+    static FirKernelCache cache;
+    return cache;
+  }
+
+  // Returns the kernel cached under key. If there is none make is called to design it.
+  auto get(const Key& key, const std::function<std::vector<float>()>& make) -> std::vector<float>;
+
+ private:
+  FirKernelCache() = default;
+
+  struct Entry {
+    std::vector<float> kernel;
+
+    size_t last_use = 0U;
+  };
+
+  // Enough for the Crystalizer bands at a few rates and transition bands
+
+  static constexpr size_t max_entries = 256U;
+
+  std::mutex mutex;
+
+  size_t use_count = 0U;
+
+  std::map<Key, Entry> kernels;
+};
@@ -25,6 +25,7 @@
 #include <cstddef>
 #include <format>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include "db_manager.hpp"
@@ -51,7 +52,7 @@ LevelMeter::LevelMeter(const std::string& tag, pw::Manager* pipe_manager, Pipeli
 }
 
 LevelMeter::~LevelMeter() {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   ebur128_ready = false;
 
@@ -102,7 +103,7 @@ void LevelMeter::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   ebur128_ready = false;
 
@@ -120,7 +121,7 @@ void LevelMeter::setup() {
 
         auto status = init_ebur128();
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         ebur128_ready = status;
       },
@@ -132,12 +133,12 @@ void LevelMeter::process(std::span<float>& left_in,
                          std::span<float>& right_in,
                          std::span<float>& left_out,
                          std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
   std::ranges::copy(left_in, left_out.begin());
   std::ranges::copy(right_in, right_out.begin());
 
-  if (bypass || !ebur128_ready) {
+  if (bypass || !ebur128_ready || !lock.owns_lock()) {
     return;
   }
 
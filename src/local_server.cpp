@@ -32,8 +32,11 @@
 #include <regex>
 #include <string>
 #include "db_manager.hpp"
+#include "effects_base.hpp"
 #include "pipeline_type.hpp"
 #include "presets_manager.hpp"
+#include "stream_input_effects.hpp"
+#include "stream_output_effects.hpp"
 #include "tags_local_server.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
@@ -198,6 +201,36 @@ void LocalServer::onReadyRead() {
 
         socket->write(preset_name.toUtf8());
       }
+    } else if (std::strncmp(buf, tags::local_server::get_dsp_stats, strlen(tags::local_server::get_dsp_stats)) == 0) {
+      /**
+       * One line per plugin followed by an empty line:
+       * equalizer#0 count=1500 p50_ms=0.045 p99_ms=0.061 ... load_max=0.012
+       */
+
+      std::string msg = buf;
+
+      std::smatch matches;
+
+      static const auto re = std::regex("^get_dsp_stats:(input|output)\n$");
+
+      std::regex_search(msg, matches, re);
+
+      if (matches.size() == 2U) {
+        socket->write(get_dsp_stats(matches[1].str()).c_str());
+      }
+    } else if (std::strncmp(buf, tags::local_server::reset_dsp_stats, strlen(tags::local_server::reset_dsp_stats)) ==
+               0) {
+      std::string msg = buf;
+
+      std::smatch matches;
+
+      static const auto re = std::regex("^reset_dsp_stats:(input|output)\n$");
+
+      std::regex_search(msg, matches, re);
+
+      if (matches.size() == 2U) {
+        reset_dsp_stats(matches[1].str());
+      }
     } else if (std::strcmp(buf, tags::local_server::get_global_bypass) == 0) {
       socket->write(DbMain::bypass() ? "1" : "2");
     } else if (std::strncmp(buf, tags::local_server::toggle_global_bypass,
@@ -337,3 +370,45 @@ auto LocalServer::get_property(const std::string& pipeline,
 
   return val.toString().toStdString();
 }
+
+auto LocalServer::effects_from(const PipelineType& pipeline_type) -> EffectsBase* {
+  if (pipeline_type == PipelineType::input) {
+    return StreamInputEffects::singletonInstance;
+  }
+
+  return StreamOutputEffects::singletonInstance;
+}
+
+auto LocalServer::get_dsp_stats(const std::string& pipeline) -> std::string {
+  auto* effects = effects_from(pipeline_from(pipeline));
+
+  if (effects == nullptr) {
+    return "\n";
+  }
+
+  std::string output;
+
+  for (const auto& [name, plugin] : effects->get_plugins_map()) {
+    const auto stats = plugin->dsp_profiler.get_stats();
+
+    output += std::format(
+        "{} count={} p50_ms={:.3f} p99_ms={:.3f} max_ms={:.3f} budget_ms={:.3f} load_p50={:.3f} load_p99={:.3f} "
+        "load_max={:.3f}\n",
+        name.toStdString(), stats.count, stats.p50_ms, stats.p99_ms, stats.max_ms, stats.budget_ms, stats.load_p50,
+        stats.load_p99, stats.load_max);
+  }
+
+  return output + "\n";
+}
+
+void LocalServer::reset_dsp_stats(const std::string& pipeline) {
+  auto* effects = effects_from(pipeline_from(pipeline));
+
+  if (effects == nullptr) {
+    return;
+  }
+
+  for (const auto& [name, plugin] : effects->get_plugins_map()) {
+    plugin->dsp_profiler.reset();
+  }
+}
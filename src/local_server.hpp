@@ -26,6 +26,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include "effects_base.hpp"
 #include "pipeline_type.hpp"
 
 class LocalServer : public QObject {
@@ -64,4 +65,10 @@ class LocalServer : public QObject {
                            const std::string& instance_id,
                            const std::optional<std::string>& channel,
                            const std::string& property) -> std::string;
+
+  static auto effects_from(const PipelineType& pipeline_type) -> EffectsBase*;
+
+  static auto get_dsp_stats(const std::string& pipeline) -> std::string;
+
+  static void reset_dsp_stats(const std::string& pipeline);
 };
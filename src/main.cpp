@@ -289,11 +289,7 @@ static void initQml(QQmlApplicationEngine& engine,
   }
 }
 
-static int runSecondaryInstance(const QLockFile& lockFile,
-                                KAboutData& about,
-                                QApplication& app,
-                                CommandLineParser& parser,
-                                bool& show_window) {
+static int runSecondaryInstance(const QLockFile& lockFile, CommandLineParser& parser, bool& show_window) {
   auto local_client = std::make_unique<LocalClient>();
 
   QObject::connect(&parser, &CommandLineParser::onQuit, [&]() {
@@ -342,9 +338,7 @@ static int runSecondaryInstance(const QLockFile& lockFile,
   });
 
   parser.set_is_primary(false);
-  parser.process(about, &app);
   parser.process_events();
-  parser.process_debug_option();
 
   // If we do this before process_debug_option we won't see any log message
   util::handle_lock_file_error(lockFile);
@@ -402,6 +396,20 @@ int main(int argc, char* argv[]) {
 
   QObject::connect(cmd_parser.get(), &CommandLineParser::onReset, [&]() { db::Manager::self().resetAll(); });
 
+  cmd_parser->process(about, &app);
+  cmd_parser->process_debug_option();  // if we take too long to process this one we will miss debug messages
+
+  // The offline renderer does not need PipeWire nor interacts with a running instance
+  if (cmd_parser->render_requested()) {
+    return cmd_parser->process_render();
+  }
+
+#ifdef ENABLE_BENCHMARKS
+  if (cmd_parser->bench_requested()) {
+    return cmd_parser->process_bench();
+  }
+#endif
+
   // Checking if there is already an instance running
 
   auto lockFile = util::get_lock_file();
@@ -411,11 +419,9 @@ int main(int argc, char* argv[]) {
   if (!lockFile->isLocked()) {
     // Used only by an instance started when one is already running
 
-    return runSecondaryInstance(*lockFile, about, app, *cmd_parser, show_window);
+    return runSecondaryInstance(*lockFile, *cmd_parser, show_window);
   }
 
-  cmd_parser->process(about, &app);
-  cmd_parser->process_debug_option();  // if we take too long to process this one we will miss debug messages
   cmd_parser->process_hide_window(show_window);
 
   // If we do this before process_debug_option we won't see any log message
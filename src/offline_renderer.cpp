@@ -0,0 +1,318 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "offline_renderer.hpp"
+#include <sndfile.h>
+#include <sys/types.h>
+#include <QCoreApplication>
+#include <QString>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <sndfile.hh>
+#include <span>
+#include <string>
+#include <vector>
+#include "db_manager.hpp"
+#include "easyeffects_db_streaminputs.h"
+#include "easyeffects_db_streamoutputs.h"
+#include "effects_base.hpp"
+#include "pipeline_type.hpp"
+#include "plugin_base.hpp"
+#include "presets_manager.hpp"
+#include "util.hpp"
+
+OfflineRenderer::OfflineRenderer(PipelineType pipe_type, const uint& n_samples)
+    : pipeline_type(pipe_type), n_samples(n_samples) {
+  // Nothing done while rendering is saved to the user configuration
+  db::Manager::self().setReadOnly(true);
+}
+
+OfflineRenderer::~OfflineRenderer() {
+  util::debug(std::format("{}destroyed", log_tag));
+}
+
+auto OfflineRenderer::load_preset(const std::string& preset) -> bool {
+  auto& presets_manager = presets::Manager::self();
+
+  if (std::filesystem::is_regular_file(preset)) {
+    return presets_manager.load_preset_file(pipeline_type, preset);
+  }
+
+  if (!presets_manager.preset_file_exists(pipeline_type, preset)) {
+    util::warning(std::format("{}the preset {} does not exist", log_tag, preset));
+
+    return false;
+  }
+
+  return presets_manager.loadLocalPresetFile(pipeline_type, QString::fromStdString(preset));
+}
+
+void OfflineRenderer::set_probe_file(const std::filesystem::path& file) {
+  probe_file = file;
+}
+
+void OfflineRenderer::create_plugins() {
+  plugins.clear();
+
+  const auto list = (pipeline_type == PipelineType::output ? DbStreamOutputs::plugins() : DbStreamInputs::plugins());
+
+  for (const auto& name : list) {
+    auto plugin = EffectsBase::create_plugin(name, log_tag, nullptr, pipeline_type);
+
+    if (plugin == nullptr) {
+      util::warning(std::format("{}unknown plugin {}. It will be skipped", log_tag, name.toStdString()));
+
+      continue;
+    }
+
+    if (!plugin->packageInstalled) {
+      util::warning(std::format("{}{} is not installed. It will be bypassed", log_tag, name.toStdString()));
+    }
+
+    plugin->set_quantum(rate, n_samples);
+
+    plugins.push_back(std::move(plugin));
+  }
+
+  /**
+   * Most plugins finish their initialization in the worker thread. Some of
+   * them then send the result back to the main thread, like the convolver does
+   * with its kernel. So we flush both event queues twice.
+   */
+
+  for (int n = 0; n < 2; n++) {
+    for (auto& plugin : plugins) {
+      plugin->wait_for_worker();
+    }
+
+    QCoreApplication::processEvents();
+  }
+}
+
+void OfflineRenderer::process_chain() {
+  if (plugins.empty()) {
+    std::ranges::copy(left_in, left_out.begin());
+    std::ranges::copy(right_in, right_out.begin());
+
+    return;
+  }
+
+  std::span<float> l_in(left_in);
+  std::span<float> r_in(right_in);
+  std::span<float> p_left(probe_left);
+  std::span<float> p_right(probe_right);
+
+  for (size_t n = 0U; n < plugins.size(); n++) {
+    auto& plugin = plugins[n];
+
+    const bool last = n == plugins.size() - 1U;
+
+    std::span<float> l_out = last ? std::span<float>(left_out) : std::span<float>(scratch_left[n % 2U]);
+    std::span<float> r_out = last ? std::span<float>(right_out) : std::span<float>(scratch_right[n % 2U]);
+
+    if (plugin->enable_probe) {
+      plugin->process(l_in, r_in, l_out, r_out, p_left, p_right);
+    } else {
+      plugin->process(l_in, r_in, l_out, r_out);
+    }
+
+    l_in = l_out;
+    r_in = r_out;
+  }
+}
+
+auto OfflineRenderer::get_latency_frames() const -> uint {
+  float latency = 0.0F;
+
+  for (const auto& plugin : plugins) {
+    latency += plugin->get_latency_seconds();
+  }
+
+  return static_cast<uint>(std::round(latency * static_cast<float>(rate)));
+}
+
+auto OfflineRenderer::render(const std::filesystem::path& input_file, const std::filesystem::path& output_file)
+    -> bool {
+  SndfileHandle input(input_file.string());
+
+  if (input.error() != 0) {
+    util::warning(std::format("{}failed to open {}: {}", log_tag, input_file.string(), input.strError()));
+
+    return false;
+  }
+
+  const auto channels = static_cast<uint>(input.channels());
+
+  if (channels != 1U && channels != 2U) {
+    util::warning(std::format("{}only mono and stereo files are supported: {}", log_tag, input_file.string()));
+
+    return false;
+  }
+
+  rate = static_cast<uint>(input.samplerate());
+
+  SndfileHandle output(output_file.string(), SFM_WRITE, SF_FORMAT_WAV | SF_FORMAT_FLOAT, 2, static_cast<int>(rate));
+
+  if (output.error() != 0) {
+    util::warning(std::format("{}failed to create {}: {}", log_tag, output_file.string(), output.strError()));
+
+    return false;
+  }
+
+  /**
+   * Feeding the pipeline input to the probe would make the echo canceller
+   * remove the input itself. Without a probe file it receives silence.
+   */
+
+  SndfileHandle probe;
+
+  uint probe_channels = 0U;
+
+  if (!probe_file.empty()) {
+    probe = SndfileHandle(probe_file.string());
+
+    if (probe.error() != 0) {
+      util::warning(std::format("{}failed to open {}: {}", log_tag, probe_file.string(), probe.strError()));
+
+      return false;
+    }
+
+    probe_channels = static_cast<uint>(probe.channels());
+
+    if (probe_channels != 1U && probe_channels != 2U) {
+      util::warning(std::format("{}only mono and stereo files are supported: {}", log_tag, probe_file.string()));
+
+      return false;
+    }
+
+    if (static_cast<uint>(probe.samplerate()) != rate) {
+      util::warning(std::format("{}the probe file {} does not have the sampling rate of the input: {} Hz", log_tag,
+                                probe_file.string(), rate));
+
+      return false;
+    }
+  }
+
+  for (auto* v : {&left_in, &right_in, &left_out, &right_out, &probe_left, &probe_right}) {
+    v->assign(n_samples, 0.0F);
+  }
+
+  for (size_t n = 0U; n < scratch_left.size(); n++) {
+    scratch_left[n].resize(n_samples);
+    scratch_right[n].resize(n_samples);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  create_plugins();
+
+  std::vector<float> buffer_in(static_cast<size_t>(n_samples) * channels);
+  std::vector<float> buffer_out(static_cast<size_t>(n_samples) * 2U);
+  std::vector<float> buffer_probe(static_cast<size_t>(n_samples) * probe_channels);
+
+  const auto total_frames = static_cast<sf_count_t>(input.frames());
+
+  sf_count_t frames_written = 0;
+
+  /**
+   * The first latency frames produced by the pipeline are discarded. After the
+   * end of the input we keep feeding silence until the delayed tail has been
+   * written.
+   */
+
+  uint frames_to_skip = 0U;
+
+  bool first_quantum = true;
+
+  while (frames_written < total_frames) {
+    const auto frames_read = static_cast<size_t>(std::max<sf_count_t>(input.readf(buffer_in.data(), n_samples), 0));
+
+    for (size_t n = 0U; n < n_samples; n++) {
+      if (n < frames_read) {
+        left_in[n] = buffer_in[n * channels];
+        right_in[n] = buffer_in[(n * channels) + channels - 1U];
+      } else {
+        left_in[n] = 0.0F;
+        right_in[n] = 0.0F;
+      }
+    }
+
+    if (probe_channels != 0U) {
+      const auto probe_read =
+          static_cast<size_t>(std::max<sf_count_t>(probe.readf(buffer_probe.data(), n_samples), 0));
+
+      for (size_t n = 0U; n < n_samples; n++) {
+        if (n < probe_read) {
+          probe_left[n] = buffer_probe[n * probe_channels];
+          probe_right[n] = buffer_probe[(n * probe_channels) + probe_channels - 1U];
+        } else {
+          probe_left[n] = 0.0F;
+          probe_right[n] = 0.0F;
+        }
+      }
+    }
+
+    process_chain();
+
+    if (first_quantum) {
+      // Latencies are reported by the plugins after their first run
+      frames_to_skip = get_latency_frames();
+
+      first_quantum = false;
+
+      util::debug(std::format("{}pipeline latency: {} frames", log_tag, frames_to_skip));
+    }
+
+    const auto offset = std::min(frames_to_skip, n_samples);
+
+    frames_to_skip -= offset;
+
+    const auto count =
+        static_cast<size_t>(std::min<sf_count_t>(n_samples - offset, total_frames - frames_written));
+
+    for (size_t n = 0U; n < count; n++) {
+      buffer_out[2U * n] = left_out[offset + n];
+      buffer_out[(2U * n) + 1U] = right_out[offset + n];
+    }
+
+    const auto n_frames = static_cast<sf_count_t>(count);
+
+    if (n_frames > 0 && output.writef(buffer_out.data(), n_frames) != n_frames) {
+      util::warning(std::format("{}failed to write to {}: {}", log_tag, output_file.string(), output.strError()));
+
+      return false;
+    }
+
+    frames_written += n_frames;
+  }
+
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  const auto duration = static_cast<double>(total_frames) / static_cast<double>(rate);
+
+  util::info(std::format("{}rendered {:.2f} s of audio in {:.2f} s ({:.1f}x real time)", log_tag, duration,
+                         elapsed.count(), elapsed.count() > 0.0 ? duration / elapsed.count() : 0.0));
+
+  return true;
+}
@@ -0,0 +1,88 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <array>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "pipeline_type.hpp"
+#include "plugin_base.hpp"
+
+/**
+ * Runs the effects pipeline stored in the database over an audio file without
+ * PipeWire. The plugins are created without filter nodes and process() is
+ * called directly in fixed quanta, faster than real time. The output is a
+ * stereo 32 bit float WAV file with the same sampling rate as the input. The
+ * pipeline latency is compensated, so the output is aligned with the input
+ * and has the same number of frames.
+ *
+ * Plugins with a probe input, like the echo canceller, receive silence there
+ * unless a probe file is set. It plays the role of the monitor of the output
+ * device and is read in step with the input file.
+ */
+class OfflineRenderer {
+ public:
+  OfflineRenderer(PipelineType pipe_type, const uint& n_samples);
+  OfflineRenderer(const OfflineRenderer&) = delete;
+  auto operator=(const OfflineRenderer&) -> OfflineRenderer& = delete;
+  OfflineRenderer(const OfflineRenderer&&) = delete;
+  auto operator=(const OfflineRenderer&&) -> OfflineRenderer& = delete;
+  ~OfflineRenderer();
+
+  /**
+   * Loads a preset file given by its path or the name of a local preset. The
+   * user configuration is not modified.
+   */
+  auto load_preset(const std::string& preset) -> bool;
+
+  /**
+   * Audio file fed to the probe input of the plugins. It must have the same
+   * sampling rate as the rendered file. Silence is used after its end.
+   */
+  void set_probe_file(const std::filesystem::path& file);
+
+  auto render(const std::filesystem::path& input_file, const std::filesystem::path& output_file) -> bool;
+
+ private:
+  const std::string log_tag = "render: ";
+
+  PipelineType pipeline_type;
+
+  uint n_samples = 0U;
+
+  uint rate = 0U;
+
+  std::filesystem::path probe_file;
+
+  std::vector<std::unique_ptr<PluginBase>> plugins;
+
+  std::vector<float> left_in, right_in, left_out, right_out, probe_left, probe_right;
+
+  std::array<std::vector<float>, 2U> scratch_left, scratch_right;
+
+  void create_plugins();
+
+  void process_chain();
+
+  [[nodiscard]] auto get_latency_frames() const -> uint;
+};
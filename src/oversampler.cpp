@@ -0,0 +1,234 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "oversampler.hpp"
+#include <sys/types.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <numbers>
+#include <span>
+#include <vector>
+#include "lv2_wrapper.hpp"
+
+namespace {
+
+constexpr size_t lanes = 8U;
+
+using Lanes = float __attribute__((vector_size(lanes * sizeof(float))));
+
+// Modified Bessel function of the first kind and order zero. Used by the Kaiser window.
+auto bessel_i0(const double& x) -> double {
+  double sum = 1.0;
+  double term = 1.0;
+
+  for (int k = 1; k < 50; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+
+    sum += term;
+
+    if (term < sum * 1e-12) {
+      break;
+    }
+  }
+
+  return sum;
+}
+
+}  // namespace
+
+Oversampler::Oversampler(const uint& n_channels) : channels(std::max(n_channels, 1U)) {
+  design_filter();
+}
+
+void Oversampler::set_quality(const int& value) {
+  quality = std::clamp(value, 0, 10);
+
+  design_filter();
+}
+
+void Oversampler::design_filter() {
+  // Each quality step makes the filter longer and asks for more stopband attenuation
+
+  n_pairs = 4U + (4U * static_cast<size_t>(quality));
+
+  const double attenuation = 50.0 + (7.0 * quality);  // dB
+
+  const double beta = 0.1102 * (attenuation - 8.7);
+
+  /**
+   * Windowed-sinc half-band filter https://www.dspguide.com/ch16/1.htm
+   * With the cutoff at a quarter of the oversampled rate the taps at even
+   * distances from the center are zero.
+   */
+
+  const auto center = static_cast<double>((2U * n_pairs) - 1U);
+
+  coefficients.resize(n_pairs);
+
+  double sum = 0.0;
+
+  for (size_t j = 1U; j <= n_pairs; j++) {
+    const auto distance = static_cast<double>((2U * j) - 1U);
+
+    const double sinc = std::sin(0.5 * std::numbers::pi * distance) / (std::numbers::pi * distance);
+
+    const double r = distance / center;
+
+    const double window = bessel_i0(beta * std::sqrt(1.0 - (r * r))) / bessel_i0(beta);
+
+    coefficients[j - 1U] = static_cast<float>(sinc * window);
+
+    sum += 2.0 * sinc * window;
+  }
+
+  // Unit gain at zero frequency. With the center tap being 0.5 the pairs have to add up to 0.5.
+
+  std::ranges::for_each(coefficients, [&](auto& v) { v = static_cast<float>(v * 0.5 / sum); });
+
+  const auto max_frames = static_cast<size_t>(lv2::Lv2Wrapper::max_quantum);
+
+  for (auto& c : channels) {
+    c.up_input.resize(history_size() + max_frames);
+    c.down_even.resize(history_size() + max_frames);
+    c.down_odd.resize(history_size() + max_frames);
+    c.phase.resize(max_frames);
+  }
+
+  reset();
+}
+
+void Oversampler::reset() {
+  for (auto& c : channels) {
+    std::ranges::fill(c.up_input, 0.0F);
+    std::ranges::fill(c.down_even, 0.0F);
+    std::ranges::fill(c.down_odd, 0.0F);
+  }
+}
+
+auto Oversampler::history_size() const -> size_t {
+  return (2U * n_pairs) - 1U;
+}
+
+auto Oversampler::get_latency_frames() const -> uint {
+  return static_cast<uint>(history_size());
+}
+
+void Oversampler::convolve_pairs(const float* x, float* y, const size_t& n, const float& gain) const {
+  std::fill_n(y, n, 0.0F);
+
+  const auto simd_end = n - (n % lanes);
+
+  for (size_t j = 1U; j <= n_pairs; j++) {
+    const float h = gain * coefficients[j - 1U];
+
+    const float* a = x + j - n_pairs;
+    const float* b = x + 1U - n_pairs - j;
+
+    for (size_t m = 0U; m < simd_end; m += lanes) {
+      Lanes va;
+      Lanes vb;
+      Lanes vy;
+
+      std::memcpy(&va, a + m, sizeof(Lanes));
+      std::memcpy(&vb, b + m, sizeof(Lanes));
+      std::memcpy(&vy, y + m, sizeof(Lanes));
+
+      vy += h * (va + vb);
+
+      std::memcpy(y + m, &vy, sizeof(Lanes));
+    }
+
+    for (size_t m = simd_end; m < n; m++) {
+      y[m] += h * (a[m] + b[m]);
+    }
+  }
+}
+
+void Oversampler::upsample(const uint& channel, std::span<const float> input, std::span<float> output) {
+  const auto n = input.size();
+
+  if (channel >= channels.size() || n > channels[channel].phase.size() || output.size() < 2U * n) {
+    std::ranges::fill(output, 0.0F);
+
+    return;
+  }
+
+  auto& c = channels[channel];
+
+  const auto hs = history_size();
+
+  auto* x = c.up_input.data() + hs;
+
+  std::ranges::copy(input, x);
+
+  /**
+   * The even output frames come from the symmetric pairs. The odd ones only
+   * see the center tap, so they are the input delayed by n_pairs - 1 frames.
+   * The gain of 2 compensates the zeros inserted between the input frames.
+   */
+
+  convolve_pairs(x, c.phase.data(), n, 2.0F);
+
+  const auto* delayed = x + 1U - n_pairs;
+
+  for (size_t m = 0U; m < n; m++) {
+    output[2U * m] = c.phase[m];
+    output[(2U * m) + 1U] = delayed[m];
+  }
+
+  std::copy_n(x + n - hs, hs, c.up_input.begin());
+}
+
+void Oversampler::downsample(const uint& channel, std::span<const float> input, std::span<float> output) {
+  const auto n = input.size() / 2U;
+
+  if (channel >= channels.size() || n > channels[channel].phase.size() || output.size() < n ||
+      input.size() % 2U != 0U) {
+    std::ranges::fill(output, 0.0F);
+
+    return;
+  }
+
+  auto& c = channels[channel];
+
+  const auto hs = history_size();
+
+  auto* even = c.down_even.data() + hs;
+  auto* odd = c.down_odd.data() + hs;
+
+  for (size_t m = 0U; m < n; m++) {
+    even[m] = input[2U * m];
+    odd[m] = input[(2U * m) + 1U];
+  }
+
+  // The pairs only touch the even input frames and the center tap only the odd ones
+
+  convolve_pairs(even, output.data(), n, 1.0F);
+
+  const auto* delayed = odd - n_pairs;
+
+  for (size_t m = 0U; m < n; m++) {
+    output[m] += 0.5F * delayed[m];
+  }
+
+  std::copy_n(even + n - hs, hs, c.down_even.begin());
+  std::copy_n(odd + n - hs, hs, c.down_odd.begin());
+}
@@ -0,0 +1,93 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+/**
+ * Oversampling by exactly 2x for nonlinear processing. The up and down
+ * conversions use a linear phase half-band FIR filter in polyphase form.
+ * Half of its taps are zero and the other half is symmetric, so each output
+ * frame costs about a quarter of the multiplications of a regular FIR of the
+ * same length.
+ *
+ * The quality goes from 0 to 10. Higher values use longer filters with a
+ * sharper transition at the original Nyquist frequency and more stopband
+ * attenuation. They cost more cpu and add more latency.
+ *
+ * Each call can take up to lv2::Lv2Wrapper::max_quantum frames at the
+ * original rate. Processing does not allocate.
+ */
+class Oversampler {
+ public:
+  explicit Oversampler(const uint& n_channels = 2U);
+  Oversampler(const Oversampler&) = delete;
+  auto operator=(const Oversampler&) -> Oversampler& = delete;
+  Oversampler(const Oversampler&&) = delete;
+  auto operator=(const Oversampler&&) -> Oversampler& = delete;
+  ~Oversampler() = default;
+
+  // Designs the filter and clears the channels history. Not realtime safe.
+  void set_quality(const int& value);
+
+  void reset();
+
+  // Writes 2 * input.size() frames to output
+  void upsample(const uint& channel, std::span<const float> input, std::span<float> output);
+
+  // Writes input.size() / 2 frames to output. The input size has to be even.
+  void downsample(const uint& channel, std::span<const float> input, std::span<float> output);
+
+  // Delay of an upsample followed by a downsample in frames of the original rate
+  [[nodiscard]] auto get_latency_frames() const -> uint;
+
+ private:
+  int quality = 5;
+
+  /**
+   * The filter has 4 * n_pairs - 1 taps. Around the center tap, which is
+   * 0.5, every second tap is zero. The others form n_pairs symmetric pairs.
+   */
+  size_t n_pairs = 0U;
+
+  std::vector<float> coefficients;  // one value per pair
+
+  struct Channel {
+    // The history of 2 * n_pairs - 1 frames followed by the current block
+
+    std::vector<float> up_input;
+    std::vector<float> down_even;
+    std::vector<float> down_odd;
+
+    std::vector<float> phase;
+  };
+
+  std::vector<Channel> channels;
+
+  void design_filter();
+
+  // y[m] = sum_j h_j * (x[m - n_pairs + j] + x[m - n_pairs - j + 1]), where x points to x[0] after the history
+  void convolve_pairs(const float* x, float* y, const size_t& n, const float& gain) const;
+
+  [[nodiscard]] auto history_size() const -> size_t;
+};
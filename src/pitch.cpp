@@ -20,12 +20,16 @@
 #include "pitch.hpp"
 #include <qnamespace.h>
 #include <qobject.h>
+#include <qtimer.h>
 #include <soundtouch/STTypes.h>
 #include <soundtouch/SoundTouch.h>
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <format>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include "db_manager.hpp"
@@ -55,25 +59,25 @@ Pitch::Pitch(const std::string& tag, pw::Manager* pipe_manager, PipelineType pip
 
   connect(settings, &DbPitch::bypassChanged, [&]() { resetHistory(); });
 
-  connect(settings, &DbPitch::quickSeekChanged, [&]() { set_quick_seek(); });
+  connect(settings, &DbPitch::quickSeekChanged, [&]() { rebuild_soundtouch(); });
 
-  connect(settings, &DbPitch::antiAliasChanged, [&]() { set_anti_alias(); });
+  connect(settings, &DbPitch::antiAliasChanged, [&]() { rebuild_soundtouch(); });
 
-  connect(settings, &DbPitch::sequenceLengthChanged, [&]() { set_sequence_length(); });
+  connect(settings, &DbPitch::sequenceLengthChanged, [&]() { rebuild_soundtouch(); });
 
-  connect(settings, &DbPitch::seekWindowChanged, [&]() { set_seek_window(); });
+  connect(settings, &DbPitch::seekWindowChanged, [&]() { rebuild_soundtouch(); });
 
-  connect(settings, &DbPitch::overlapLengthChanged, [&]() { set_overlap_length(); });
+  connect(settings, &DbPitch::overlapLengthChanged, [&]() { rebuild_soundtouch(); });
 
-  connect(settings, &DbPitch::tempoDifferenceChanged, [&]() { set_tempo_difference(); });
+  connect(settings, &DbPitch::tempoDifferenceChanged, [&]() { publish_parameters(); });
 
-  connect(settings, &DbPitch::rateDifferenceChanged, [&]() { set_rate_difference(); });
+  connect(settings, &DbPitch::rateDifferenceChanged, [&]() { publish_parameters(); });
 
-  connect(settings, &DbPitch::octavesChanged, [&]() { set_semitones(); });
+  connect(settings, &DbPitch::octavesChanged, [&]() { publish_parameters(); });
 
-  connect(settings, &DbPitch::semitonesChanged, [&]() { set_semitones(); });
+  connect(settings, &DbPitch::semitonesChanged, [&]() { publish_parameters(); });
 
-  connect(settings, &DbPitch::centsChanged, [&]() { set_semitones(); });
+  connect(settings, &DbPitch::centsChanged, [&]() { publish_parameters(); });
 
   connect(settings, &DbPitch::dryChanged, [&]() {
     dry =
@@ -95,9 +99,7 @@ Pitch::~Pitch() {
 
   settings->disconnect();
 
-  delete snd_touch;
-
-  snd_touch = nullptr;
+  delete_soundtouch_instances();
 
   util::debug(std::format("{}{} destroyed", log_tag, name.toStdString()));
 }
@@ -116,7 +118,7 @@ void Pitch::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   soundtouch_ready = false;
 
@@ -136,9 +138,11 @@ void Pitch::setup() {
         deque_out_L.resize(0U);
         deque_out_R.resize(0U);
 
+        delete_soundtouch_instances();
+
         init_soundtouch();
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         soundtouch_ready = true;
       },
@@ -149,15 +153,35 @@ void Pitch::process(std::span<float>& left_in,
                     std::span<float>& right_in,
                     std::span<float>& left_out,
                     std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass || !soundtouch_ready) {
+  if (bypass || !soundtouch_ready || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
     return;
   }
 
+  // A new instance is only taken after the previous replaced one was deleted
+
+  bool swapped = false;
+
+  if (snd_touch_retired.load(std::memory_order_acquire) == nullptr) {
+    if (auto* next = snd_touch_pending.exchange(nullptr, std::memory_order_acq_rel); next != nullptr) {
+      snd_touch_retired.store(snd_touch, std::memory_order_release);
+
+      snd_touch = next;
+
+      swapped = true;
+    }
+  }
+
+  // The new instance may have been built before the latest snapshot was published
+
+  if ((parameters.update() || swapped) && parameters.get() != nullptr) {
+    apply_parameters(*parameters.get(), swapped);
+  }
+
   if (input_gain != 1.0F) {
     apply_gain(left_in, right_in, input_gain);
   }
@@ -248,107 +272,87 @@ void Pitch::process([[maybe_unused]] std::span<float>& left_in,
                     [[maybe_unused]] std::span<float>& probe_left,
                     [[maybe_unused]] std::span<float>& probe_right) {}
 
-void Pitch::set_semitones() {
-  if (snd_touch == nullptr) {
-    return;
-  }
-
-  std::scoped_lock<std::mutex> lock(data_mutex);
+auto Pitch::make_parameters() const -> Parameters {
+  return {.semitones = settings->semitones() + (settings->octaves() * 12.0) + (settings->cents() / 100.0),
+          .tempo_difference = settings->tempoDifference(),
+          .rate_difference = settings->rateDifference()};
+}
 
-  snd_touch->setPitchSemiTones(settings->semitones() + (settings->octaves() * 12.0) + (settings->cents() / 100.0));
+void Pitch::publish_parameters() {
+  parameters.publish(std::make_unique<const Parameters>(make_parameters()));
 }
 
-void Pitch::set_sequence_length() {
-  if (snd_touch == nullptr) {
-    return;
+void Pitch::apply_parameters(const Parameters& p, const bool& force) {
+  if (force || p.semitones != applied_parameters.semitones) {
+    snd_touch->setPitchSemiTones(p.semitones);
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
-  snd_touch->setSetting(SETTING_SEQUENCE_MS, settings->sequenceLength());
-}
-
-void Pitch::set_seek_window() {
-  if (snd_touch == nullptr) {
-    return;
+  if (force || p.tempo_difference != applied_parameters.tempo_difference) {
+    snd_touch->setTempoChange(p.tempo_difference);
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  if (force || p.rate_difference != applied_parameters.rate_difference) {
+    snd_touch->setRateChange(p.rate_difference);
+  }
 
-  snd_touch->setSetting(SETTING_SEEKWINDOW_MS, settings->seekWindow());
+  applied_parameters = p;
 }
 
-void Pitch::set_overlap_length() {
-  if (snd_touch == nullptr) {
-    return;
-  }
+auto Pitch::create_soundtouch() const -> soundtouch::SoundTouch* {
+  auto* instance = new soundtouch::SoundTouch();
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  instance->setSampleRate(rate);
+  instance->setChannels(2);
 
-  snd_touch->setSetting(SETTING_OVERLAP_MS, settings->overlapLength());
-}
+  instance->setSetting(SETTING_USE_QUICKSEEK, static_cast<int>(settings->quickSeek()));
+  instance->setSetting(SETTING_USE_AA_FILTER, static_cast<int>(settings->antiAlias()));
+  instance->setSetting(SETTING_SEQUENCE_MS, settings->sequenceLength());
+  instance->setSetting(SETTING_SEEKWINDOW_MS, settings->seekWindow());
+  instance->setSetting(SETTING_OVERLAP_MS, settings->overlapLength());
 
-void Pitch::set_quick_seek() {
-  if (snd_touch == nullptr) {
-    return;
-  }
+  const auto p = make_parameters();
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  instance->setPitchSemiTones(p.semitones);
+  instance->setTempoChange(p.tempo_difference);
+  instance->setRateChange(p.rate_difference);
 
-  snd_touch->setSetting(SETTING_USE_QUICKSEEK, static_cast<int>(settings->quickSeek()));
+  return instance;
 }
 
-void Pitch::set_anti_alias() {
-  if (snd_touch == nullptr) {
-    return;
-  }
-
-  std::scoped_lock<std::mutex> lock(data_mutex);
+void Pitch::init_soundtouch() {
+  snd_touch = create_soundtouch();
 
-  snd_touch->setSetting(SETTING_USE_AA_FILTER, static_cast<int>(settings->antiAlias()));
+  applied_parameters = make_parameters();
 }
 
-void Pitch::set_tempo_difference() {
-  if (snd_touch == nullptr) {
-    return;
-  }
-
-  std::scoped_lock<std::mutex> lock(data_mutex);
+void Pitch::rebuild_soundtouch() {
+  QMetaObject::invokeMethod(
+      baseWorker,
+      [this] {
+        if (!soundtouch_ready) {
+          // setup() builds the instance with the current settings
+          return;
+        }
 
-  snd_touch->setTempoChange(settings->tempoDifference());
-}
+        delete snd_touch_retired.exchange(nullptr, std::memory_order_acq_rel);
 
-void Pitch::set_rate_difference() {
-  if (snd_touch == nullptr) {
-    return;
-  }
+        delete snd_touch_pending.exchange(create_soundtouch(), std::memory_order_acq_rel);
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+        // The realtime thread may have been between taking the previous instance and retiring it
 
-  snd_touch->setRateChange(settings->rateDifference());
+        QTimer::singleShot(retire_delay, baseWorker,
+                           [this]() { delete snd_touch_retired.exchange(nullptr, std::memory_order_acq_rel); });
+      },
+      Qt::QueuedConnection);
 }
 
-void Pitch::init_soundtouch() {
-  delete snd_touch;
-
-  snd_touch = new soundtouch::SoundTouch();
+void Pitch::delete_soundtouch_instances() {
+  delete snd_touch_pending.exchange(nullptr);
+  delete snd_touch_retired.exchange(nullptr);
 
-  if (snd_touch == nullptr) {
-    util::warning(std::format("{} failed to allocate SoundTouch object", log_tag));
-    return;
-  }
+  delete snd_touch;
 
-  snd_touch->setSampleRate(rate);
-  snd_touch->setChannels(2);
-
-  set_semitones();
-  set_quick_seek();
-  set_anti_alias();
-  set_sequence_length();
-  set_seek_window();
-  set_overlap_length();
-  set_tempo_difference();
-  set_rate_difference();
+  snd_touch = nullptr;
 }
 
 auto Pitch::get_latency_seconds() -> float {
@@ -25,6 +25,8 @@
 #include <qtypes.h>
 #include <soundtouch/STTypes.h>
 #include <soundtouch/SoundTouch.h>
+#include <atomic>
+#include <chrono>
 #include <deque>
 #include <span>
 #include <string>
@@ -33,6 +35,7 @@
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
+#include "rt_sync.hpp"
 
 class Pitch : public PluginBase {
   Q_OBJECT
@@ -91,13 +94,42 @@ class Pitch : public PluginBase {
 
   soundtouch::SoundTouch* snd_touch = nullptr;
 
-  void set_semitones();
-  void set_sequence_length();
-  void set_seek_window();
-  void set_overlap_length();
-  void set_quick_seek();
-  void set_anti_alias();
-  void set_tempo_difference();
-  void set_rate_difference();
+  /**
+   * Changing the SoundTouch processing settings reallocates its buffers. The
+   * worker builds a new instance with them and the realtime thread swaps it in
+   * at the beginning of the next cycle. The replaced instance is deleted by the
+   * worker before it publishes another one and once more after retire_delay.
+   */
+  std::atomic<soundtouch::SoundTouch*> snd_touch_pending = nullptr;
+  std::atomic<soundtouch::SoundTouch*> snd_touch_retired = nullptr;
+
+  static constexpr auto retire_delay = std::chrono::seconds(1);
+
+  /**
+   * Pitch, tempo and rate only change SoundTouch's ratios. They are published
+   * by the GUI thread as immutable snapshots and applied by the realtime thread.
+   */
+  struct Parameters {
+    double semitones = 0.0;
+    double tempo_difference = 0.0;
+    double rate_difference = 0.0;
+  };
+
+  rt::Snapshot<Parameters> parameters;
+
+  Parameters applied_parameters;
+
+  [[nodiscard]] auto make_parameters() const -> Parameters;
+
+  [[nodiscard]] auto create_soundtouch() const -> soundtouch::SoundTouch*;
+
+  void publish_parameters();
+
+  void apply_parameters(const Parameters& p, const bool& force);
+
+  void rebuild_soundtouch();
+
+  void delete_soundtouch_instances();
+
   void init_soundtouch();
 };
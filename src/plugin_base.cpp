@@ -28,6 +28,8 @@
 #include <qobjectdefs.h>
 #include <qthread.h>
 #include <qtimer.h>
+#include <qtypes.h>
+#include <qvariant.h>
 #include <spa/node/io.h>
 #include <spa/param/latency-utils.h>
 #include <spa/param/latency.h>
@@ -43,6 +45,7 @@
 #include <QString>
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <cstddef>
@@ -53,8 +56,11 @@
 #include <thread>
 #include <utility>
 #include "db_manager.hpp"
+#include "dsp_profiler.hpp"
+#include "lv2_wrapper.hpp"
 #include "pipeline_type.hpp"
 #include "pw_manager.hpp"
+#include "rt_checks.hpp"
 #include "tags_app.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
@@ -71,35 +77,16 @@ void on_process(void* userdata, spa_io_position* position) {
     return;
   }
 
-  // We had to add the following checks for dummy array sizes. See #4085
-  if (d->pb->dummy_left.size() != n_samples) {
-    d->pb->dummy_left.resize(n_samples);
+  rt::checks::Scope rt_checks_scope(d->pb->name);
 
-    std::ranges::fill(d->pb->dummy_left, 0.0F);
-  }
-
-  if (d->pb->dummy_right.size() != n_samples) {
-    d->pb->dummy_right.resize(n_samples);
-
-    std::ranges::fill(d->pb->dummy_right, 0.0F);
-  }
-
-  if (DbMain::copyFilterInputBuffers() && d->pb->copy_left_in.size() != n_samples) {
-    d->pb->copy_left_in.resize(n_samples);
-    d->pb->copy_right_in.resize(n_samples);
-  }
-
-  if (rate != d->pb->rate || n_samples != d->pb->n_samples) {
-    d->pb->rate = rate;
-    d->pb->n_samples = n_samples;
+  const auto copy_input = d->pb->copy_input_buffers.load(std::memory_order_relaxed);
 
-    d->pb->got_null_left_in = false;
-    d->pb->got_null_left_out = false;
-    d->pb->got_null_right_in = false;
-    d->pb->got_null_right_out = false;
-    d->pb->got_null_probe = false;
+  if ((rate != d->pb->rt_rate || n_samples != d->pb->rt_n_samples) &&
+      !d->pb->quantum_change_pending.load(std::memory_order_acquire)) {
+    d->pb->rt_rate = rate;
+    d->pb->rt_n_samples = n_samples;
 
-    d->pb->setup();
+    d->pb->request_quantum_change(rate, n_samples);
   }
 
   // util::warning("Processing: " + util::to_string(n_samples));
@@ -110,6 +97,26 @@ void on_process(void* userdata, spa_io_position* position) {
   auto* out_left = static_cast<float*>(pw_filter_get_dsp_buffer(d->out_left, n_samples));
   auto* out_right = static_cast<float*>(pw_filter_get_dsp_buffer(d->out_right, n_samples));
 
+  if (d->pb->quantum_change_pending.load(std::memory_order_acquire)) {
+    // The plugin is not set up for this quantum yet. The audio passes through until it is.
+
+    if (in_left != nullptr && out_left != nullptr) {
+      std::copy_n(in_left, n_samples, out_left);
+    }
+
+    if (in_right != nullptr && out_right != nullptr) {
+      std::copy_n(in_right, n_samples, out_right);
+    }
+
+    return;
+  }
+
+  // The scratch buffers have at least n_samples elements after set_quantum. See #4085
+  auto dummy_left = std::span(d->pb->dummy_left.data(), n_samples);
+  auto dummy_right = std::span(d->pb->dummy_right.data(), n_samples);
+  auto copy_left_in = std::span(d->pb->copy_left_in.data(), n_samples);
+  auto copy_right_in = std::span(d->pb->copy_right_in.data(), n_samples);
+
   std::span<float> left_in;
   std::span<float> right_in;
   std::span<float> left_out;
@@ -118,8 +125,8 @@ void on_process(void* userdata, spa_io_position* position) {
   if (in_left != nullptr) {
     left_in = std::span(in_left, n_samples);
 
-    if (DbMain::copyFilterInputBuffers()) {
-      std::ranges::copy(left_in, d->pb->copy_left_in.begin());
+    if (copy_input) {
+      std::ranges::copy(left_in, copy_left_in.begin());
     }
 
   } else {
@@ -129,16 +136,16 @@ void on_process(void* userdata, spa_io_position* position) {
       d->pb->got_null_left_in = true;
     }
 
-    std::ranges::fill(d->pb->dummy_left, 0.0F);
+    std::ranges::fill(dummy_left, 0.0F);
 
-    left_in = d->pb->dummy_left;
+    left_in = dummy_left;
   }
 
   if (in_right != nullptr) {
     right_in = std::span(in_right, n_samples);
 
-    if (DbMain::copyFilterInputBuffers()) {
-      std::ranges::copy(right_in, d->pb->copy_right_in.begin());
+    if (copy_input) {
+      std::ranges::copy(right_in, copy_right_in.begin());
     }
 
   } else {
@@ -148,9 +155,9 @@ void on_process(void* userdata, spa_io_position* position) {
       d->pb->got_null_right_in = true;
     }
 
-    std::ranges::fill(d->pb->dummy_right, 0.0F);
+    std::ranges::fill(dummy_right, 0.0F);
 
-    right_in = d->pb->dummy_right;
+    right_in = dummy_right;
   }
 
   if (out_left != nullptr) {
@@ -162,9 +169,9 @@ void on_process(void* userdata, spa_io_position* position) {
       d->pb->got_null_left_out = true;
     }
 
-    std::ranges::fill(d->pb->dummy_left, 0.0F);
+    std::ranges::fill(dummy_left, 0.0F);
 
-    left_out = d->pb->dummy_left;
+    left_out = dummy_left;
   }
 
   if (out_right != nullptr) {
@@ -176,19 +183,18 @@ void on_process(void* userdata, spa_io_position* position) {
       d->pb->got_null_right_out = true;
     }
 
-    std::ranges::fill(d->pb->dummy_right, 0.0F);
+    std::ranges::fill(dummy_right, 0.0F);
 
-    right_out = d->pb->dummy_right;
+    right_out = dummy_right;
   }
 
-  if (!d->pb->enable_probe) {
-    if (DbMain::copyFilterInputBuffers()) {
-      auto copy_left_in = std::span(d->pb->copy_left_in);
-      auto copy_right_in = std::span(d->pb->copy_right_in);
+  DspProfiler::Scope profiler_scope(d->pb->dsp_profiler, n_samples, rate);
 
-      d->pb->process(copy_left_in, copy_right_in, left_out, right_out);
+  if (!d->pb->enable_probe) {
+    if (copy_input) {
+      d->pb->run(copy_left_in, copy_right_in, left_out, right_out);
     } else {
-      d->pb->process(left_in, right_in, left_out, right_out);
+      d->pb->run(left_in, right_in, left_out, right_out);
     }
 
   } else {
@@ -202,32 +208,26 @@ void on_process(void* userdata, spa_io_position* position) {
         d->pb->got_null_probe = true;
       }
 
-      std::ranges::fill(d->pb->dummy_left, 0.0F);
-      std::ranges::fill(d->pb->dummy_right, 0.0F);
+      std::ranges::fill(dummy_left, 0.0F);
+      std::ranges::fill(dummy_right, 0.0F);
 
-      std::span l(d->pb->dummy_left.data(), n_samples);
-      std::span r(d->pb->dummy_right.data(), n_samples);
+      std::span l(dummy_left);
+      std::span r(dummy_right);
 
-      if (DbMain::copyFilterInputBuffers()) {
-        auto copy_left_in = std::span(d->pb->copy_left_in);
-        auto copy_right_in = std::span(d->pb->copy_right_in);
-
-        d->pb->process(copy_left_in, copy_right_in, left_out, right_out, l, r);
+      if (copy_input) {
+        d->pb->run(copy_left_in, copy_right_in, left_out, right_out, l, r);
       } else {
-        d->pb->process(left_in, right_in, left_out, right_out, l, r);
+        d->pb->run(left_in, right_in, left_out, right_out, l, r);
       }
 
     } else {
       std::span l(probe_left, n_samples);
       std::span r(probe_right, n_samples);
 
-      if (DbMain::copyFilterInputBuffers()) {
-        auto copy_left_in = std::span(d->pb->copy_left_in);
-        auto copy_right_in = std::span(d->pb->copy_right_in);
-
-        d->pb->process(copy_left_in, copy_right_in, left_out, right_out, l, r);
+      if (copy_input) {
+        d->pb->run(copy_left_in, copy_right_in, left_out, right_out, l, r);
       } else {
-        d->pb->process(left_in, right_in, left_out, right_out, l, r);
+        d->pb->run(left_in, right_in, left_out, right_out, l, r);
       }
     }
   }
@@ -258,6 +258,30 @@ auto update_filter([[maybe_unused]] struct spa_loop* loop,
   return 0;
 }
 
+auto apply_quantum([[maybe_unused]] struct spa_loop* loop,
+                   [[maybe_unused]] bool async,
+                   [[maybe_unused]] uint32_t seq,
+                   [[maybe_unused]] const void* data,
+                   [[maybe_unused]] size_t size,
+                   void* user_data) -> int {
+  auto* self = static_cast<PluginBase*>(user_data);
+
+  self->set_quantum(self->requested_rate, self->requested_n_samples);
+
+  self->quantum_change_pending.store(false, std::memory_order_release);
+
+  return 0;
+}
+
+auto flush_loop([[maybe_unused]] struct spa_loop* loop,
+                [[maybe_unused]] bool async,
+                [[maybe_unused]] uint32_t seq,
+                [[maybe_unused]] const void* data,
+                [[maybe_unused]] size_t size,
+                [[maybe_unused]] void* user_data) -> int {
+  return 0;
+}
+
 void on_filter_state_changed(void* userdata,
                              [[maybe_unused]] pw_filter_state old,
                              pw_filter_state state,
@@ -328,16 +352,90 @@ PluginBase::PluginBase(std::string tag,
       break;
   }
 
-  if (name != "output_level" && name != "spectrum") {
+  if (name != "output_level" && name != "spectrum" && name != "effects_chain") {
     description = tags::plugin_name::Model::self().translate(name) + " " + description_pipeline;
   } else if (name == "output_level") {
     description = i18n("Output Level Meter");
   } else if (name == "spectrum") {
     description = i18n("Spectrum");
+  } else if (name == "effects_chain") {
+    description = i18n("Effects Chain") + " " + description_pipeline;
+  }
+
+  /**
+   * The analysis plugins only measure their input. Their meters have to see
+   * the silence, so they never skip it. The effects chain checks each of its
+   * plugins.
+   */
+  if (name == "output_level" || name == "spectrum" || name == "effects_chain" ||
+      name == tags::plugin_name::BaseName::levelMeter) {
+    tail_seconds = -1.0F;
   }
 
   pf_data.pb = this;
 
+  /**
+   * The realtime thread never resizes these buffers. They only have to grow
+   * when PipeWire uses a quantum larger than the one we allow for LV2 plugins.
+   */
+  for (auto* v : {&dummy_left, &dummy_right, &copy_left_in, &copy_right_in, &dry_left, &dry_right}) {
+    v->resize(lv2::Lv2Wrapper::max_quantum, 0.0F);
+  }
+
+  if (pm != nullptr) {
+    create_filter(description);
+  }
+
+  copy_input_buffers = DbMain::copyFilterInputBuffers();
+
+  connect(DbMain::self(), &DbMain::copyFilterInputBuffersChanged, this,
+          [&]() { copy_input_buffers = DbMain::copyFilterInputBuffers(); });
+
+  skip_silent_input = DbMain::skipSilentInput();
+
+  connect(DbMain::self(), &DbMain::skipSilentInputChanged, this,
+          [&]() { skip_silent_input = DbMain::skipSilentInput(); });
+
+  native_ui_timer->setInterval(static_cast<long>(1000.0 / DbMain::lv2uiUpdateFrequency()));
+
+  connect(native_ui_timer, &QTimer::timeout, this, [&]() {
+    if (!connected_to_pw || lv2_wrapper == nullptr || !lv2_wrapper->has_ui()) {
+      return;
+    }
+
+    lv2_wrapper->notify_ui();
+    lv2_wrapper->update_ui();
+  });
+
+  // worker thread for the native ui and maybe also other things
+
+  baseWorker->moveToThread(&workerThread);
+
+  workerThread.start();
+
+  connect(&workerThread, &QThread::finished, baseWorker, &QObject::deleteLater);
+}
+
+PluginBase::~PluginBase() {
+  if (filter != nullptr) {
+    pm->lock();
+
+    if (listener.link.next != nullptr || listener.link.prev != nullptr) {
+      spa_hook_remove(&listener);
+    }
+
+    pw_filter_destroy(filter);
+
+    pm->sync_wait_unlock();
+
+    // Quantum changes and latency updates may still be queued with a pointer to this object
+    pw_loop_invoke(pw_thread_loop_get_loop(pm->thread_loop), flush_loop, 1, nullptr, 0, true, this);  // NOLINT
+  }
+
+  stop_worker();
+}
+
+void PluginBase::create_filter(const QString& description) {
   const auto filter_name = "ee_" + log_tag.substr(0U, log_tag.size() - 2U) + "_" + name.toStdString();
 
   pm->lock();
@@ -427,39 +525,11 @@ PluginBase::PluginBase(std::string tag,
   }
 
   pm->sync_wait_unlock();
-
-  native_ui_timer->setInterval(static_cast<long>(1000.0 / DbMain::lv2uiUpdateFrequency()));
-
-  connect(native_ui_timer, &QTimer::timeout, this, [&]() {
-    if (!connected_to_pw || lv2_wrapper == nullptr || !lv2_wrapper->has_ui()) {
-      return;
-    }
-
-    lv2_wrapper->notify_ui();
-    lv2_wrapper->update_ui();
-  });
-
-  // worker thread for the native ui and maybe also other things
-
-  baseWorker->moveToThread(&workerThread);
-
-  workerThread.start();
-
-  connect(&workerThread, &QThread::finished, baseWorker, &QObject::deleteLater);
 }
 
-PluginBase::~PluginBase() {
-  pm->lock();
-
-  if (listener.link.next != nullptr || listener.link.prev != nullptr) {
-    spa_hook_remove(&listener);
-  }
-
-  pw_filter_destroy(filter);
-
-  pm->sync_wait_unlock();
-
-  stop_worker();
+void PluginBase::wait_for_worker() {
+  // The worker runs the queued jobs in order. When this one returns the previous ones are done.
+  QMetaObject::invokeMethod(baseWorker, [] {}, Qt::BlockingQueuedConnection);
 }
 
 void PluginBase::stop_worker() {
@@ -476,6 +546,12 @@ auto PluginBase::connect_to_pw() -> bool {
   can_get_node_id = false;
   state = PW_FILTER_STATE_UNCONNECTED;
 
+  if (filter == nullptr) {
+    util::warning(std::format("{}{} has no PipeWire filter to connect", log_tag, name.toStdString()));
+
+    return false;
+  }
+
   pm->lock();
 
   if (pw_filter_connect(filter, PW_FILTER_FLAG_RT_PROCESS, nullptr, 0) != 0) {
@@ -528,6 +604,10 @@ auto PluginBase::get_node_id() const -> uint {
 }
 
 void PluginBase::set_active(const bool& state) const {
+  if (filter == nullptr) {
+    return;
+  }
+
   pw_filter_set_active(filter, state);
 }
 
@@ -538,6 +618,10 @@ void PluginBase::set_node_passive(const std::string& value) const {
 
   struct spa_dict dict = SPA_DICT_INIT(items, 1);
 
+  if (filter == nullptr) {
+    return;
+  }
+
   pm->lock();
 
   pw_filter_update_properties(filter, nullptr, &dict);
@@ -552,6 +636,10 @@ void PluginBase::set_node_group(const std::string& value) const {
 
   struct spa_dict dict = SPA_DICT_INIT(items, 1);
 
+  if (filter == nullptr) {
+    return;
+  }
+
   pm->lock();
 
   pw_filter_update_properties(filter, nullptr, &dict);
@@ -562,6 +650,10 @@ void PluginBase::set_node_group(const std::string& value) const {
 void PluginBase::disconnect_from_pw() {
   native_ui_timer->stop();
 
+  if (filter == nullptr) {
+    return;
+  }
+
   pm->lock();
 
   set_active(false);
@@ -586,6 +678,172 @@ void PluginBase::disconnect_from_pw() {
   util::debug(std::format("{}{} is disconnected", log_tag, name.toStdString()));
 }
 
+void PluginBase::request_quantum_change(const uint& new_rate, const uint& new_n_samples) {
+  requested_rate = new_rate;
+  requested_n_samples = new_n_samples;
+
+  quantum_change_pending.store(true, std::memory_order_release);
+
+  [[maybe_unused]] rt::checks::Allow allow_invoke;
+
+  pw_loop_invoke(pw_thread_loop_get_loop(pm->thread_loop), apply_quantum, 1, nullptr, 0, false, this);  // NOLINT
+}
+
+void PluginBase::set_quantum(const uint& new_rate, const uint& new_n_samples) {
+  rate = new_rate;
+  n_samples = new_n_samples;
+
+  if (dummy_left.size() < n_samples) {
+    for (auto* v : {&dummy_left, &dummy_right, &copy_left_in, &copy_right_in, &dry_left, &dry_right}) {
+      v->resize(n_samples, 0.0F);
+    }
+  }
+
+  got_null_left_in = false;
+  got_null_left_out = false;
+  got_null_right_in = false;
+  got_null_right_out = false;
+  got_null_probe = false;
+
+  // The old measurements were taken with a different budget
+  dsp_profiler.reset();
+
+  setup();
+}
+
+void PluginBase::run(std::span<float>& left_in,
+                     std::span<float>& right_in,
+                     std::span<float>& left_out,
+                     std::span<float>& right_out) {
+  if (skip_silence(left_in, right_in, left_out, right_out)) {
+    // The output is silent either way. There is nothing to fade.
+    last_bypass = bypass_requested.load(std::memory_order_relaxed);
+    bypass_mix = last_bypass ? 0.0F : 1.0F;
+
+    bypass.store(last_bypass, std::memory_order_relaxed);
+
+    return;
+  }
+
+  const auto fading = begin_bypass_fade(left_in, right_in);
+
+  process(left_in, right_in, left_out, right_out);
+
+  if (fading) {
+    end_bypass_fade(left_out, right_out);
+  }
+}
+
+void PluginBase::run(std::span<float>& left_in,
+                     std::span<float>& right_in,
+                     std::span<float>& left_out,
+                     std::span<float>& right_out,
+                     std::span<float>& probe_left,
+                     std::span<float>& probe_right) {
+  const auto fading = begin_bypass_fade(left_in, right_in);
+
+  process(left_in, right_in, left_out, right_out, probe_left, probe_right);
+
+  if (fading) {
+    end_bypass_fade(left_out, right_out);
+  }
+}
+
+auto PluginBase::begin_bypass_fade(const std::span<float>& left_in, const std::span<float>& right_in) -> bool {
+  const auto requested = bypass_requested.load(std::memory_order_relaxed);
+
+  if (requested != last_bypass) {
+    last_bypass = requested;
+
+    // The plugin has to run while its output fades in
+    if (!requested) {
+      bypass.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  const auto target = last_bypass ? 0.0F : 1.0F;
+
+  if (bypass_mix == target) {
+    return false;
+  }
+
+  if (dry_left.size() < left_in.size() || dry_right.size() < right_in.size()) {
+    // Not set up for this quantum yet
+    bypass_mix = target;
+
+    bypass.store(last_bypass, std::memory_order_relaxed);
+
+    return false;
+  }
+
+  // process() may change its input buffers in place
+  std::ranges::copy(left_in, dry_left.begin());
+  std::ranges::copy(right_in, dry_right.begin());
+
+  return true;
+}
+
+void PluginBase::end_bypass_fade(std::span<float>& left_out, std::span<float>& right_out) {
+  const auto target = last_bypass ? 0.0F : 1.0F;
+
+  const auto step = 1.0F / std::max(1.0F, bypass_fade_seconds * static_cast<float>(rate));
+
+  for (size_t n = 0U; n < left_out.size() && n < right_out.size(); n++) {
+    bypass_mix = target > bypass_mix ? std::min(bypass_mix + step, target) : std::max(bypass_mix - step, target);
+
+    left_out[n] = dry_left[n] + (bypass_mix * (left_out[n] - dry_left[n]));
+    right_out[n] = dry_right[n] + (bypass_mix * (right_out[n] - dry_right[n]));
+  }
+
+  if (bypass_mix == target && last_bypass) {
+    bypass.store(true, std::memory_order_relaxed);
+  }
+}
+
+auto PluginBase::skip_silence(const std::span<float>& left_in,
+                              const std::span<float>& right_in,
+                              std::span<float>& left_out,
+                              std::span<float>& right_out) -> bool {
+  const auto tail = tail_seconds.load(std::memory_order_relaxed);
+
+  if (tail < 0.0F || !skip_silent_input.load(std::memory_order_relaxed)) {
+    silent_frames = 0U;
+
+    return false;
+  }
+
+  // Same threshold used by RNNoise. The scan stops at the first audible sample.
+  constexpr auto eps = 1e-6F;
+
+  const auto is_silent = [](const float& v) { return std::fabs(v) <= eps; };
+
+  if (!std::ranges::all_of(left_in, is_silent) || !std::ranges::all_of(right_in, is_silent)) {
+    silent_frames = 0U;
+
+    return false;
+  }
+
+  silent_frames += left_in.size();
+
+  const auto tail_frames = static_cast<uint64_t>((tail + latency_value) * static_cast<float>(rate));
+
+  if (silent_frames <= tail_frames) {
+    return false;
+  }
+
+  std::ranges::fill(left_out, 0.0F);
+  std::ranges::fill(right_out, 0.0F);
+
+  if (updateLevelMeters) {
+    input_peak_left = util::minimum_db_level;
+    input_peak_right = util::minimum_db_level;
+    output_peak_left = util::minimum_db_level;
+    output_peak_right = util::minimum_db_level;
+  }
+
+  return true;
+}
+
 void PluginBase::clear_data() {}
 
 void PluginBase::setup() {}
@@ -689,6 +947,13 @@ void PluginBase::apply_gain(std::span<float>& left, std::span<float>& right, con
 void PluginBase::update_probe_links() {}
 
 void PluginBase::update_filter_params() {
+  if (filter == nullptr) {
+    // Offline mode. There is no node whose latency has to be updated.
+    return;
+  }
+
+  [[maybe_unused]] rt::checks::Allow allow_invoke;
+
   pw_loop_invoke(pw_thread_loop_get_loop(pm->thread_loop), update_filter, 1, nullptr, 0, false, this);  // NOLINT
 }
 
@@ -711,3 +976,20 @@ float PluginBase::getOutputLevelRight() const {
 bool PluginBase::hasNativeUi() {
   return lv2_wrapper->has_ui();
 }
+
+QVariantMap PluginBase::getDspStats() const {
+  const auto stats = dsp_profiler.get_stats();
+
+  return {{"count", static_cast<qulonglong>(stats.count)},
+          {"p50", stats.p50_ms},
+          {"p99", stats.p99_ms},
+          {"max", stats.max_ms},
+          {"budget", stats.budget_ms},
+          {"loadP50", stats.load_p50},
+          {"loadP99", stats.load_p99},
+          {"loadMax", stats.load_max}};
+}
+
+void PluginBase::resetDspStats() {
+  dsp_profiler.reset();
+}
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <pipewire/filter.h>
+#include <qcontainerfwd.h>
 #include <qobject.h>
 #include <qthread.h>
 #include <qtmetamacros.h>
@@ -27,14 +28,17 @@
 #include <sys/types.h>
 #include <QTimer>
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <span>
 #include <string>
 #include <vector>
+#include "dsp_profiler.hpp"
 #include "lv2_wrapper.hpp"
 #include "pipeline_type.hpp"
 #include "pw_manager.hpp"
+#include "rt_sync.hpp"
 #include "util.hpp"
 
 class PluginBaseWorker : public QObject {
@@ -48,6 +52,11 @@ class PluginBase : public QObject {
   Q_PROPERTY(bool packageInstalled MEMBER packageInstalled NOTIFY packageInstalledChanged)
 
  public:
+  /**
+   * When pipe_manager is nullptr no PipeWire filter is created. The plugin can
+   * then only be driven directly through set_quantum() and process(), as done
+   * by the offline renderer.
+   */
   PluginBase(std::string tag,
              QString plugin_name,
              QString plugin_package,
@@ -100,8 +109,16 @@ class PluginBase : public QObject {
 
   bool packageInstalled = true;
 
+  /**
+   * Bypass state seen by process(). For the plugins using the common controls
+   * it follows bypass_requested once the realtime thread has faded between the
+   * processed and the dry signal.
+   */
   std::atomic<bool> bypass = {false};
 
+  // Bypass state chosen by the user
+  std::atomic<bool> bypass_requested = {false};
+
   bool connected_to_pw = false;
 
   float latency_value = 0.0F;  // seconds
@@ -123,8 +140,46 @@ class PluginBase : public QObject {
 
   bool updateLevelMeters = false;
 
+  // Mirror of DbMain::copyFilterInputBuffers read by the realtime thread
+  std::atomic<bool> copy_input_buffers = {false};
+
+  // Mirror of DbMain::skipSilentInput read by the realtime thread
+  std::atomic<bool> skip_silent_input = {true};
+
+  /**
+   * For how long the plugin may still produce sound after its input becomes
+   * silent, in seconds. Plugins with long tails like reverbs, convolvers and
+   * delays update it. A negative value means process() is never skipped.
+   */
+  std::atomic<float> tail_seconds = {1.0F};
+
+  /**
+   * Sampling rate the plugin works at internally. Zero when it works at any
+   * rate. In a fused effects chain adjacent plugins with the same native rate
+   * run together at that rate, so the signal is converted only once on the
+   * way in and once on the way out.
+   */
+  uint native_rate = 0U;
+
   std::vector<float> dummy_left, dummy_right, copy_left_in, copy_right_in;
 
+  // Time spent in process() by the realtime thread
+  DspProfiler dsp_profiler;
+
+  // Last quantum seen by the realtime thread
+  uint rt_rate = 0U;
+  uint rt_n_samples = 0U;
+
+  /**
+   * Set by the realtime thread when the quantum changes. While it is set the
+   * audio passes through and the PipeWire main loop runs set_quantum with
+   * the requested values. Cleared when setup() returns.
+   */
+  std::atomic<bool> quantum_change_pending = {false};
+
+  uint requested_rate = 0U;
+  uint requested_n_samples = 0U;
+
   [[nodiscard]] auto get_node_id() const -> uint;
 
   void set_active(const bool& state) const;
@@ -137,8 +192,54 @@ class PluginBase : public QObject {
 
   void disconnect_from_pw();
 
+  /**
+   * Blocks until the jobs queued on the worker thread so far are finished.
+   * The offline renderer uses it to wait for the plugins to be ready before
+   * feeding them audio. It must not be called from the worker thread.
+   */
+  void wait_for_worker();
+
   void set_native_ui_update_frequency(const uint& value);
 
+  /**
+   * Updates the sampling rate and the block size and calls setup(). When
+   * PipeWire changes the quantum the realtime thread requests it through
+   * request_quantum_change and it runs in the PipeWire main loop. The effects
+   * chain node also uses it to forward the quantum to the plugins it runs.
+   */
+  void set_quantum(const uint& new_rate, const uint& new_n_samples);
+
+  // Called by the realtime thread. It does not allocate nor block.
+  void request_quantum_change(const uint& new_rate, const uint& new_n_samples);
+
+  /**
+   * Called by the realtime thread before process(). Returns true when the
+   * input has been silent for longer than the tail plus the latency of the
+   * plugin. In this case the output is filled with zeros and process() does
+   * not have to be called.
+   */
+  auto skip_silence(const std::span<float>& left_in,
+                    const std::span<float>& right_in,
+                    std::span<float>& left_out,
+                    std::span<float>& right_out) -> bool;
+
+  /**
+   * Called by the realtime thread instead of process(). When bypass_requested
+   * changes the output is crossfaded between the dry and the processed signal
+   * over a few milliseconds. Only then bypass is updated.
+   */
+  void run(std::span<float>& left_in,
+           std::span<float>& right_in,
+           std::span<float>& left_out,
+           std::span<float>& right_out);
+
+  void run(std::span<float>& left_in,
+           std::span<float>& right_in,
+           std::span<float>& left_out,
+           std::span<float>& right_out,
+           std::span<float>& probe_left,
+           std::span<float>& probe_right);
+
   virtual void clear_data();
 
   virtual void setup();
@@ -175,13 +276,27 @@ class PluginBase : public QObject {
 
   Q_INVOKABLE bool hasNativeUi();
 
+  Q_INVOKABLE [[nodiscard]] QVariantMap getDspStats() const;
+
+  Q_INVOKABLE void resetDspStats();
+
  Q_SIGNALS:
 
   void updateLevelMetersChanged();
   void packageInstalledChanged();
+  void bypassChanged();
 
  protected:
-  std::mutex data_mutex;
+  /**
+   * Non realtime threads lock it with std::scoped_lock. The realtime thread
+   * only uses std::shared_lock with std::try_to_lock in process() and passes
+   * the audio through when the lock is not acquired. See rt_sync.hpp.
+   *
+   * Only structural changes (setup, clear_data, instance creation and
+   * destruction) should take it. Control changes go through atomics
+   * (rt_macros.hpp), snapshots or instances swapped in by process().
+   */
+  rt::DataMutex data_mutex;
 
   pw::Manager* pm = nullptr;
 
@@ -211,13 +326,22 @@ class PluginBase : public QObject {
 
   void stop_worker();
 
+  void create_filter(const QString& description);
+
   template <typename dbClass>
   void init_common_controls(dbClass* settings) {
     bypass = settings->bypass();
+    bypass_requested = settings->bypass();
+    last_bypass = bypass;
+    bypass_mix = bypass ? 0.0F : 1.0F;
     input_gain = util::db_to_linear(settings->inputGain());
     output_gain = util::db_to_linear(settings->outputGain());
 
-    connect(settings, &dbClass::bypassChanged, [&, settings]() { bypass = settings->bypass(); });
+    connect(settings, &dbClass::bypassChanged, [&, settings]() {
+      bypass_requested = settings->bypass();
+
+      Q_EMIT bypassChanged();
+    });
     connect(settings, &dbClass::inputGainChanged,
             [&, settings]() { input_gain = util::db_to_linear(settings->inputGain()); });
     connect(settings, &dbClass::outputGainChanged,
@@ -227,5 +351,21 @@ class PluginBase : public QObject {
  private:
   uint node_id = 0U;
 
+  static constexpr float bypass_fade_seconds = 0.005F;
+
+  // Last bypass request seen by the realtime thread
+  bool last_bypass = false;
+
+  // Weight of the processed signal in the output. Only used by the realtime thread.
+  float bypass_mix = 1.0F;
+
+  uint64_t silent_frames = 0U;
+
+  std::vector<float> dry_left, dry_right;
+
+  auto begin_bypass_fade(const std::span<float>& left_in, const std::span<float>& right_in) -> bool;
+
+  void end_bypass_fade(std::span<float>& left_out, std::span<float>& right_out);
+
   QTimer* native_ui_timer = nullptr;
 };
@@ -0,0 +1,276 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "plugin_benchmark.hpp"
+#include <qcontainerfwd.h>
+#include <sys/types.h>
+#include <QCoreApplication>
+#include <QString>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+#include "db_manager.hpp"
+#include "easyeffects_db_convolver.h"
+#include "easyeffects_db_streamoutputs.h"
+#include "effects_base.hpp"
+#include "pipeline_type.hpp"
+#include "plugin_base.hpp"
+#include "rt_checks.hpp"
+#include "spectrum.hpp"
+#include "tags_plugin_name.hpp"
+#include "util.hpp"
+
+PluginBenchmark::PluginBenchmark() {
+  // The plugins databases created for the benchmark must not be saved
+  db::Manager::self().setReadOnly(true);
+}
+
+void PluginBenchmark::set_impulse_file(const std::filesystem::path& path) {
+  impulse_file = std::filesystem::absolute(path);
+}
+
+void PluginBenchmark::set_plugins_filter(const QStringList& list) {
+  plugins_filter = list;
+}
+
+void PluginBenchmark::set_duration(const double& seconds) {
+  duration = seconds;
+}
+
+void PluginBenchmark::prepare_database(const QStringList& names) {
+  QStringList list;
+
+  for (const auto& name : names) {
+    list.append(name + "#0");
+  }
+
+  // The plugins databases are created when the pipeline list changes
+  DbStreamOutputs::setPlugins(list);
+
+  if (auto* convolver = db::Manager::self().get_plugin_db<DbConvolver>(
+          PipelineType::output, tags::plugin_name::BaseName::convolver + "#0");
+      convolver != nullptr) {
+    convolver->setKernelName(QString::fromStdString(impulse_file.string()));
+  }
+}
+
+void PluginBenchmark::generate_input(const uint& n_samples) {
+  for (auto* v : {&left_in, &right_in, &left_out, &right_out, &probe_left, &probe_right}) {
+    v->resize(n_samples);
+  }
+
+  // White noise at -6 dBFS peak. The same seed is used in every run.
+  std::mt19937 generator(1234U);
+  std::uniform_real_distribution<float> distribution(-0.5F, 0.5F);
+
+  for (uint n = 0U; n < n_samples; n++) {
+    left_in[n] = distribution(generator);
+    right_in[n] = distribution(generator);
+    probe_left[n] = distribution(generator);
+    probe_right[n] = distribution(generator);
+  }
+}
+
+auto PluginBenchmark::measure(PluginBase* plugin, const QString& name, const uint& rate, const uint& n_samples)
+    -> Result {
+  plugin->set_quantum(rate, n_samples);
+
+  // Same as in the offline renderer. Let the asynchronous initialization finish.
+  for (int n = 0; n < 2; n++) {
+    plugin->wait_for_worker();
+
+    QCoreApplication::processEvents();
+  }
+
+  generate_input(n_samples);
+
+  std::vector<float> l(left_in), r(right_in), pl(probe_left), pr(probe_right);
+
+  std::span<float> l_in(l);
+  std::span<float> r_in(r);
+  std::span<float> l_out(left_out);
+  std::span<float> r_out(right_out);
+  std::span<float> p_left(pl);
+  std::span<float> p_right(pr);
+
+  uint64_t n_allocations = 0U;
+
+  auto run_block = [&]() {
+    // Some plugins change their input buffers
+    std::ranges::copy(left_in, l.begin());
+    std::ranges::copy(right_in, r.begin());
+    std::ranges::copy(probe_left, pl.begin());
+    std::ranges::copy(probe_right, pr.begin());
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto allocations = rt::checks::allocation_count();
+
+    if (plugin->enable_probe) {
+      plugin->process(l_in, r_in, l_out, r_out, p_left, p_right);
+    } else {
+      plugin->process(l_in, r_in, l_out, r_out);
+    }
+
+    n_allocations += rt::checks::allocation_count() - allocations;
+
+    return std::chrono::steady_clock::now() - start;
+  };
+
+  // Warming up caches, internal buffers and lazily initialized states
+  for (uint n = 0U; n < 8U; n++) {
+    run_block();
+  }
+
+  Result result;
+
+  result.plugin = name.toStdString();
+  result.rate = rate;
+  result.n_samples = n_samples;
+  const auto n_blocks = std::ceil(duration * static_cast<double>(rate) / static_cast<double>(n_samples));
+
+  result.blocks = std::max(16U, static_cast<uint>(n_blocks));
+
+  n_allocations = 0U;
+
+  std::chrono::steady_clock::duration elapsed{};
+
+  for (uint n = 0U; n < result.blocks; n++) {
+    elapsed += run_block();
+  }
+
+  result.allocations = n_allocations;
+
+  const auto total_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+  const auto total_samples = static_cast<double>(result.blocks) * static_cast<double>(n_samples);
+
+  result.ns_per_sample = total_ns / total_samples;
+  result.load = total_ns / (total_samples * 1.0e9 / static_cast<double>(rate));
+
+  return result;
+}
+
+auto PluginBenchmark::run() -> std::vector<Result> {
+  QStringList names;
+
+  for (const auto& name : tags::plugin_name::Model::self().getBaseNames()) {
+    if (plugins_filter.isEmpty() || plugins_filter.contains(name)) {
+      names.append(name);
+    }
+  }
+
+  names.sort();
+
+  prepare_database(names);
+
+  if (plugins_filter.isEmpty() || plugins_filter.contains("spectrum")) {
+    names.append("spectrum");
+  }
+
+  std::vector<Result> results;
+
+  for (const auto& name : names) {
+    if (name == tags::plugin_name::BaseName::convolver && impulse_file.empty()) {
+      util::warning(std::format("{}no impulse file was given. Skipping the convolver", log_tag));
+
+      continue;
+    }
+
+    for (const auto& rate : rates) {
+      // A new instance for each rate. This is what happens when PipeWire changes the rate.
+
+      std::unique_ptr<PluginBase> plugin;
+
+      if (name == "spectrum") {
+        plugin = std::make_unique<Spectrum>(log_tag, nullptr, PipelineType::output, "0");
+      } else {
+        plugin = EffectsBase::create_plugin(name + "#0", log_tag, nullptr, PipelineType::output);
+      }
+
+      if (plugin == nullptr) {
+        break;
+      }
+
+      if (!plugin->packageInstalled) {
+        util::warning(std::format("{}{} is not installed. Skipping it", log_tag, name.toStdString()));
+
+        break;
+      }
+
+      for (const auto& n_samples : quanta) {
+        results.push_back(measure(plugin.get(), name, rate, n_samples));
+
+        util::debug(std::format("{}{} {} Hz {} samples: {:.2f} ns/sample", log_tag, name.toStdString(), rate,
+                                n_samples, results.back().ns_per_sample));
+      }
+    }
+  }
+
+  return results;
+}
+
+void PluginBenchmark::print(const std::vector<Result>& results) {
+  std::cout << std::format("{:<24}{:>8}{:>8}{:>14}{:>10}{:>14}\n", "plugin", "rate", "quantum", "ns/sample",
+                           "load %", "allocations");
+
+  for (const auto& r : results) {
+    std::cout << std::format("{:<24}{:>8}{:>8}{:>14.2f}{:>10.3f}{:>14}\n", r.plugin, r.rate, r.n_samples,
+                             r.ns_per_sample, 100.0 * r.load, r.allocations);
+  }
+}
+
+auto PluginBenchmark::write_json(const std::vector<Result>& results, const std::filesystem::path& path) -> bool {
+  nlohmann::json json = nlohmann::json::array();
+
+  for (const auto& r : results) {
+    json.push_back({{"plugin", r.plugin},
+                    {"rate", r.rate},
+                    {"quantum", r.n_samples},
+                    {"blocks", r.blocks},
+                    {"ns_per_sample", r.ns_per_sample},
+                    {"load", r.load},
+                    {"allocations", r.allocations}});
+  }
+
+  std::ofstream o(path);
+
+  if (!o.is_open()) {
+    util::warning(std::format("failed to open {}", path.string()));
+
+    return false;
+  }
+
+  o << std::setw(2) << json << '\n';
+
+  return true;
+}
@@ -0,0 +1,100 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <qcontainerfwd.h>
+#include <sys/types.h>
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "plugin_base.hpp"
+
+/**
+ * Times process() of every plugin with synthetic input at several quanta and
+ * sampling rates. The plugins are created without PipeWire filters, in the
+ * same way as the offline renderer does. Plugins whose LV2/LADSPA package is
+ * not installed are skipped.
+ *
+ * Only built when ENABLE_BENCHMARKS is set. In this case the allocator
+ * wrappers from rt_checks.cpp count the allocations made by the benchmark
+ * thread while process() runs. The ones made inside LV2, LADSPA and other C
+ * libraries are counted too.
+ */
+class PluginBenchmark {
+ public:
+  struct Result {
+    std::string plugin;
+
+    uint rate = 0U;
+    uint n_samples = 0U;
+    uint blocks = 0U;
+
+    double ns_per_sample = 0.0;
+    double load = 0.0;  // fraction of the quantum budget
+
+    uint64_t allocations = 0U;
+  };
+
+  static constexpr std::array<uint, 3U> rates = {44100U, 48000U, 96000U};
+
+  static constexpr std::array<uint, 9U> quanta = {32U, 64U, 128U, 256U, 512U, 1024U, 2048U, 4096U, 8192U};
+
+  PluginBenchmark();
+  PluginBenchmark(const PluginBenchmark&) = delete;
+  auto operator=(const PluginBenchmark&) -> PluginBenchmark& = delete;
+  PluginBenchmark(const PluginBenchmark&&) = delete;
+  auto operator=(const PluginBenchmark&&) -> PluginBenchmark& = delete;
+  ~PluginBenchmark() = default;
+
+  // Impulse response used by the convolver. Without it the convolver is skipped.
+  void set_impulse_file(const std::filesystem::path& path);
+
+  // Base names of the plugins to run. All of them are run when the list is empty.
+  void set_plugins_filter(const QStringList& list);
+
+  // Amount of audio processed for each measurement
+  void set_duration(const double& seconds);
+
+  auto run() -> std::vector<Result>;
+
+  static void print(const std::vector<Result>& results);
+
+  static auto write_json(const std::vector<Result>& results, const std::filesystem::path& path) -> bool;
+
+ private:
+  const std::string log_tag = "bench: ";
+
+  std::filesystem::path impulse_file;
+
+  QStringList plugins_filter;
+
+  double duration = 1.0;
+
+  std::vector<float> left_in, right_in, left_out, right_out, probe_left, probe_right;
+
+  void prepare_database(const QStringList& names);
+
+  void generate_input(const uint& n_samples);
+
+  auto measure(PluginBase* plugin, const QString& name, const uint& rate, const uint& n_samples) -> Result;
+};
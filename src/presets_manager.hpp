@@ -110,6 +110,8 @@ class Manager : public QObject {
 
   auto get_local_presets_paths(const PipelineType& pipeline_type) -> QList<std::filesystem::path>;
 
+  auto load_preset_file(const PipelineType& pipeline_type, const std::filesystem::path& input_file) -> bool;
+
   Q_INVOKABLE bool add(const PipelineType& pipeline_type, const QString& name);
 
   Q_INVOKABLE bool savePresetFile(const PipelineType& pipeline_type, const QString& name);
@@ -206,8 +208,6 @@ class Manager : public QObject {
                                    const QString& preset_name = "",
                                    const QString& package_name = "");
 
-  auto load_preset_file(const PipelineType& pipeline_type, const std::filesystem::path& input_file) -> bool;
-
   void notify_error(const PresetError& preset_error, const std::string& plugin_name = "");
 
   static auto create_wrapper(const PipelineType& pipeline_type, const QString& filter_name)
@@ -19,20 +19,47 @@
 
 #include "resampler.hpp"
 #include <speex/speex_resampler.h>
+#include <speex/speexdsp_config_types.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
 #include <format>
+#include <span>
+#include "lv2_wrapper.hpp"
 #include "util.hpp"
 
-Resampler::Resampler(const int& input_rate, const int& output_rate)
-    : resample_ratio(static_cast<double>(output_rate) / static_cast<double>(input_rate)) {
+Resampler::Resampler(const int& input_rate, const int& output_rate, const uint& n_channels)
+    : resample_ratio(static_cast<double>(output_rate) / static_cast<double>(input_rate)),
+      channels(std::max(n_channels, 1U)) {
   int err = 0;
 
-  state = speex_resampler_init(1, input_rate, output_rate,
+  state = speex_resampler_init(static_cast<spx_uint32_t>(channels.size()), input_rate, output_rate,
                                SPEEX_RESAMPLER_QUALITY_DESKTOP,  // quality: 0–10
                                &err);
 
   if (!state || err != RESAMPLER_ERR_SUCCESS) {
     util::warning(std::format("error while initializing speex resampler: {}", speex_resampler_strerror(err)));
   }
+
+  // process() resizes the output. Within this capacity it does not allocate in the realtime thread.
+  output.reserve(static_cast<size_t>(std::ceil(lv2::Lv2Wrapper::max_quantum * resample_ratio)) + 1U);
+
+  /**
+   * Plugins processing fixed size blocks may hand over a quantum plus a
+   * block at once. So twice max_quantum frames are accepted on the input or
+   * produced on the output. The extra frames cover the rounding speex does
+   * from call to call.
+   */
+  const auto max_output =
+      static_cast<size_t>(std::ceil(2.0 * lv2::Lv2Wrapper::max_quantum * std::max(resample_ratio, 1.0))) + 2U;
+
+  for (auto& c : channels) {
+    c.resampled.resize(max_output);
+
+    c.pending.set_capacity(2U * max_output);
+  }
 }
 
 Resampler::~Resampler() {
@@ -44,3 +71,58 @@ Resampler::~Resampler() {
 void Resampler::set_quality(const int& value) {
   speex_resampler_set_quality(state, value);
 }
+
+auto Resampler::process(const uint& channel, std::span<const float> input) -> std::span<const float> {
+  if (state == nullptr || channel >= channels.size() || input.empty()) {
+    return {};
+  }
+
+  auto& c = channels[channel];
+
+  spx_uint32_t in_len = input.size();
+  spx_uint32_t out_len = c.resampled.size();
+
+  speex_resampler_process_float(state, channel, input.data(), &in_len, c.resampled.data(), &out_len);
+
+  return std::span<const float>(c.resampled).first(out_len);
+}
+
+void Resampler::process(const uint& channel, std::span<const float> input, std::span<float> output) {
+  if (channel >= channels.size()) {
+    std::ranges::fill(output, 0.0F);
+
+    return;
+  }
+
+  auto& pending = channels[channel].pending;
+
+  pending.push(process(channel, input));
+
+  if (pending.size() >= output.size()) {
+    pending.pop(output);
+
+    return;
+  }
+
+  const auto missing = output.size() - pending.size();
+
+  // All channels receive the same number of frames. The first one accounts for the added delay.
+
+  if (channel == 0U) {
+    padding_frames.fetch_add(static_cast<uint>(missing), std::memory_order_relaxed);
+  }
+
+  std::fill_n(output.begin(), missing, 0.0F);
+
+  pending.pop(output.subspan(missing));
+}
+
+auto Resampler::get_max_output_frames() const -> size_t {
+  return channels.front().resampled.size();
+}
+
+auto Resampler::get_latency_frames() const -> uint {
+  const auto filter_latency = state != nullptr ? speex_resampler_get_output_latency(state) : 0;
+
+  return static_cast<uint>(std::max(filter_latency, 0)) + padding_frames.load(std::memory_order_relaxed);
+}
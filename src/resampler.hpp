@@ -21,13 +21,25 @@
 
 #include <speex/speex_resampler.h>
 #include <speex/speexdsp_config_types.h>
+#include <sys/types.h>
+#include <atomic>
 #include <cmath>
 #include <cstddef>
+#include <span>
 #include <vector>
+#include "rt_ring_buffer.hpp"
 
+/**
+ * Speex resampler for one or more channels. All channels share a single
+ * speex state and are processed with the same rate ratio and quality.
+ *
+ * The streaming methods taking a channel index do not allocate. Their
+ * buffers are sized in the constructor so that the input or the output of
+ * each call can have up to twice lv2::Lv2Wrapper::max_quantum frames.
+ */
 class Resampler {
  public:
-  Resampler(const int& input_rate, const int& output_rate);
+  Resampler(const int& input_rate, const int& output_rate, const uint& n_channels = 1U);
   Resampler(const Resampler&) = delete;
   auto operator=(const Resampler&) -> Resampler& = delete;
   Resampler(const Resampler&&) = delete;
@@ -36,6 +48,10 @@ class Resampler {
 
   void set_quality(const int& value);
 
+  /**
+   * Resamples a whole mono signal. The output vector grows as needed, so this
+   * is meant for offline work like resampling impulse responses.
+   */
   template <typename T>
   auto process(const T& input) -> const std::vector<float>& {
     // https://deepwiki.com/xiph/speexdsp/2.3-resampler
@@ -58,10 +74,46 @@ class Resampler {
     return output;
   }
 
+  /**
+   * Resamples one block of the given channel. The number of frames returned
+   * varies from call to call. They stay valid until the next call for the
+   * same channel.
+   */
+  auto process(const uint& channel, std::span<const float> input) -> std::span<const float>;
+
+  /**
+   * Resamples one block of the given channel and writes exactly
+   * output.size() frames. Frames produced beyond that are kept for the next
+   * call. When fewer are available the output starts with zeros, and the
+   * signal stays delayed by them from then on. See get_latency_frames().
+   */
+  void process(const uint& channel, std::span<const float> input, std::span<float> output);
+
+  // Largest number of frames a single streaming call produces
+  [[nodiscard]] auto get_max_output_frames() const -> size_t;
+
+  /**
+   * Delay in output frames: the delay of the speex filter plus the zeros
+   * added by the fixed output size mode so far.
+   */
+  [[nodiscard]] auto get_latency_frames() const -> uint;
+
  private:
   double resample_ratio = 1.0;
 
+  // Written by the realtime thread. get_latency_frames() may be called from other threads.
+  std::atomic<uint> padding_frames = 0U;
+
   SpeexResamplerState* state = nullptr;
 
   std::vector<float> output;
+
+  struct Channel {
+    std::vector<float> resampled;
+
+    rt::RingBuffer<float> pending;
+  };
+
+  // Never resized after the constructor. The ring buffers can not be moved.
+  std::vector<Channel> channels;
 };
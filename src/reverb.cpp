@@ -25,6 +25,7 @@
 #include <format>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include "db_manager.hpp"
@@ -34,6 +35,7 @@
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
+#include "rt_macros.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
 
@@ -70,6 +72,10 @@ Reverb::Reverb(const std::string& tag, pw::Manager* pipe_manager, PipelineType p
 
   BIND_LV2_PORT_DB("amount", amount, setAmount, DbReverb::amountChanged, true);
   BIND_LV2_PORT_DB("dry", dry, setDry, DbReverb::dryChanged, true);
+
+  // The decay time is in seconds. The margin covers the predelay.
+  BIND_RT_VALUE_TRANSFORM(tail_seconds, decayTime, DbReverb::decayTimeChanged,
+                          [](const double& v) { return v + 0.5; });
 }
 
 Reverb::~Reverb() {
@@ -94,7 +100,7 @@ void Reverb::clear_data() {
   }
 
   {
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
     lv2_wrapper->destroy_instance_locked();
   }
@@ -108,7 +114,7 @@ void Reverb::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   if (!lv2_wrapper->found_plugin) {
     return;
@@ -128,7 +134,7 @@ void Reverb::setup() {
       [this] {
         lv2_wrapper->create_instance(rate);
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         ready = true;
       },
@@ -140,9 +146,9 @@ void Reverb::process(std::span<float>& left_in,
                      std::span<float>& right_in,
                      std::span<float>& left_out,
                      std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass) {
+  if (bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
@@ -21,6 +21,7 @@
 #include <qstandardpaths.h>
 #include <qtmetamacros.h>
 #include <algorithm>
+#include <cstddef>
 #include <cstdio>
 #include <filesystem>
 #include <format>
@@ -34,12 +35,14 @@
 #include <cmath>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include "db_manager.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
 #include "resampler.hpp"
+#include "rt_macros.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
 
@@ -59,6 +62,8 @@ RNNoise::RNNoise(const std::string& tag, pw::Manager* pipe_manager, PipelineType
   data_R.reserve(blocksize);
   data_tmp.reserve(blocksize);
 
+  native_rate = rnnoise_rate;
+
   init_common_controls<DbRNNoise>(settings);
 
   // Initialize directories for local and community models
@@ -95,6 +100,11 @@ RNNoise::RNNoise(const std::string& tag, pw::Manager* pipe_manager, PipelineType
 
   connect(settings, &DbRNNoise::releaseChanged, [&]() { init_release(); });
 
+  BIND_RT_VALUE(enable_vad, enableVad, DbRNNoise::enableVadChanged);
+
+  BIND_RT_VALUE_TRANSFORM(vad_threshold, vadThres, DbRNNoise::vadThresChanged,
+                          [](const double& v) { return v * 0.01; });
+
   auto* m = get_model_from_name();
 
   model = m;
@@ -128,7 +138,7 @@ RNNoise::~RNNoise() {
 
   settings->disconnect();
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   resampler_ready = false;
 
@@ -153,7 +163,7 @@ void RNNoise::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   resampler_ready = false;
 
@@ -164,14 +174,25 @@ void RNNoise::setup() {
   data_L.clear();
   data_R.clear();
 
-  buf_out_L.clear();
-  buf_out_R.clear();
 
-  resampler_inL = std::make_unique<Resampler>(rate, rnnoise_rate);
-  resampler_inR = std::make_unique<Resampler>(rate, rnnoise_rate);
+  resampler_in = std::make_unique<Resampler>(rate, rnnoise_rate, 2U);
+  resampler_out = std::make_unique<Resampler>(rnnoise_rate, rate, 2U);
 
-  resampler_outL = std::make_unique<Resampler>(rnnoise_rate, rate);
-  resampler_outR = std::make_unique<Resampler>(rnnoise_rate, rate);
+  /**
+   * process() appends to these buffers. At most one quantum plus one rnnoise
+   * block is stored before they are emptied, so with this capacity no
+   * allocation happens in the realtime thread.
+   */
+  const auto max_frames = (2U * static_cast<size_t>(std::max(n_samples, blocksize)) * std::max(rate, rnnoise_rate) /
+                           std::min(rate, rnnoise_rate)) +
+                          blocksize;
+
+  for (auto* v : {&data_L, &data_R, &data_tmp, &denoised_L, &denoised_R}) {
+    v->reserve(max_frames);
+  }
+
+  buf_out_L.set_capacity(max_frames);
+  buf_out_R.set_capacity(max_frames);
 
   resampler_ready = true;
 }
@@ -180,9 +201,9 @@ void RNNoise::process(std::span<float>& left_in,
                       std::span<float>& right_in,
                       std::span<float>& left_out,
                       std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass) {
+  if (bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
@@ -214,34 +235,40 @@ void RNNoise::process(std::span<float>& left_in,
 
   if (resample) {
     if (resampler_ready) {
-      const auto resampled_inL = resampler_inL->process(left_in);
-      const auto resampled_inR = resampler_inR->process(right_in);
+      const auto resampled_inL = resampler_in->process(0U, left_in);
+      const auto resampled_inR = resampler_in->process(1U, right_in);
 
-      resampled_data_L.resize(0U);
-      resampled_data_R.resize(0U);
+      denoised_L.resize(0U);
+      denoised_R.resize(0U);
 
 #ifdef ENABLE_RNNOISE
-      remove_noise(resampled_inL, resampled_inR, resampled_data_L, resampled_data_R);
+      remove_noise(resampled_inL, resampled_inR, denoised_L, denoised_R);
 #endif
 
-      auto resampled_outL = resampler_outL->process(resampled_data_L);
-      auto resampled_outR = resampler_outR->process(resampled_data_R);
+      const auto resampled_outL = resampler_out->process(0U, denoised_L);
+      const auto resampled_outR = resampler_out->process(1U, denoised_R);
 
-      buf_out_L.insert(buf_out_L.end(), resampled_outL.begin(), resampled_outL.end());
-      buf_out_R.insert(buf_out_R.end(), resampled_outR.begin(), resampled_outR.end());
+      buf_out_L.push(resampled_outL);
+      buf_out_R.push(resampled_outR);
     } else {
-      buf_out_L.insert(buf_out_L.end(), left_in.begin(), left_in.end());
-      buf_out_R.insert(buf_out_R.end(), right_in.begin(), right_in.end());
+      buf_out_L.push(left_in);
+      buf_out_R.push(right_in);
     }
   } else {
+    denoised_L.resize(0U);
+    denoised_R.resize(0U);
+
 #ifdef ENABLE_RNNOISE
-    remove_noise(left_in, right_in, buf_out_L, buf_out_R);
+    remove_noise(left_in, right_in, denoised_L, denoised_R);
 #endif
+
+    buf_out_L.push(denoised_L);
+    buf_out_R.push(denoised_R);
   }
 
   if (buf_out_L.size() >= n_samples) {
-    util::copy_bulk(buf_out_L, left_out);
-    util::copy_bulk(buf_out_R, right_out);
+    buf_out_L.pop(left_out);
+    buf_out_R.pop(right_out);
   } else {
     const uint offset = left_out.size() - buf_out_L.size();
 
@@ -255,11 +282,8 @@ void RNNoise::process(std::span<float>& left_in,
     std::fill_n(left_out.begin(), offset, 0.0F);
     std::fill_n(right_out.begin(), offset, 0.0F);
 
-    std::ranges::copy(buf_out_L, left_out.begin() + offset);
-    std::ranges::copy(buf_out_R, right_out.begin() + offset);
-
-    buf_out_L.clear();
-    buf_out_R.clear();
+    buf_out_L.pop(left_out.subspan(offset));
+    buf_out_R.pop(right_out.subspan(offset));
   }
 
   if (output_gain != 1.0F) {
@@ -24,6 +24,7 @@
 #include <sys/types.h>
 #include <QString>
 #include <algorithm>
+#include <atomic>
 #include <climits>
 #include <cstddef>
 #include <cstdio>
@@ -40,6 +41,7 @@
 
 #include "plugin_base.hpp"
 #include "resampler.hpp"
+#include "rt_ring_buffer.hpp"
 
 class RNNoise : public PluginBase {
   Q_OBJECT
@@ -92,6 +94,10 @@ class RNNoise : public PluginBase {
  private:
   DbRNNoise* settings = nullptr;
 
+  std::atomic<bool> enable_vad = {false};
+
+  std::atomic<float> vad_threshold = {0.0F};
+
   std::string app_data_dir;
   std::string local_dir_rnnoise;
   std::vector<std::string> system_data_dir_rnnoise;
@@ -110,13 +116,12 @@ class RNNoise : public PluginBase {
 
   const float inv_short_max = 1.0F / (SHRT_MAX + 1.0F);
 
-  std::vector<float> buf_out_L, buf_out_R;
+  rt::RingBuffer<float> buf_out_L, buf_out_R;
 
   std::vector<float> data_L, data_R, data_tmp;
-  std::vector<float> resampled_data_L, resampled_data_R;
+  std::vector<float> denoised_L, denoised_R;
 
-  std::unique_ptr<Resampler> resampler_inL, resampler_outL;
-  std::unique_ptr<Resampler> resampler_inR, resampler_outR;
+  std::unique_ptr<Resampler> resampler_in, resampler_out;
 
 #ifdef ENABLE_RNNOISE
 
@@ -148,8 +153,8 @@ class RNNoise : public PluginBase {
 
           vad_prob_left = rnnoise_process_frame(state_left, data_L.data(), data_L.data());
 
-          if (settings->enableVad()) {
-            if (vad_prob_left >= (settings->vadThres() * 0.01F)) {
+          if (enable_vad.load(std::memory_order_relaxed)) {
+            if (vad_prob_left >= vad_threshold.load(std::memory_order_relaxed)) {
               vad_grace_left = release;
             }
 
@@ -190,8 +195,8 @@ class RNNoise : public PluginBase {
 
           vad_prob_right = rnnoise_process_frame(state_right, data_R.data(), data_R.data());
 
-          if (settings->enableVad()) {
-            if (vad_prob_right >= (settings->vadThres() * 0.01F)) {
+          if (enable_vad.load(std::memory_order_relaxed)) {
+            if (vad_prob_right >= vad_threshold.load(std::memory_order_relaxed)) {
               vad_grace_right = release;
             }
 
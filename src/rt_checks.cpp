@@ -0,0 +1,259 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "rt_checks.hpp"
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <format>
+#include <span>
+#include <string>
+#include "util.hpp"
+
+// NOLINTBEGIN(bugprone-reserved-identifier,cert-dcl37-c,cert-dcl51-cpp,readability-inconsistent-declaration-parameter-name)
+
+/**
+ * glibc exports the allocator and some system calls under these names.
+ * Calling them directly avoids dlsym, which may allocate while we are still
+ * resolving the symbol. The pthread functions and the aligned allocators
+ * are only available through dlsym.
+ */
+extern "C" {
+auto __libc_malloc(size_t size) -> void*;
+auto __libc_calloc(size_t n, size_t size) -> void*;
+auto __libc_realloc(void* ptr, size_t size) -> void*;
+void __libc_free(void* ptr);
+auto __nanosleep(const timespec* req, timespec* rem) -> int;
+auto __read(int fd, void* buf, size_t count) -> ssize_t;
+auto __write(int fd, const void* buf, size_t count) -> ssize_t;
+}
+
+// NOLINTEND(bugprone-reserved-identifier,cert-dcl37-c,cert-dcl51-cpp,readability-inconsistent-declaration-parameter-name)
+
+namespace {
+
+thread_local bool rt_thread = false;
+
+thread_local uint64_t n_allocations = 0U;
+
+thread_local const QString* plugin_name = nullptr;
+
+// Hashes of the call stacks already reported. Once it is full nothing else is reported.
+std::array<std::atomic<uint64_t>, 512U> reported{};
+
+auto first_report(const uint64_t& key) -> bool {
+  for (auto& slot : reported) {
+    uint64_t expected = 0U;
+
+    if (slot.compare_exchange_strong(expected, key)) {
+      return true;
+    }
+
+    if (expected == key) {
+      return false;
+    }
+  }
+
+  return false;
+}
+
+template <typename T>
+auto next_symbol(std::atomic<T>& cache, const char* name) -> T {
+  auto fn = cache.load(std::memory_order_relaxed);
+
+  if (fn == nullptr) {
+    fn = reinterpret_cast<T>(dlsym(RTLD_NEXT, name));  // NOLINT
+
+    cache.store(fn, std::memory_order_relaxed);
+  }
+
+  return fn;
+}
+
+using posix_memalign_t = int (*)(void**, size_t, size_t);
+using aligned_alloc_t = void* (*)(size_t, size_t);
+using mutex_lock_t = int (*)(pthread_mutex_t*);
+using rwlock_lock_t = int (*)(pthread_rwlock_t*);
+
+std::atomic<posix_memalign_t> next_posix_memalign = nullptr;
+std::atomic<aligned_alloc_t> next_aligned_alloc = nullptr;
+std::atomic<mutex_lock_t> next_mutex_lock = nullptr;
+std::atomic<rwlock_lock_t> next_rwlock_rdlock = nullptr;
+std::atomic<rwlock_lock_t> next_rwlock_wrlock = nullptr;
+
+void report(const char* call) {
+  if (!rt_thread) {
+    return;
+  }
+
+  // Reporting allocates and writes. The thread is not flagged while doing it.
+  rt_thread = false;
+
+  std::array<void*, 32U> frames{};
+
+  const auto n_frames = backtrace(frames.data(), static_cast<int>(frames.size()));
+
+  // FNV-1a over the return addresses. The first frames belong to this file.
+  uint64_t key = 14695981039346656037U;
+
+  for (const auto* frame : std::span(frames).subspan(0U, static_cast<size_t>(n_frames))) {
+    key = (key ^ reinterpret_cast<uint64_t>(frame)) * 1099511628211U;  // NOLINT
+  }
+
+  if (first_report(key == 0U ? 1U : key)) {
+    util::warning(std::format("rt checks: {} called in the realtime thread by {}", call,
+                              plugin_name != nullptr ? plugin_name->toStdString() : "unknown"));
+
+    backtrace_symbols_fd(frames.data(), n_frames, STDERR_FILENO);
+  }
+
+  rt_thread = true;
+}
+
+}  // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-no-malloc,bugprone-reserved-identifier,cert-dcl37-c,cert-dcl51-cpp)
+
+extern "C" {
+
+auto malloc(size_t size) -> void* {
+  n_allocations++;
+
+  report("malloc");
+
+  return __libc_malloc(size);
+}
+
+auto calloc(size_t n, size_t size) -> void* {
+  n_allocations++;
+
+  report("calloc");
+
+  return __libc_calloc(n, size);
+}
+
+auto realloc(void* ptr, size_t size) -> void* {
+  n_allocations++;
+
+  report("realloc");
+
+  return __libc_realloc(ptr, size);
+}
+
+auto posix_memalign(void** ptr, size_t alignment, size_t size) -> int {
+  n_allocations++;
+
+  report("posix_memalign");
+
+  return next_symbol(next_posix_memalign, "posix_memalign")(ptr, alignment, size);
+}
+
+auto aligned_alloc(size_t alignment, size_t size) -> void* {
+  n_allocations++;
+
+  report("aligned_alloc");
+
+  return next_symbol(next_aligned_alloc, "aligned_alloc")(alignment, size);
+}
+
+void free(void* ptr) {
+  if (ptr != nullptr) {
+    report("free");
+  }
+
+  __libc_free(ptr);
+}
+
+auto pthread_mutex_lock(pthread_mutex_t* mutex) -> int {
+  report("pthread_mutex_lock");
+
+  return next_symbol(next_mutex_lock, "pthread_mutex_lock")(mutex);
+}
+
+auto pthread_rwlock_rdlock(pthread_rwlock_t* rwlock) -> int {
+  report("pthread_rwlock_rdlock");
+
+  return next_symbol(next_rwlock_rdlock, "pthread_rwlock_rdlock")(rwlock);
+}
+
+auto pthread_rwlock_wrlock(pthread_rwlock_t* rwlock) -> int {
+  report("pthread_rwlock_wrlock");
+
+  return next_symbol(next_rwlock_wrlock, "pthread_rwlock_wrlock")(rwlock);
+}
+
+auto nanosleep(const timespec* req, timespec* rem) -> int {
+  report("nanosleep");
+
+  return __nanosleep(req, rem);
+}
+
+auto read(int fd, void* buf, size_t count) -> ssize_t {
+  report("read");
+
+  return __read(fd, buf, count);
+}
+
+auto write(int fd, const void* buf, size_t count) -> ssize_t {
+  report("write");
+
+  return __write(fd, buf, count);
+}
+}
+
+// NOLINTEND(cppcoreguidelines-no-malloc,bugprone-reserved-identifier,cert-dcl37-c,cert-dcl51-cpp)
+
+namespace rt::checks {
+
+auto allocation_count() -> uint64_t {
+  return n_allocations;
+}
+
+#ifdef ENABLE_RT_CHECKS
+
+Scope::Scope(const QString& name) : previous_name(plugin_name), previous_state(rt_thread) {
+  plugin_name = &name;
+
+  rt_thread = true;
+}
+
+Scope::~Scope() {
+  plugin_name = previous_name;
+
+  rt_thread = previous_state;
+}
+
+Allow::Allow() : previous_state(rt_thread) {
+  rt_thread = false;
+}
+
+Allow::~Allow() {
+  rt_thread = previous_state;
+}
+
+#endif
+
+}  // namespace rt::checks
@@ -0,0 +1,95 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+#include <cstdint>
+
+namespace rt::checks {
+
+#if defined(ENABLE_RT_CHECKS) || defined(ENABLE_BENCHMARKS)
+
+/**
+ * Number of malloc, calloc, realloc, posix_memalign and aligned_alloc calls
+ * made so far by the calling thread. C++ allocations and the ones made inside
+ * C libraries are both counted. Only exists in builds where rt_checks.cpp
+ * replaces the allocator.
+ */
+auto allocation_count() -> uint64_t;
+
+#endif
+
+#ifdef ENABLE_RT_CHECKS
+
+/**
+ * Flags the calling thread as a realtime thread while the object exists.
+ * Memory allocations, blocking locks, sleeps and read/write system calls
+ * made by a flagged thread are reported once per call stack, together with
+ * the name of the plugin and a stack trace. It only exists in builds with
+ * ENABLE_RT_CHECKS, where malloc and friends are replaced by wrappers around
+ * the glibc implementations.
+ */
+class Scope {
+ public:
+  explicit Scope(const QString& name);
+  Scope(const Scope&) = delete;
+  auto operator=(const Scope&) -> Scope& = delete;
+  Scope(const Scope&&) = delete;
+  auto operator=(const Scope&&) -> Scope& = delete;
+  ~Scope();
+
+ private:
+  const QString* previous_name = nullptr;
+
+  bool previous_state = false;
+};
+
+/**
+ * Calls known to be acceptable inside a realtime scope. For example
+ * pw_loop_invoke writes to an eventfd to wake up the PipeWire main loop.
+ */
+class Allow {
+ public:
+  Allow();
+  Allow(const Allow&) = delete;
+  auto operator=(const Allow&) -> Allow& = delete;
+  Allow(const Allow&&) = delete;
+  auto operator=(const Allow&&) -> Allow& = delete;
+  ~Allow();
+
+ private:
+  bool previous_state = false;
+};
+
+#else
+
+class Scope {
+ public:
+  explicit Scope([[maybe_unused]] const QString& name) {}
+};
+
+class Allow {
+ public:
+  Allow() = default;
+};
+
+#endif
+
+}  // namespace rt::checks
@@ -0,0 +1,62 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+
+/**
+ * Mirrors a KConfig setting into a std::atomic member that can be read from
+ * the realtime thread. The value is refreshed from the setting's change
+ * signal, so process() does not have to call the KConfigSkeleton getters.
+ * The TRANSFORM variant stores a value derived from the setting, keeping
+ * conversions like dB to linear out of the audio thread. The NOTIFY variant
+ * also raises an atomic flag, so process() knows when values that have to be
+ * pushed into a library state changed.
+ */
+
+// NOLINTBEGIN(bugprone-macro-parentheses,cppcoreguidelines-macro-usage)
+#define BIND_RT_VALUE(target, getter, onChangedSignal)                                                             \
+  {                                                                                                                \
+    using rt_value_t = std::remove_reference_t<decltype(target)>::value_type;                                      \
+    target.store(static_cast<rt_value_t>(settings->getter()), std::memory_order_relaxed);                          \
+    connect(settings, &onChangedSignal,                                                                            \
+            [this]() { target.store(static_cast<rt_value_t>(settings->getter()), std::memory_order_relaxed); });   \
+  }
+
+#define BIND_RT_VALUE_TRANSFORM(target, getter, onChangedSignal, transform)                                        \
+  {                                                                                                                \
+    using rt_value_t = std::remove_reference_t<decltype(target)>::value_type;                                      \
+    target.store(static_cast<rt_value_t>(transform(settings->getter())), std::memory_order_relaxed);               \
+    connect(settings, &onChangedSignal, [this]() {                                                                 \
+      target.store(static_cast<rt_value_t>(transform(settings->getter())), std::memory_order_relaxed);             \
+    });                                                                                                            \
+  }
+
+#define BIND_RT_VALUE_NOTIFY(target, getter, onChangedSignal, changed)                                             \
+  {                                                                                                                \
+    using rt_value_t = std::remove_reference_t<decltype(target)>::value_type;                                      \
+    target.store(static_cast<rt_value_t>(settings->getter()), std::memory_order_relaxed);                          \
+    connect(settings, &onChangedSignal, [this]() {                                                                 \
+      target.store(static_cast<rt_value_t>(settings->getter()), std::memory_order_relaxed);                        \
+      changed.store(true, std::memory_order_release);                                                              \
+    });                                                                                                            \
+  }
+// NOLINTEND(bugprone-macro-parentheses,cppcoreguidelines-macro-usage)
@@ -0,0 +1,154 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace rt {
+
+/**
+ * Fixed capacity FIFO used to adapt the PipeWire quantum to the block size
+ * of a processing library. Pushing and popping copy the samples at most in
+ * two segments and never move the data already stored, so the cost does not
+ * depend on how much is buffered.
+ *
+ * It is safe for one producer thread and one consumer thread. The capacity
+ * is set by set_capacity() outside of the realtime thread. push() and pop()
+ * never allocate. They copy all the requested samples or none of them.
+ */
+template <typename T>
+class RingBuffer {
+ public:
+  RingBuffer() = default;
+  RingBuffer(const RingBuffer&) = delete;
+  auto operator=(const RingBuffer&) -> RingBuffer& = delete;
+  RingBuffer(const RingBuffer&&) = delete;
+  auto operator=(const RingBuffer&&) -> RingBuffer& = delete;
+  ~RingBuffer() = default;
+
+  // Allocates at least n elements and empties the buffer. Not realtime safe.
+  void set_capacity(const size_t& n) {
+    buffer.assign(std::bit_ceil(std::max<size_t>(n, 1U)), T{});
+
+    mask = buffer.size() - 1U;
+
+    clear();
+  }
+
+  // Must not be called while the producer or the consumer are running
+  void clear() {
+    write_index.store(0U, std::memory_order_relaxed);
+    read_index.store(0U, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto capacity() const -> size_t { return buffer.size(); }
+
+  [[nodiscard]] auto size() const -> size_t {
+    return write_index.load(std::memory_order_acquire) - read_index.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] auto empty() const -> bool { return size() == 0U; }
+
+  auto push(std::span<const T> data) -> bool {
+    const auto w = write_index.load(std::memory_order_relaxed);
+    const auto r = read_index.load(std::memory_order_acquire);
+
+    if (data.size() > buffer.size() - (w - r)) {
+      return false;
+    }
+
+    const auto start = w & mask;
+    const auto first = std::min(data.size(), buffer.size() - start);
+
+    std::copy_n(data.begin(), first, buffer.begin() + start);
+    std::copy_n(data.begin() + first, data.size() - first, buffer.begin());
+
+    write_index.store(w + data.size(), std::memory_order_release);
+
+    return true;
+  }
+
+  // Appends n zeros. Used to give a constant latency to block based processing.
+  auto push_zeros(const size_t& n) -> bool {
+    const auto w = write_index.load(std::memory_order_relaxed);
+    const auto r = read_index.load(std::memory_order_acquire);
+
+    if (n > buffer.size() - (w - r)) {
+      return false;
+    }
+
+    for (size_t i = 0U; i < n; i++) {
+      buffer[(w + i) & mask] = T{};
+    }
+
+    write_index.store(w + n, std::memory_order_release);
+
+    return true;
+  }
+
+  // Copies the oldest data.size() elements without removing them
+  auto peek(std::span<T> data) const -> bool {
+    const auto r = read_index.load(std::memory_order_relaxed);
+    const auto w = write_index.load(std::memory_order_acquire);
+
+    if (data.size() > w - r) {
+      return false;
+    }
+
+    const auto start = r & mask;
+    const auto first = std::min(data.size(), buffer.size() - start);
+
+    std::copy_n(buffer.begin() + start, first, data.begin());
+    std::copy_n(buffer.begin(), data.size() - first, data.begin() + first);
+
+    return true;
+  }
+
+  auto discard(const size_t& n) -> bool {
+    const auto r = read_index.load(std::memory_order_relaxed);
+    const auto w = write_index.load(std::memory_order_acquire);
+
+    if (n > w - r) {
+      return false;
+    }
+
+    read_index.store(r + n, std::memory_order_release);
+
+    return true;
+  }
+
+  auto pop(std::span<T> data) -> bool { return peek(data) && discard(data.size()); }
+
+ private:
+  std::vector<T> buffer;
+
+  size_t mask = 0U;
+
+  // They only grow. The difference is the number of stored elements.
+  std::atomic<size_t> write_index = {0U};
+  std::atomic<size_t> read_index = {0U};
+};
+
+}  // namespace rt
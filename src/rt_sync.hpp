@@ -0,0 +1,171 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace rt {
+
+/**
+ * Replacement for a plain std::mutex shared between the realtime thread and
+ * the other threads of a plugin.
+ *
+ * The non realtime side (GUI, worker thread, setup) uses the usual lock() and
+ * unlock() calls through std::scoped_lock. They are serialized by an internal
+ * mutex and only return after the realtime thread has left process().
+ *
+ * The realtime side uses std::shared_lock with std::try_to_lock. It never
+ * blocks and never makes a system call. When the data is being changed by
+ * another thread the lock is not acquired and the plugin should pass the audio
+ * through for this cycle instead of waiting.
+ */
+class DataMutex {
+ public:
+  DataMutex() = default;
+  DataMutex(const DataMutex&) = delete;
+  auto operator=(const DataMutex&) -> DataMutex& = delete;
+  DataMutex(const DataMutex&&) = delete;
+  auto operator=(const DataMutex&&) -> DataMutex& = delete;
+  ~DataMutex() = default;
+
+  void lock() {
+    writers_mutex.lock();
+
+    writer_active.store(true);
+
+    while (reader_active.load()) {
+      std::this_thread::yield();
+    }
+  }
+
+  void unlock() {
+    writer_active.store(false);
+
+    writers_mutex.unlock();
+  }
+
+  auto try_lock_shared() -> bool {
+    reader_active.store(true);
+
+    if (writer_active.load()) {
+      reader_active.store(false);
+
+      return false;
+    }
+
+    return true;
+  }
+
+  void unlock_shared() { reader_active.store(false); }
+
+ private:
+  std::mutex writers_mutex;
+
+  // Sequentially consistent operations are required by the store/load handshake above
+  std::atomic<bool> writer_active = {false};
+  std::atomic<bool> reader_active = {false};
+};
+
+/**
+ * Immutable parameter snapshot exchanged between the GUI and the realtime
+ * thread without locks.
+ *
+ * The GUI thread builds a new object and calls publish(). The realtime thread
+ * calls update() once per cycle and then reads the values through get(). The
+ * snapshot replaced on the realtime thread is never deleted there. It is moved
+ * to a retired slot and deleted by the next publish() or reclaim() call.
+ */
+template <typename T>
+class Snapshot {
+ public:
+  Snapshot() = default;
+  Snapshot(const Snapshot&) = delete;
+  auto operator=(const Snapshot&) -> Snapshot& = delete;
+  Snapshot(const Snapshot&&) = delete;
+  auto operator=(const Snapshot&&) -> Snapshot& = delete;
+
+  ~Snapshot() {
+    reclaim();
+
+    delete pending.load();
+    delete current;
+  }
+
+  // Not realtime safe. Only one thread is allowed to publish.
+  void publish(std::unique_ptr<const T> value) {
+    reclaim();
+
+    delete pending.exchange(value.release(), std::memory_order_acq_rel);
+  }
+
+  // Not realtime safe.
+  void reclaim() {
+    for (auto& slot : retired) {
+      delete slot.exchange(nullptr, std::memory_order_acq_rel);
+    }
+  }
+
+  /**
+   * Realtime safe. Returns true when a new snapshot was picked up. Between two
+   * publish() calls the realtime thread can take at most one new snapshot, so
+   * two retired slots are enough to never delay an update.
+   */
+  auto update() -> bool {
+    if (pending.load(std::memory_order_acquire) == nullptr) {
+      return false;
+    }
+
+    for (auto& slot : retired) {
+      if (slot.load(std::memory_order_acquire) != nullptr) {
+        continue;
+      }
+
+      const T* next = pending.exchange(nullptr, std::memory_order_acq_rel);
+
+      if (next == nullptr) {
+        return false;
+      }
+
+      slot.store(current, std::memory_order_release);
+
+      current = next;
+
+      return true;
+    }
+
+    return false;
+  }
+
+  // Realtime safe. It may return nullptr before the first update.
+  [[nodiscard]] auto get() const -> const T* { return current; }
+
+ private:
+  const T* current = nullptr;
+
+  std::atomic<const T*> pending = {nullptr};
+
+  std::array<std::atomic<const T*>, 2U> retired = {};
+};
+
+}  // namespace rt
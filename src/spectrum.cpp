@@ -26,10 +26,11 @@
 #include <QApplication>
 #include <QString>
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
-#include <cstring>
+#include <cstdint>
 #include <format>
 #include <memory>
 #include <mutex>
@@ -38,6 +39,7 @@
 #include <string>
 #include <tuple>
 #include "easyeffects_db_spectrum.h"
+#include "fftw_planner.hpp"
 #include "lv2_macros.hpp"
 #include "lv2_wrapper.hpp"
 #include "pipeline_type.hpp"
@@ -50,21 +52,8 @@ Spectrum::Spectrum(const std::string& tag, pw::Manager* pipe_manager, PipelineTy
     : PluginBase(tag, "spectrum", tags::plugin_package::Package::ee, instance_id, pipe_manager, pipe_type),
       settings(DbSpectrum::self()) {
   bypass = !DbSpectrum::state();
-  // Precompute the Hann window, which is an expensive operation.
-  // https://en.wikipedia.org/wiki/Hann_function
-  for (size_t n = 0; n < n_bands; n++) {
-    hann_window[n] =
-        0.5F *
-        (1.0F - std::cos(2.0F * std::numbers::pi_v<float> * static_cast<float>(n) / static_cast<float>(n_bands - 1)));
-  }
-
-  complex_output = fftwf_alloc_complex(output.size());
 
-  plan = fftwf_plan_dft_r2c_1d(static_cast<int>(n_bands), real_input.data(), complex_output, FFTW_ESTIMATE);
-
-  if (plan != nullptr && complex_output != nullptr) {
-    fftw_ready = true;
-  }
+  std::ranges::fill(ring, 0.0F);
 
   const auto lv2_plugin_uri = "http://lsp-plug.in/plugins/lv2/comp_delay_x2_stereo";
 
@@ -95,7 +84,7 @@ Spectrum::Spectrum(const std::string& tag, pw::Manager* pipe_manager, PipelineTy
 Spectrum::~Spectrum() {
   stop_worker();
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   if (connected_to_pw) {
     disconnect_from_pw();
@@ -103,13 +92,11 @@ Spectrum::~Spectrum() {
 
   settings->disconnect();
 
-  fftw_ready = false;
+  // The worker is stopped. Nothing is published anymore.
 
-  if (complex_output != nullptr) {
-    fftwf_free(complex_output);
-  }
+  delete analysis_pending.exchange(nullptr);
 
-  fftwf_destroy_plan(plan);
+  analysis.reset();
 
   util::debug(std::format("{}{} destroyed", log_tag, name.toStdString()));
 }
@@ -122,7 +109,7 @@ void Spectrum::clear_data() {
   }
 
   {
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
     lv2_wrapper->destroy_instance_locked();
   }
@@ -136,12 +123,21 @@ void Spectrum::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
+
+  /**
+   * The realtime thread does not take data_mutex and may still be writing to
+   * the ring. Instead of clearing it the current write position becomes the
+   * beginning of the new stream.
+   */
+
+  stream_start = write_index.load(std::memory_order_acquire);
 
-  bin_hz = static_cast<float>(rate) / n_bands;
+  // The averages restart with the new stream
+  last_frame_end = stream_start;
+  n_averaged = 0U;
 
-  std::ranges::fill(real_input, 0.0F);
-  std::ranges::fill(latest_samples_mono, 0.0F);
+  std::ranges::fill(power, 0.0F);
 
   if (!lv2_wrapper->found_plugin) {
     ready = true;  // THe spectrum works without the delay compensation
@@ -167,7 +163,7 @@ void Spectrum::setup() {
 
         lv2_wrapper->create_instance(rate);
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         ready = true;
       },
@@ -182,10 +178,13 @@ void Spectrum::process(std::span<float>& left_in,
   std::ranges::copy(left_in, left_out.begin());
   std::ranges::copy(right_in, right_out.begin());
 
-  if (bypass || !fftw_ready || !ready) {
+  if (bypass || !ready) {
     return;
   }
 
+  std::span<const float> left = left_in;
+  std::span<const float> right = right_in;
+
   /**
    * delay the visualization of the spectrum by the reported latency of the
    * output device, so that the spectrum is visually in sync with the audio
@@ -195,142 +194,337 @@ void Spectrum::process(std::span<float>& left_in,
     lv2_wrapper->connect_data_ports(left_in, right_in, left_delayed, right_delayed);
     lv2_wrapper->run();
 
-    // Downmix the latest n_bands samples from the delayed signal.
-    if (n_samples < n_bands) {
-      // Drop the oldest quantum.
-      std::memmove(latest_samples_mono.data(), &latest_samples_mono[n_samples], (n_bands - n_samples) * sizeof(float));
+    left = left_delayed;
+    right = right_delayed;
+  }
 
-      // Copy the new quantum.
-      for (size_t n = 0; n < n_samples; n++) {
-        latest_samples_mono[n_bands - n_samples + n] = 0.5F * (left_delayed[n] + right_delayed[n]);
-      }
-    } else {
-      // Copy the latest n_bands samples.
-      for (size_t n = 0; n < n_bands; n++) {
-        latest_samples_mono[n] =
-            0.5F * (left_delayed[n_samples - n_bands + n] + right_delayed[n_samples - n_bands + n]);
-      }
+  /**
+   * The GUI thread is never waited for. We downmix the quantum into the ring
+   * and publish it by advancing the write index. Only the new samples are
+   * written, so the cost does not depend on the FFT size. compute_magnitudes()
+   * unwraps the frames it needs when the GUI asks for them.
+   */
+
+  const auto n = std::min(left.size(), ring_size);
+  const auto first = left.size() - n;
+
+  const auto w = write_index.load(std::memory_order_relaxed);
+
+  for (size_t k = 0U; k < n; k++) {
+    ring[(w + k) & ring_mask] = 0.5F * (left[first + k] + right[first + k]);
+  }
+
+  write_index.store(w + n, std::memory_order_release);
+}
+
+Spectrum::Analysis::~Analysis() {
+  FftwPlanner::self().run([this] {
+    if (plan != nullptr) {
+      fftwf_destroy_plan(plan);
     }
-  } else {
-    // Downmix the latest n_bands samples from the non-delayed signal.
-    if (n_samples < n_bands) {
-      // Drop the oldest quantum.
-      std::memmove(latest_samples_mono.data(), &latest_samples_mono[n_samples], (n_bands - n_samples) * sizeof(float));
-
-      // Copy the new quantum.
-      for (size_t n = 0; n < n_samples; n++) {
-        latest_samples_mono[n_bands - n_samples + n] = 0.5F * (left_in[n] + right_in[n]);
-      }
-    } else {
-      // Copy the latest n_bands samples.
-      for (size_t n = 0; n < n_bands; n++) {
-        latest_samples_mono[n] = 0.5F * (left_in[n_samples - n_bands + n] + right_in[n_samples - n_bands + n]);
-      }
+  });
+
+  if (real_input != nullptr) {
+    fftwf_free(real_input);
+  }
+
+  if (complex_output != nullptr) {
+    fftwf_free(complex_output);
+  }
+}
+
+auto Spectrum::configure() -> bool {
+  const auto size_index = std::clamp(settings->fftSize(), 0, 6);
+  const auto overlap_index = std::clamp(settings->fftOverlap(), 0, static_cast<int>(overlap_divisors.size()) - 1);
+
+  const auto new_size = min_fft_size << static_cast<uint>(size_index);
+  const auto new_averaging = static_cast<Averaging>(std::clamp(settings->averaging(), 0, 3));
+
+  if (requested_fft_size.load(std::memory_order_relaxed) != new_size) {
+    requested_fft_size.store(new_size, std::memory_order_relaxed);
+
+    request_analysis(new_size);
+  }
+
+  if (auto* next = analysis_pending.exchange(nullptr, std::memory_order_acq_rel); next != nullptr) {
+    const auto size_changed = analysis == nullptr || analysis->fft_size != next->fft_size;
+
+    // Destroying the plan waits for the fftw planner. The worker does it.
+
+    // NOLINTBEGIN(clang-analyzer-cplusplus.NewDeleteLeaks)
+    QMetaObject::invokeMethod(baseWorker, [old = analysis.release()] { delete old; }, Qt::QueuedConnection);
+    // NOLINTEND(clang-analyzer-cplusplus.NewDeleteLeaks)
+
+    analysis.reset(next);
+
+    if (size_changed) {
+      const auto n_bins = (analysis->fft_size / 2U) + 1U;
+
+      power.assign(n_bins, 0.0F);
+      frame_power.assign(n_bins, 0.0F);
+
+      output.resize(static_cast<qsizetype>(n_bins));
+
+      hop = 0U;
+
+      util::debug(std::format("{}spectrum fft size: {}", log_tag, analysis->fft_size));
     }
   }
 
+  if (analysis == nullptr) {
+    return false;
+  }
+
+  // The overlap applies to the size in use. It may still be the previous one.
+
+  const auto new_hop = analysis->fft_size / overlap_divisors.at(overlap_index);
+
+  if (new_hop != hop || new_averaging != averaging) {
+    hop = new_hop;
+    averaging = new_averaging;
+
+    n_averaged = 0U;
+
+    last_frame_end = 0U;
+
+    std::ranges::fill(power, 0.0F);
+  }
+
+  return true;
+}
+
+void Spectrum::request_analysis(const uint& size) {
+  // NOLINTBEGIN(clang-analyzer-cplusplus.NewDeleteLeaks)
+  QMetaObject::invokeMethod(
+      baseWorker,
+      [this, size] {
+        // The estimated plan is ready at once. The measured one replaces it when it is done.
+
+        for (const auto measure : {false, true}) {
+          if (requested_fft_size.load(std::memory_order_relaxed) != size) {
+            return;  // The size changed again. A newer request is queued.
+          }
+
+          auto instance = create_analysis(size, measure);
+
+          if (instance == nullptr) {
+            return;
+          }
+
+          delete analysis_pending.exchange(instance.release(), std::memory_order_acq_rel);
+        }
+      },
+      Qt::QueuedConnection);
+  // NOLINTEND(clang-analyzer-cplusplus.NewDeleteLeaks)
+}
+
+auto Spectrum::create_analysis(const uint& size, const bool& measure) const -> std::unique_ptr<Analysis> {
+  auto instance = std::make_unique<Analysis>();
+
+  instance->fft_size = size;
+
+  const auto n_bins = (size / 2U) + 1U;
+
+  instance->real_input = fftwf_alloc_real(size);
+  instance->complex_output = fftwf_alloc_complex(n_bins);
+
+  if (instance->real_input == nullptr || instance->complex_output == nullptr) {
+    return nullptr;
+  }
+
   /**
-   * OK, we have the latest_samples_mono array that contains n_bands samples. We
-   * want to export it to the GUI thread. We don't wakeup the GUI thread from
-   * realtime, we only want to update the buffer and let the GUI thread follow
-   * its scheduling and have access to our new buffer. We accept losing old
-   * data.
-   *
-   * For that, we want to synchronise both threads. Realtime shouldn't have to
-   * wait (ie loop or syscall). It is fine if GUI waits a little.
-   *
-   * The overall concept is to use two buffers. When realtime comes in, it
-   * writes into one. When GUI arrives, it waits for realtime to be done
-   * writing (if it is busy) and it switches the active buffer to become the
-   * other one. As GUI is the one doing the toggle, it knows it can read at its
-   * pace the inactive buffer. Realtime will always have a buffer to write
-   * into, and it is fine if it overwrites data.
-   *
-   * We use an atomic integer (db_control) that contains three bits:
-   *  - DB_BIT_IDX: the current buffer index.
-   *  - DB_BIT_NEWDATA: indicates if realtime wrote new data.
-   *  - DB_BIT_BUSY: indicates if realtime is currently busy writing data.
-   *
-   * Realtime does this:
-   *  - Grab db_control and enable its BUSY bit.
-   *  - Write data into the correct buffer based on the IDX bit.
-   *  - Write db_control with same index as before, BUSY bit disabled and
-   *    NEWDATA bit enabled.
-   *
-   * GUI does this:
-   *  - Early return if NEWDATA is not enabled. It means realtime hasn't ran
-   *    since the last time GUI ran.
-   *  - Then it tries toggling the IDX bit. "Tries" because the operation fails
-   *    as long as the BUSY bit is active.
-   *  - From now on it can read the previous buffer knowing realtime cannot be
-   *    writing into it.
-   *
-   * This is single-producer single-consumer double-buffering. The
-   * implementation is inspired from the "Real-time 101" ADC19 talk
-   * (David Rowland & Fabian Renn-Giles).
-   *
-   * Talk part 1 & 2, slides (page 74 onwards) and illustrating library:
-   * https://www.youtube.com/watch?v=Q0vrQFyAdWI
-   * https://www.youtube.com/watch?v=PoZAo2Vikbo
-   * https://github.com/drowaudio/presentations/blob/master/ADC%202019%20-%20Real-time%20101/Real-time%20101.pdf
-   * https://github.com/hogliux/farbot
+   * Measured plans are much faster for the large sizes. The wisdom makes the
+   * measurement a one time cost. When there is no wisdom for this size yet the
+   * measurement waits until no other plugin needs the planner, and the time
+   * limit bounds how long it can hold it.
    */
 
-  // Grab the current index AND mark as busy at the same time.
-  int index = db_control.fetch_or(static_cast<int>(DB_BIT::BUSY)) & static_cast<int>(DB_BIT::IDX);
+  const auto make_plan = [&](const uint flags) {
+    fftwf_set_timelimit(measure_time_limit);
+
+    auto* p = fftwf_plan_dft_r2c_1d(static_cast<int>(size), instance->real_input, instance->complex_output, flags);
+
+    fftwf_set_timelimit(FFTW_NO_TIMELIMIT);
+
+    return p;
+  };
+
+  instance->plan = FftwPlanner::self().run([&] {
+    if (!measure) {
+      return fftwf_plan_dft_r2c_1d(static_cast<int>(size), instance->real_input, instance->complex_output,
+                                   FFTW_ESTIMATE);
+    }
+
+    FftwPlanner::self().load_wisdom();
+
+    return make_plan(FFTW_MEASURE | FFTW_WISDOM_ONLY);
+  });
+
+  if (instance->plan == nullptr && measure) {
+    instance->plan = FftwPlanner::self().run_when_idle([&] {
+      auto* p = make_plan(FFTW_MEASURE);
+
+      FftwPlanner::self().save_wisdom();
+
+      return p;
+    });
+  }
+
+  if (instance->plan == nullptr) {
+    util::warning(std::format("{}could not create the fftw plan for {} samples", log_tag, size));
+
+    return nullptr;
+  }
+
+  // https://en.wikipedia.org/wiki/Hann_function
+
+  instance->window.resize(size);
+
+  float window_sum = 0.0F;
+
+  for (size_t n = 0U; n < size; n++) {
+    instance->window[n] = 0.5F * (1.0F - std::cos(2.0F * std::numbers::pi_v<float> * static_cast<float>(n) /
+                                                  static_cast<float>(size - 1U)));
+
+    window_sum += instance->window[n];
+  }
+
+  /**
+   * Dividing by the window sum compensates the fft size and the Hann window
+   * at once. The single sided spectrum has half the weight at the first and
+   * last bins.
+   */
+
+  instance->normalization.assign(n_bins, 1.0F / window_sum);
+
+  instance->normalization.front() *= 0.5F;
+  instance->normalization.back() *= 0.5F;
+
+  return instance;
+}
+
+auto Spectrum::analyse_frame(const uint64_t& end) -> bool {
+  const auto start = end - analysis->fft_size;
+
+  for (size_t n = 0U; n < analysis->fft_size; n++) {
+    // What was written before the current stream began is read as silence
+    const auto sample = (start + n < stream_start) ? 0.0F : ring[(start + n) & ring_mask];
+
+    analysis->real_input[n] = sample * analysis->window[n];
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  // If the realtime thread went past the start of the frame the copy is torn
+  if (write_index.load(std::memory_order_relaxed) - start > ring_size) {
+    return false;
+  }
+
+  fftwf_execute(analysis->plan);
+
+  for (size_t i = 0U; i < frame_power.size(); i++) {
+    const float real = analysis->complex_output[i][0] * analysis->normalization[i];
+    const float img = analysis->complex_output[i][1] * analysis->normalization[i];
 
-  // Fill the buffer.
-  db_buffers[index] = latest_samples_mono;
+    frame_power[i] = (real * real) + (img * img);
+  }
 
-  // Mark new data available AND mark as not busy anymore.
-  db_control.store(index | static_cast<int>(DB_BIT::NEWDATA));
+  return true;
 }
 
 auto Spectrum::compute_magnitudes() -> std::tuple<uint, float, QList<double>> {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
-  // Early return if no new data is available, ie if process() has not been
-  // called since our last compute_magnitudes() call.
-  int curr_control = db_control.load();
-  if (!fftw_ready || !(curr_control & static_cast<int>(DB_BIT::NEWDATA))) {
-    return {0, bin_hz, {}};
+  if (!configure() || rate == 0U) {
+    return {0, 0.0F, {}};
   }
 
-  // CAS loop to toggle the buffer used and remove NEWDATA flag, waiting for !BUSY.
-  int next_control = 0;
-  do {
-    curr_control &= ~static_cast<int>(DB_BIT::BUSY);
-    next_control = (curr_control ^ static_cast<int>(DB_BIT::IDX)) & static_cast<int>(DB_BIT::IDX);
-  } while (!db_control.compare_exchange_weak(curr_control, next_control));
+  const auto bin_hz = static_cast<float>(rate) / static_cast<float>(analysis->fft_size);
 
-  // Buffer with data is at the index which was found inside db_control.
-  int index = curr_control & static_cast<int>(DB_BIT::IDX);
-  float* buf = db_buffers[index].data();
+  const auto w = write_index.load(std::memory_order_acquire);
 
-  // https://en.wikipedia.org/wiki/Hann_function
-  for (size_t n = 0; n < n_bands; n++) {
-    real_input[n] = buf[n] * hann_window[n];
+  // Early return if process() has not written anything since our last call
+  if (w == last_frame_end) {
+    return {0, bin_hz, {}};
   }
 
-  fftwf_execute(plan);
+  if (averaging == Averaging::none) {
+    // Only the latest frame matters. Before the first fft_size samples are written the ring still has zeros.
 
-  for (uint i = 0U; i < output.size(); i++) {
-    float real = complex_output[i][0];
-    float img = complex_output[i][1];
+    if (!analyse_frame(w)) {
+      return {0, bin_hz, {}};
+    }
 
-    float mag = std::sqrt((real * real) + (img * img));
+    last_frame_end = w;
 
-    mag /= static_cast<float>(n_bands);
+    std::ranges::copy(frame_power, power.begin());
+  } else {
+    /**
+     * The frames are analysed at every hop since the last request, so the
+     * averages do not depend on how often the GUI asks for data. If the GUI
+     * was away for long we skip ahead to the frames the ring still has.
+     */
+
+    const auto ring_limit = (ring_size - analysis->fft_size - (ring_size / 8U)) / hop;
 
-    // Compensate Hann window
-    mag *= 2.0F;
+    const auto max_frames = static_cast<uint64_t>(std::clamp<size_t>(ring_limit, 1U, max_frames_per_request));
 
-    // Single-sided correction
-    if (i == 0 || i == n_bands / 2) {
-      mag *= 0.5F;
+    if (w - last_frame_end > (max_frames + 1U) * hop) {
+      last_frame_end = w - (max_frames * hop);
     }
 
-    output[i] = static_cast<double>(util::linear_to_db(mag));
+    const auto hop_seconds = static_cast<float>(hop) / static_cast<float>(rate);
+
+    const auto decay = std::exp(-hop_seconds / static_cast<float>(settings->averagingTime()));
+
+    bool updated = false;
+
+    for (auto end = last_frame_end + hop; end <= w; end += hop) {
+      last_frame_end = end;
+
+      if (!analyse_frame(end)) {
+        continue;
+      }
+
+      updated = true;
+
+      for (size_t i = 0U; i < power.size(); i++) {
+        switch (averaging) {
+          case Averaging::peak_hold:
+            power[i] = std::max(frame_power[i], power[i] * decay);
+            break;
+          case Averaging::exponential:
+            power[i] = (decay * power[i]) + ((1.0F - decay) * frame_power[i]);
+            break;
+          case Averaging::welch:
+          case Averaging::none:
+            power[i] += frame_power[i];
+            break;
+        }
+      }
+
+      n_averaged++;
+    }
+
+    if (!updated) {
+      return {0, bin_hz, {}};
+    }
+
+    if (averaging == Averaging::welch) {
+      // Welch's method: the mean of the periodograms of the overlapping frames since the last request
+
+      std::ranges::for_each(power, [&](auto& v) { v /= static_cast<float>(n_averaged); });
+    }
+  }
+
+  for (qsizetype i = 0; i < output.size(); i++) {
+    output[i] = static_cast<double>(util::linear_to_db(std::sqrt(power[i])));
+  }
+
+  if (averaging == Averaging::welch) {
+    std::ranges::fill(power, 0.0F);
+
+    n_averaged = 0U;
   }
 
   return {rate, bin_hz, output};
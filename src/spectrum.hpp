@@ -25,6 +25,9 @@
 #include <QString>
 #include <array>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <span>
 #include <string>
 #include <tuple>
@@ -68,38 +71,111 @@ class Spectrum : public PluginBase {
  private:
   DbSpectrum* settings = nullptr;
 
-  std::atomic<bool> fftw_ready = false;
+  static constexpr uint min_fft_size = 1024U;
+  static constexpr uint max_fft_size = 65536U;
 
-  fftwf_plan plan = nullptr;
+  // Analysed frames are spaced by fft_size / overlap_divisors[fftOverlap]
+  static constexpr std::array<uint, 4> overlap_divisors = {1U, 2U, 4U, 8U};
 
-  fftwf_complex* complex_output = nullptr;
+  // At most this many frames are analysed per request. Older ones are skipped.
+  static constexpr uint max_frames_per_request = 8U;
 
-  static constexpr uint n_bands = 8192U;
+  enum class Averaging { none, peak_hold, exponential, welch };
+
+  // Measuring a plan blocks the fftw planner for at most this many seconds
+  static constexpr double measure_time_limit = 0.5;
 
   bool ready = false;
 
-  float bin_hz = 0.0F;
+  /**
+   * Everything that depends on the fft size. It is built by the worker of
+   * this plugin, so compute_magnitudes() never waits for fftw.
+   */
+  struct Analysis {
+    Analysis() = default;
+    Analysis(const Analysis&) = delete;
+    auto operator=(const Analysis&) -> Analysis& = delete;
+    Analysis(const Analysis&&) = delete;
+    auto operator=(const Analysis&&) -> Analysis& = delete;
+    ~Analysis();
+
+    uint fft_size = 0U;
+
+    fftwf_plan plan = nullptr;
+
+    float* real_input = nullptr;
+
+    fftwf_complex* complex_output = nullptr;
+
+    std::vector<float> window;
+
+    std::vector<float> normalization;  // Applied to the magnitude of each bin
+  };
+
+  /**
+   * When the fft size changes the worker first publishes an instance with an
+   * estimated plan and then one with a measured plan. compute_magnitudes()
+   * keeps using the current instance until it finds a new one here.
+   */
+  std::atomic<Analysis*> analysis_pending = nullptr;
+
+  std::atomic<uint> requested_fft_size = 0U;
+
+  /**
+   * Analysis state. It is only used by compute_magnitudes() and the
+   * functions it calls, which are protected by data_mutex.
+   */
 
-  std::array<float, n_bands> real_input;
+  std::unique_ptr<Analysis> analysis;
 
-  QList<double> output = QList<double>(((n_bands / 2U) + 1U));
+  uint hop = 0U;
+
+  Averaging averaging = Averaging::none;
+
+  std::vector<float> power;  // Averaged power of each bin
+
+  std::vector<float> frame_power;
+
+  uint n_averaged = 0U;  // Welch frames summed in power
+
+  uint64_t last_frame_end = 0U;  // Ring position where the last analysed frame ended
+
+  uint64_t stream_start = 0U;  // Ring position where the current stream began
+
+  QList<double> output;
 
   std::vector<float> left_delayed_vector;
   std::vector<float> right_delayed_vector;
   std::span<float> left_delayed;
   std::span<float> right_delayed;
 
-  std::array<float, n_bands> latest_samples_mono;
+  /**
+   * The realtime thread writes the downmixed signal to the ring and then
+   * advances write_index. The ring holds two frames of the largest FFT, so the
+   * GUI thread can copy the latest one while the realtime thread keeps writing
+   * after it.
+   */
+  static constexpr size_t ring_size = 2U * max_fft_size;
+  static constexpr size_t ring_mask = ring_size - 1U;
+  static_assert((ring_size & ring_mask) == 0U);
 
-  std::array<float, n_bands> hann_window;
+  std::array<float, ring_size> ring;
 
-  enum class DB_BIT {
-    IDX = (1 << 0),      // To which db_buffers array process() should write.
-    NEWDATA = (1 << 1),  // If new data has been written by process().
-    BUSY = (1 << 2),     // If process() is currently writing data.
-  };
+  std::atomic<uint64_t> write_index = {0U};
+  static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+  /**
+   * Follows the settings. When the fft size changes a new analysis is
+   * requested from the worker and the current one stays in use until it is
+   * ready. False while there is no analysis at all.
+   */
+  auto configure() -> bool;
+
+  // Called by the worker. Returns nullptr on failure.
+  [[nodiscard]] auto create_analysis(const uint& size, const bool& measure) const -> std::unique_ptr<Analysis>;
+
+  void request_analysis(const uint& size);
 
-  std::array<std::array<float, n_bands>, 2> db_buffers;
-  std::atomic<int> db_control = {0};
-  static_assert(std::atomic<int>::is_always_lock_free);
+  // Power spectrum of the fft_size samples ending at end. False if the realtime thread overwrote them meanwhile.
+  auto analyse_frame(const uint64_t& end) -> bool;
 };
@@ -24,17 +24,22 @@
 #include <speex/speexdsp_config_types.h>
 #include <QApplication>
 #include <algorithm>
+#include <atomic>
 #include <climits>
 #include <cstddef>
 #include <format>
 #include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
+#include <utility>
 #include "db_manager.hpp"
 #include "easyeffects_db_speex.h"
+#include "fftw_planner.hpp"
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
+#include "rt_macros.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
 
@@ -46,115 +51,26 @@ Speex::Speex(const std::string& tag, pw::Manager* pipe_manager, PipelineType pip
                  pipe_manager,
                  pipe_type),
       settings(db::Manager::self().get_plugin_db<DbSpeex>(pipe_type,
-                                                          tags::plugin_name::BaseName::speex + "#" + instance_id)),
-      enable_denoise(settings->enableDenoise()),
-      noise_suppression(settings->noiseSuppression()),
-      enable_agc(settings->enableAgc()),
-      enable_vad(settings->enableVad()),
-      vad_probability_start(settings->vadProbabilityStart()),
-      vad_probability_continue(settings->vadProbabilityContinue()),
-      enable_dereverb(settings->enableDereverb()) {
+                                                          tags::plugin_name::BaseName::speex + "#" + instance_id)) {
   init_common_controls<DbSpeex>(settings);
 
   // specific plugin controls
 
-  connect(settings, &DbSpeex::enableDenoiseChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(util::fftw_lock());
+  BIND_RT_VALUE_NOTIFY(enable_denoise, enableDenoise, DbSpeex::enableDenoiseChanged, preprocess_changed);
 
-    enable_denoise = settings->enableDenoise();
+  BIND_RT_VALUE_NOTIFY(noise_suppression, noiseSuppression, DbSpeex::noiseSuppressionChanged, preprocess_changed);
 
-    if (state_left) {
-      speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_DENOISE, &enable_denoise);
-    }
-
-    if (state_right) {
-      speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_DENOISE, &enable_denoise);
-    }
-  });
-
-  connect(settings, &DbSpeex::noiseSuppressionChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(util::fftw_lock());
-
-    noise_suppression = settings->noiseSuppression();
-
-    if (state_left) {
-      speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_NOISE_SUPPRESS, &noise_suppression);
-    }
-
-    if (state_right) {
-      speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_NOISE_SUPPRESS, &noise_suppression);
-    }
-  });
-
-  connect(settings, &DbSpeex::enableAgcChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(util::fftw_lock());
-
-    enable_agc = settings->enableAgc();
-
-    if (state_left) {
-      speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_AGC, &enable_agc);
-    }
-
-    if (state_right) {
-      speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_AGC, &enable_agc);
-    }
-  });
-
-  connect(settings, &DbSpeex::enableVadChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(util::fftw_lock());
-
-    enable_vad = settings->enableVad();
-
-    if (state_left) {
-      speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_VAD, &enable_vad);
-    }
-
-    if (state_right) {
-      speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_VAD, &enable_vad);
-    }
-  });
-
-  connect(settings, &DbSpeex::vadProbabilityStartChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(util::fftw_lock());
-
-    vad_probability_start = settings->vadProbabilityStart();
-
-    if (state_left) {
-      speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_PROB_START, &vad_probability_start);
-    }
-
-    if (state_right) {
-      speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_PROB_START, &vad_probability_start);
-    }
-  });
+  BIND_RT_VALUE_NOTIFY(enable_agc, enableAgc, DbSpeex::enableAgcChanged, preprocess_changed);
 
-  connect(settings, &DbSpeex::vadProbabilityContinueChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(util::fftw_lock());
+  BIND_RT_VALUE_NOTIFY(enable_vad, enableVad, DbSpeex::enableVadChanged, preprocess_changed);
 
-    vad_probability_continue = settings->vadProbabilityContinue();
+  BIND_RT_VALUE_NOTIFY(vad_probability_start, vadProbabilityStart, DbSpeex::vadProbabilityStartChanged,
+                       preprocess_changed);
 
-    if (state_left) {
-      speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_PROB_CONTINUE, &vad_probability_continue);
-    }
-
-    if (state_right) {
-      speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_PROB_CONTINUE, &vad_probability_continue);
-    }
-  });
-
-  connect(settings, &DbSpeex::enableDereverbChanged, [&]() {
-    std::scoped_lock<std::mutex> lock(util::fftw_lock());
-
-    enable_dereverb = settings->enableDereverb();
-
-    if (state_left) {
-      speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_DEREVERB, &enable_dereverb);
-    }
+  BIND_RT_VALUE_NOTIFY(vad_probability_continue, vadProbabilityContinue, DbSpeex::vadProbabilityContinueChanged,
+                       preprocess_changed);
 
-    if (state_right) {
-      speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_DEREVERB, &enable_dereverb);
-    }
-  });
+  BIND_RT_VALUE_NOTIFY(enable_dereverb, enableDereverb, DbSpeex::enableDereverbChanged, preprocess_changed);
 }
 
 Speex::~Speex() {
@@ -166,9 +82,9 @@ Speex::~Speex() {
 
   settings->disconnect();
 
-  std::scoped_lock<std::mutex> lock(util::fftw_lock());
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
-  free_speex();
+  FftwPlanner::self().run([this] { free_speex(state_left, state_right); });
 
   util::debug(std::format("{}{} destroyed", log_tag, name.toStdString()));
 }
@@ -187,7 +103,7 @@ void Speex::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(util::fftw_lock());
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   latency_n_frames = 0U;
 
@@ -200,46 +116,35 @@ void Speex::setup() {
   QMetaObject::invokeMethod(
       baseWorker,
       [this] {
-        std::scoped_lock<std::mutex> lock(util::fftw_lock());
+        SpeexPreprocessState *left = nullptr, *right = nullptr;
 
-        if (state_left != nullptr) {
-          speex_preprocess_state_destroy(state_left);
-        }
+        /**
+         * speexdsp may be built to use fftw for its transforms. The new states
+         * are created without holding data_mutex, so waiting for the planner
+         * never blocks the realtime thread. It bypasses the plugin until
+         * speex_ready is set.
+         */
 
-        if (state_right != nullptr) {
-          speex_preprocess_state_destroy(state_right);
-        }
+        FftwPlanner::self().run([&] {
+          left = speex_preprocess_state_init(static_cast<int>(n_samples), static_cast<int>(rate));
+          right = speex_preprocess_state_init(static_cast<int>(n_samples), static_cast<int>(rate));
+        });
 
-        state_left = speex_preprocess_state_init(static_cast<int>(n_samples), static_cast<int>(rate));
-        state_right = speex_preprocess_state_init(static_cast<int>(n_samples), static_cast<int>(rate));
+        preprocess_changed.store(false, std::memory_order_relaxed);
 
-        if (state_left != nullptr) {
-          speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_DENOISE, &enable_denoise);
-          speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_NOISE_SUPPRESS, &noise_suppression);
+        apply_preprocess_settings(left);
+        apply_preprocess_settings(right);
 
-          speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_AGC, &enable_agc);
+        {
+          std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
-          speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_VAD, &enable_vad);
-          speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_PROB_START, &vad_probability_start);
-          speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_PROB_CONTINUE, &vad_probability_continue);
+          std::swap(state_left, left);
+          std::swap(state_right, right);
 
-          speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_DEREVERB, &enable_dereverb);
+          speex_ready = true;
         }
 
-        if (state_right != nullptr) {
-          speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_DENOISE, &enable_denoise);
-          speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_NOISE_SUPPRESS, &noise_suppression);
-
-          speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_AGC, &enable_agc);
-
-          speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_VAD, &enable_vad);
-          speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_PROB_START, &vad_probability_start);
-          speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_PROB_CONTINUE, &vad_probability_continue);
-
-          speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_DEREVERB, &enable_dereverb);
-        }
-
-        speex_ready = true;
+        FftwPlanner::self().run([&] { free_speex(left, right); });
       },
       Qt::QueuedConnection);
   // NOLINTEND(clang-analyzer-cplusplus.NewDeleteLeaks)
@@ -249,15 +154,22 @@ void Speex::process(std::span<float>& left_in,
                     std::span<float>& right_in,
                     std::span<float>& left_out,
                     std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(util::fftw_lock());
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass || !speex_ready) {
+  if (bypass || !lock.owns_lock() || !speex_ready) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
     return;
   }
 
+  // The preprocess controls only set fields of the states. They are safe to call here.
+
+  if (preprocess_changed.exchange(false, std::memory_order_acquire)) {
+    apply_preprocess_settings(state_left);
+    apply_preprocess_settings(state_right);
+  }
+
   if (input_gain != 1.0F) {
     apply_gain(left_in, right_in, input_gain);
   }
@@ -300,17 +212,42 @@ void Speex::process([[maybe_unused]] std::span<float>& left_in,
                     [[maybe_unused]] std::span<float>& probe_left,
                     [[maybe_unused]] std::span<float>& probe_right) {}
 
-void Speex::free_speex() {
-  if (state_left != nullptr) {
-    speex_preprocess_state_destroy(state_left);
+void Speex::free_speex(SpeexPreprocessState*& left, SpeexPreprocessState*& right) {
+  if (left != nullptr) {
+    speex_preprocess_state_destroy(left);
   }
 
-  if (state_right != nullptr) {
-    speex_preprocess_state_destroy(state_right);
+  if (right != nullptr) {
+    speex_preprocess_state_destroy(right);
   }
 
-  state_left = nullptr;
-  state_right = nullptr;
+  left = nullptr;
+  right = nullptr;
+}
+
+void Speex::apply_preprocess_settings(SpeexPreprocessState* state) const {
+  if (state == nullptr) {
+    return;
+  }
+
+  int denoise = enable_denoise.load(std::memory_order_relaxed);
+  int suppression = noise_suppression.load(std::memory_order_relaxed);
+  int agc = enable_agc.load(std::memory_order_relaxed);
+  int vad = enable_vad.load(std::memory_order_relaxed);
+  int probability_start = vad_probability_start.load(std::memory_order_relaxed);
+  int probability_continue = vad_probability_continue.load(std::memory_order_relaxed);
+  int dereverb = enable_dereverb.load(std::memory_order_relaxed);
+
+  speex_preprocess_ctl(state, SPEEX_PREPROCESS_SET_DENOISE, &denoise);
+  speex_preprocess_ctl(state, SPEEX_PREPROCESS_SET_NOISE_SUPPRESS, &suppression);
+
+  speex_preprocess_ctl(state, SPEEX_PREPROCESS_SET_AGC, &agc);
+
+  speex_preprocess_ctl(state, SPEEX_PREPROCESS_SET_VAD, &vad);
+  speex_preprocess_ctl(state, SPEEX_PREPROCESS_SET_PROB_START, &probability_start);
+  speex_preprocess_ctl(state, SPEEX_PREPROCESS_SET_PROB_CONTINUE, &probability_continue);
+
+  speex_preprocess_ctl(state, SPEEX_PREPROCESS_SET_DEREVERB, &dereverb);
 }
 
 auto Speex::get_latency_seconds() -> float {
@@ -25,6 +25,7 @@
 #include <speex/speexdsp_config_types.h>
 #include <sys/types.h>
 #include <QString>
+#include <atomic>
 #include <climits>
 #include <span>
 #include <string>
@@ -72,8 +73,12 @@ class Speex : public PluginBase {
 
   bool speex_ready = false;
 
-  int enable_denoise = 0, noise_suppression = -15, enable_agc = 0, enable_vad = 0, vad_probability_start = 95,
-      vad_probability_continue = 90, enable_dereverb = 0;
+  // Written by the GUI and pushed into the preprocessor states by process() when preprocess_changed is set
+
+  std::atomic<int> enable_denoise = {0}, noise_suppression = {-15}, enable_agc = {0}, enable_vad = {0},
+                   vad_probability_start = {95}, vad_probability_continue = {90}, enable_dereverb = {0};
+
+  std::atomic<bool> preprocess_changed = {false};
 
   uint latency_n_frames = 0U;
 
@@ -83,5 +88,7 @@ class Speex : public PluginBase {
 
   SpeexPreprocessState *state_left = nullptr, *state_right = nullptr;
 
-  void free_speex();
+  static void free_speex(SpeexPreprocessState*& left, SpeexPreprocessState*& right);
+
+  void apply_preprocess_settings(SpeexPreprocessState* state) const;
 };
@@ -0,0 +1,90 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "split_complex.hpp"
+#include <fftw3.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+using Lanes = float __attribute__((vector_size(split_complex::simd_lanes * sizeof(float))));
+
+}  // namespace
+
+/**
+ * On x86 an AVX2 version is selected at load time when the cpu supports it.
+ * Elsewhere the compiler maps the vector type to the native registers (NEON
+ * on ARM).
+ */
+
+// NOLINTBEGIN(cppcoreguidelines-macro-usage)
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define EE_SIMD_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define EE_SIMD_CLONES
+#endif
+// NOLINTEND(cppcoreguidelines-macro-usage)
+
+namespace split_complex {
+
+auto allocate(const size_t size) -> Buffer {
+  Buffer buffer(fftwf_alloc_real(size));
+
+  std::fill_n(buffer.get(), size, 0.0F);
+
+  return buffer;
+}
+
+auto padded_size(const size_t n_bins) -> size_t {
+  return (n_bins + (2U * simd_lanes) - 1U) / (2U * simd_lanes) * (2U * simd_lanes);
+}
+
+EE_SIMD_CLONES void multiply_accumulate(const float* x_re,
+                                        const float* x_im,
+                                        const float* h_re,
+                                        const float* h_im,
+                                        float* acc_re,
+                                        float* acc_im,
+                                        const size_t n) {
+  for (size_t k = 0U; k < n; k += simd_lanes) {
+    Lanes xr;
+    Lanes xi;
+    Lanes hr;
+    Lanes hi;
+    Lanes re;
+    Lanes im;
+
+    std::memcpy(&xr, x_re + k, sizeof(Lanes));
+    std::memcpy(&xi, x_im + k, sizeof(Lanes));
+    std::memcpy(&hr, h_re + k, sizeof(Lanes));
+    std::memcpy(&hi, h_im + k, sizeof(Lanes));
+    std::memcpy(&re, acc_re + k, sizeof(Lanes));
+    std::memcpy(&im, acc_im + k, sizeof(Lanes));
+
+    re += (xr * hr) - (xi * hi);
+    im += (xr * hi) + (xi * hr);
+
+    std::memcpy(acc_re + k, &re, sizeof(Lanes));
+    std::memcpy(acc_im + k, &im, sizeof(Lanes));
+  }
+}
+
+}  // namespace split_complex
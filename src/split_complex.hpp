@@ -0,0 +1,60 @@
+/**
+ * Copyright © 2017-2026 Wellington Wallace
+ *
+ * This file is part of Easy Effects.
+ *
+ * Easy Effects is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Easy Effects is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <fftw3.h>
+#include <cstddef>
+#include <memory>
+
+/**
+ * Helpers for spectra stored with the real and the imaginary parts in
+ * separate arrays. This layout lets the complex multiply-accumulate of the
+ * partitioned convolutions run on whole SIMD registers.
+ */
+namespace split_complex {
+
+constexpr size_t simd_lanes = 8U;
+
+struct FftwfFree {
+  void operator()(float* p) const { fftwf_free(p); }
+};
+
+using Buffer = std::unique_ptr<float[], FftwfFree>;
+
+/**
+ * Returns a zeroed buffer allocated by fftw. Buffers given to the fftw
+ * new-array execute functions must have the alignment of the ones used to
+ * create the plan.
+ */
+auto allocate(size_t size) -> Buffer;
+
+// Size of a spectrum with n_bins rounded up to keep the alignment of consecutive spectra
+auto padded_size(size_t n_bins) -> size_t;
+
+// acc += x * h for n bins. n has to be a multiple of simd_lanes.
+void multiply_accumulate(const float* x_re,
+                         const float* x_im,
+                         const float* h_re,
+                         const float* h_im,
+                         float* acc_re,
+                         float* acc_im,
+                         size_t n);
+
+}  // namespace split_complex
@@ -119,6 +119,21 @@ StreamInputEffects::StreamInputEffects(pw::Manager* pipe_manager) : EffectsBase(
       DbStreamInputs::self(), &DbStreamInputs::listenToMicChanged, this,
       [&]() { set_listen_to_mic(DbStreamInputs::listenToMic()); }, Qt::QueuedConnection);
 
+  connect(
+      DbMain::self(), &DbMain::fusedEffectsChainChanged, this, [&]() { set_bypass(DbMain::bypass()); },
+      Qt::QueuedConnection);
+
+  connect(
+      DbMain::self(), &DbMain::hardBypassChanged, this, [&]() { set_bypass(DbMain::bypass()); },
+      Qt::QueuedConnection);
+
+  connect(hard_bypass_timer, &QTimer::timeout, this, [&]() {
+    // With the global bypass enabled the plugins are not linked anyway
+    if (!bypass) {
+      update_hard_bypass_links();
+    }
+  });
+
   /**
    * We need to listen to output device changes because if the echo canceller is in the mic pipeline we have to change
    * its probe links to the new output device.
@@ -281,38 +296,35 @@ void StreamInputEffects::connect_filters(const bool& bypass) {
   uint prev_node_id = input_device.id;
   uint next_node_id = 0U;
 
+  pipeline_head_id = input_device.id;
+  pipeline_tail_id = spectrum->get_node_id();
+
   // link plugins
 
   if (!list.empty()) {
-    for (const auto& name : list) {
-      if (!plugins.contains(name) || plugins[name] == nullptr) {
-        continue;
-      }
+    for (const auto& node_id : prepare_plugins_nodes(list)) {
+      next_node_id = node_id;
 
-      if (!plugins[name]->connected_to_pw ? plugins[name]->connect_to_pw() : true) {
-        next_node_id = plugins[name]->get_node_id();
+      const auto links = pm->link_nodes(prev_node_id, next_node_id);
 
-        const auto links = pm->link_nodes(prev_node_id, next_node_id);
-
-        for (auto* link : links) {
-          list_proxies.push_back(link);
-        }
+      for (auto* link : links) {
+        list_proxies.push_back(link);
+      }
 
-        if (mic_linked && (links.size() == 2U)) {
-          prev_node_id = next_node_id;
-        } else if (!mic_linked && (!links.empty())) {
-          prev_node_id = next_node_id;
-          mic_linked = true;
-        } else {
-          util::warning(std::format("Link from node {} to node {} failed", prev_node_id, next_node_id));
-        }
+      if (mic_linked && (links.size() == 2U)) {
+        prev_node_id = next_node_id;
+      } else if (!mic_linked && (!links.empty())) {
+        prev_node_id = next_node_id;
+        mic_linked = true;
+      } else {
+        util::warning(std::format("Link from node {} to node {} failed", prev_node_id, next_node_id));
       }
     }
 
     // checking if we have to link the echo_canceller probe to the output device
 
     for (const auto& name : list) {
-      if (!plugins.contains(name) || plugins[name] == nullptr) {
+      if (!plugins.contains(name) || plugins[name] == nullptr || is_hard_bypassed(plugins[name].get())) {
         continue;
       }
 
@@ -405,8 +417,12 @@ void StreamInputEffects::disconnect_filters() {
 
   list_proxies.clear();
 
+  pipeline_nodes.clear();
+
   set_listen_to_mic(false);
 
+  release_effects_chains();
+
   remove_unused_filters();
 
   filtersLinked = false;
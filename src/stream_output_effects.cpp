@@ -116,6 +116,21 @@ StreamOutputEffects::StreamOutputEffects(pw::Manager* pipe_manager) : EffectsBas
       DbStreamOutputs::self(), &DbStreamOutputs::linkToVirtualSourceChanged, this,
       [&]() { set_bypass(DbMain::bypass()); }, Qt::QueuedConnection);
 
+  connect(
+      DbMain::self(), &DbMain::fusedEffectsChainChanged, this, [&]() { set_bypass(DbMain::bypass()); },
+      Qt::QueuedConnection);
+
+  connect(
+      DbMain::self(), &DbMain::hardBypassChanged, this, [&]() { set_bypass(DbMain::bypass()); },
+      Qt::QueuedConnection);
+
+  connect(hard_bypass_timer, &QTimer::timeout, this, [&]() {
+    // With the global bypass enabled the plugins are not linked anyway
+    if (!bypass) {
+      update_hard_bypass_links();
+    }
+  });
+
   connect(pm, &pw::Manager::linkChanged, this, &StreamOutputEffects::on_link_changed, Qt::QueuedConnection);
 
   connect(pm, &pw::Manager::linkRemoved, this, &StreamOutputEffects::on_link_removed, Qt::QueuedConnection);
@@ -312,26 +327,25 @@ void StreamOutputEffects::connect_filters(const bool& bypass) {
 
   const auto list = bypass ? QStringList() : DbStreamOutputs::plugins();
 
+  pipeline_head_id = pm->ee_sink_node.id;
+  pipeline_tail_id = spectrum->get_node_id();
+
   if (!list.empty()) {
-    for (const auto& name : std::ranges::reverse_view(list)) {
-      if (!plugins.contains(name) || plugins[name] == nullptr) {
-        continue;
-      }
+    const auto nodes = prepare_plugins_nodes(list);
 
-      if (!plugins[name]->connected_to_pw ? plugins[name]->connect_to_pw() : true) {
-        prev_node_id = plugins[name]->get_node_id();
+    for (const auto& node_id : std::ranges::reverse_view(nodes)) {
+      prev_node_id = node_id;
 
-        links = pm->link_nodes(prev_node_id, next_node_id);
+      links = pm->link_nodes(prev_node_id, next_node_id);
 
-        for (auto* link : links) {
-          list_proxies.push_back(link);
-        }
+      for (auto* link : links) {
+        list_proxies.push_back(link);
+      }
 
-        if (links.size() == 2U) {
-          next_node_id = prev_node_id;
-        } else {
-          util::warning(std::format("Link from node {} to node {} failed", prev_node_id, next_node_id));
-        }
+      if (links.size() == 2U) {
+        next_node_id = prev_node_id;
+      } else {
+        util::warning(std::format("Link from node {} to node {} failed", prev_node_id, next_node_id));
       }
     }
 
@@ -339,7 +353,7 @@ void StreamOutputEffects::connect_filters(const bool& bypass) {
     // Here we can loop the plugins in normal order,
 
     for (const auto& name : list) {
-      if (!plugins.contains(name) || plugins[name] == nullptr) {
+      if (!plugins.contains(name) || plugins[name] == nullptr || is_hard_bypassed(plugins[name].get())) {
         continue;
       }
 
@@ -433,6 +447,10 @@ void StreamOutputEffects::disconnect_filters() {
 
   list_proxies.clear();
 
+  pipeline_nodes.clear();
+
+  release_effects_chains();
+
   remove_unused_filters();
 
   filtersLinked = false;
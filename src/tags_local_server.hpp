@@ -43,4 +43,8 @@ inline constexpr auto get_property = "get_property";
 
 inline constexpr auto get_last_loaded_preset = "get_last_loaded_preset";
 
+inline constexpr auto get_dsp_stats = "get_dsp_stats";
+
+inline constexpr auto reset_dsp_stats = "reset_dsp_stats";
+
 }  // namespace tags::local_server
@@ -30,7 +30,6 @@
 #include <filesystem>
 #include <limits>
 #include <memory>
-#include <mutex>
 #include <source_location>
 #include <span>
 #include <string>
@@ -89,11 +88,6 @@ auto interpolate(const std::vector<double>& x_source,
 
 auto mysofa_error_to_string(const int& error) -> const char*;
 
-inline std::mutex& fftw_lock() {
-  static std::mutex fftw_mutex;
-  return fftw_mutex;
-}
-
 template <typename T>
 void print_type(T v) {
   warning(typeid(v).name());
@@ -275,13 +269,4 @@ void copy_bulk(std::vector<T>& input, std::span<T>& output) {
   input.resize(input.size() - output.size());
 }
 
-template <typename T>
-void copy_bulk_remove_half(std::vector<T>& input, std::vector<T>& output) {
-  std::copy_n(input.begin(), output.size(), output.begin());
-
-  std::move(input.begin() + output.size() / 2, input.end(), input.begin());
-
-  input.resize(input.size() - (output.size() / 2));
-}
-
 }  // namespace util
@@ -23,18 +23,22 @@
 #include <qobjectdefs.h>
 #include <qtypes.h>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <format>
 #include <mutex>
 #include <numbers>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include <vector>
 #include "db_manager.hpp"
 #include "easyeffects_db_voice_suppressor.h"
+#include "fftw_planner.hpp"
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
+#include "rt_macros.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
 
@@ -54,10 +58,28 @@ VoiceSuppressor::VoiceSuppressor(const std::string& tag,
   // bypass, input and output gain controls
 
   init_common_controls<DbVoiceSuppressor>(settings);
+
+  // specific plugin controls
+
+  BIND_RT_VALUE(inverted_mode, invertedMode, DbVoiceSuppressor::invertedModeChanged);
+
+  BIND_RT_VALUE_TRANSFORM(correlation_threshold, correlation, DbVoiceSuppressor::correlationChanged,
+                          [](const double& v) { return v * 0.01; });
+
+  BIND_RT_VALUE_TRANSFORM(phase_threshold, phaseDifference, DbVoiceSuppressor::phaseDifferenceChanged,
+                          [](const double& v) { return v * std::numbers::pi_v<double> / 180.0; });
+
+  BIND_RT_VALUE(min_kurtosis, minKurtosis, DbVoiceSuppressor::minKurtosisChanged);
+
+  BIND_RT_VALUE(max_inst_freq, maxInstFreq, DbVoiceSuppressor::maxInstFreqChanged);
+
+  BIND_RT_VALUE(freq_start, freqStart, DbVoiceSuppressor::freqStartChanged);
+
+  BIND_RT_VALUE(freq_end, freqEnd, DbVoiceSuppressor::freqEndChanged);
 }
 
 VoiceSuppressor::~VoiceSuppressor() {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   if (connected_to_pw) {
     disconnect_from_pw();
@@ -84,7 +106,7 @@ void VoiceSuppressor::setup() {
     return;
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
   ready = false;
 
@@ -96,14 +118,13 @@ void VoiceSuppressor::setup() {
           return;
         }
 
-        std::scoped_lock<std::mutex> lock(data_mutex);
+        std::scoped_lock<rt::DataMutex> lock(data_mutex);
 
         block_time = static_cast<double>(n_samples) / static_cast<double>(rate);
 
-        buf_in_L.clear();
-        buf_in_R.clear();
-        buf_out_L.clear();
-        buf_out_R.clear();
+        for (auto* buf : {&buf_in_L, &buf_in_R, &buf_out_L, &buf_out_R}) {
+          buf->set_capacity(4U * static_cast<size_t>(n_samples));
+        }
 
         ola_L.resize(n_samples, 0.0F);
         ola_R.resize(n_samples, 0.0F);
@@ -123,11 +144,13 @@ void VoiceSuppressor::setup() {
         complexL = fftw_alloc_complex(fft_size);
         complexR = fftw_alloc_complex(fft_size);
 
-        planL = fftw_plan_dft_r2c_1d(static_cast<int>(n_samples), realL, complexL, FFTW_ESTIMATE);
-        planR = fftw_plan_dft_r2c_1d(static_cast<int>(n_samples), realR, complexR, FFTW_ESTIMATE);
+        FftwPlanner::self().run([this] {
+          planL = fftw_plan_dft_r2c_1d(static_cast<int>(n_samples), realL, complexL, FFTW_ESTIMATE);
+          planR = fftw_plan_dft_r2c_1d(static_cast<int>(n_samples), realR, complexR, FFTW_ESTIMATE);
 
-        planInvL = fftw_plan_dft_c2r_1d(static_cast<int>(n_samples), complexL, realL, FFTW_ESTIMATE);
-        planInvR = fftw_plan_dft_c2r_1d(static_cast<int>(n_samples), complexR, realR, FFTW_ESTIMATE);
+          planInvL = fftw_plan_dft_c2r_1d(static_cast<int>(n_samples), complexL, realL, FFTW_ESTIMATE);
+          planInvR = fftw_plan_dft_c2r_1d(static_cast<int>(n_samples), complexR, realR, FFTW_ESTIMATE);
+        });
 
         freqs.resize(fft_size);
 
@@ -163,9 +186,9 @@ void VoiceSuppressor::process(std::span<float>& left_in,
                               std::span<float>& right_in,
                               std::span<float>& left_out,
                               std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::shared_lock<rt::DataMutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass) {
+  if (bypass || !lock.owns_lock()) {
     std::ranges::copy(left_in, left_out.begin());
     std::ranges::copy(right_in, right_out.begin());
 
@@ -187,12 +210,23 @@ void VoiceSuppressor::process(std::span<float>& left_in,
     apply_gain(left_in, right_in, input_gain);
   }
 
-  buf_in_L.insert(buf_in_L.end(), left_in.begin(), left_in.end());
-  buf_in_R.insert(buf_in_R.end(), right_in.begin(), right_in.end());
+  const auto inverted = inverted_mode.load(std::memory_order_relaxed);
+  const auto corr_threshold = correlation_threshold.load(std::memory_order_relaxed);
+  const auto phase_diff_threshold = phase_threshold.load(std::memory_order_relaxed);
+  const auto kurtosis_threshold = min_kurtosis.load(std::memory_order_relaxed);
+  const auto inst_freq_threshold = max_inst_freq.load(std::memory_order_relaxed);
+  const auto f_start = freq_start.load(std::memory_order_relaxed);
+  const auto f_end = freq_end.load(std::memory_order_relaxed);
+
+  buf_in_L.push(left_in);
+  buf_in_R.push(right_in);
 
   while (buf_in_L.size() >= n_samples) {
-    util::copy_bulk_remove_half(buf_in_L, data_L);
-    util::copy_bulk_remove_half(buf_in_R, data_R);
+    buf_in_L.peek(data_L);
+    buf_in_R.peek(data_R);
+
+    buf_in_L.discard(hop);
+    buf_in_R.discard(hop);
 
     for (uint n = 0; n < n_samples; n++) {
       realL[n] = static_cast<double>(data_L[n]);
@@ -228,10 +262,10 @@ void VoiceSuppressor::process(std::span<float>& left_in,
         auto cross_mag = std::hypot(fft_cross_real[k], fft_cross_img[k]);
         auto correlation = cross_mag / ((fft_mag_L[k] * fft_mag_R[k]) + epsilon);
 
-        if (!settings->invertedMode()) {
-          corr_gain = sigmoid(correlation / (settings->correlation() * 0.01));
+        if (!inverted) {
+          corr_gain = sigmoid(correlation / corr_threshold);
         } else {
-          corr_gain = sigmoid((settings->correlation() * 0.01) / std::max(correlation, epsilon));
+          corr_gain = sigmoid(corr_threshold / std::max(correlation, epsilon));
         }
       }
 
@@ -239,11 +273,10 @@ void VoiceSuppressor::process(std::span<float>& left_in,
       {
         auto phase_diff = std::abs(std::atan2(fft_cross_img[k], fft_cross_real[k]));
 
-        if (!settings->invertedMode()) {
-          phase_gain = sigmoid(phase_diff / (settings->phaseDifference() * std::numbers::pi_v<double> / 180.0));
+        if (!inverted) {
+          phase_gain = sigmoid(phase_diff / phase_diff_threshold);
         } else {
-          phase_gain = sigmoid((settings->phaseDifference() * std::numbers::pi_v<double> / 180.0) /
-                               std::max(phase_diff, epsilon));
+          phase_gain = sigmoid(phase_diff_threshold / std::max(phase_diff, epsilon));
         }
       }
 
@@ -253,10 +286,10 @@ void VoiceSuppressor::process(std::span<float>& left_in,
         auto kurtosis_R = compute_local_kurtosis(k, fft_mag_R.data());
         auto kurtosis = std::max(kurtosis_L, kurtosis_R);
 
-        if (!settings->invertedMode()) {
-          kurtosis_gain = sigmoid(kurtosis / settings->minKurtosis());
+        if (!inverted) {
+          kurtosis_gain = sigmoid(kurtosis / kurtosis_threshold);
         } else {
-          kurtosis_gain = sigmoid(settings->minKurtosis() / std::max(kurtosis, epsilon));
+          kurtosis_gain = sigmoid(kurtosis_threshold / std::max(kurtosis, epsilon));
         }
       }
 
@@ -264,16 +297,16 @@ void VoiceSuppressor::process(std::span<float>& left_in,
       {
         auto freq_diff = std::abs(calc_instantaneous_frequency(k));
 
-        if (!settings->invertedMode()) {
-          inst_freq_gain = sigmoid(freq_diff / settings->maxInstFreq());
+        if (!inverted) {
+          inst_freq_gain = sigmoid(freq_diff / inst_freq_threshold);
         } else {
-          inst_freq_gain = sigmoid(settings->maxInstFreq() / std::max(freq_diff, epsilon));
+          inst_freq_gain = sigmoid(inst_freq_threshold / std::max(freq_diff, epsilon));
         }
       }
 
       // Deciding if we should attenuate the frequency
 
-      if ((freqs[k] >= settings->freqStart()) && (freqs[k] <= settings->freqEnd())) {
+      if ((freqs[k] >= f_start) && (freqs[k] <= f_end)) {
         auto gain = phase_gain * corr_gain * kurtosis_gain * inst_freq_gain;
 
         complexL[k][0] *= gain;
@@ -302,8 +335,8 @@ void VoiceSuppressor::process(std::span<float>& left_in,
     }
 
     // ----- Push first hop to output FIFO
-    buf_out_L.insert(buf_out_L.end(), ola_L.begin(), ola_L.end() - hop);
-    buf_out_R.insert(buf_out_R.end(), ola_R.begin(), ola_R.end() - hop);
+    buf_out_L.push(std::span<const float>(ola_L.data(), ola_L.size() - hop));
+    buf_out_R.push(std::span<const float>(ola_R.data(), ola_R.size() - hop));
 
     // ----- Shift OLA buffer
     std::move(ola_L.begin() + hop, ola_L.end(), ola_L.begin());
@@ -313,12 +346,9 @@ void VoiceSuppressor::process(std::span<float>& left_in,
     std::fill(ola_R.begin() + hop, ola_R.end(), 0.0F);
   }
 
-  if (buf_out_L.size() < n_samples) {
+  if (!buf_out_L.pop(left_out) || !buf_out_R.pop(right_out)) {
     std::ranges::fill(left_out, 0.0F);
     std::ranges::fill(right_out, 0.0F);
-  } else {
-    util::copy_bulk(buf_out_L, left_out);
-    util::copy_bulk(buf_out_R, right_out);
   }
 
   if (output_gain != 1.0F) {
@@ -368,21 +398,22 @@ void VoiceSuppressor::free_fftw() {
     fftw_free(complexR);
   }
 
-  if (planL != nullptr) {
-    fftw_destroy_plan(planL);
-  }
-
-  if (planR != nullptr) {
-    fftw_destroy_plan(planR);
-  }
-
-  if (planInvL != nullptr) {
-    fftw_destroy_plan(planInvL);
-  }
-
-  if (planInvR != nullptr) {
-    fftw_destroy_plan(planInvR);
-  }
+  FftwPlanner::self().run([this] {
+    for (auto* plan : {planL, planR, planInvL, planInvR}) {
+      if (plan != nullptr) {
+        fftw_destroy_plan(plan);
+      }
+    }
+  });
+
+  realL = nullptr;
+  realR = nullptr;
+  complexL = nullptr;
+  complexR = nullptr;
+  planL = nullptr;
+  planR = nullptr;
+  planInvL = nullptr;
+  planInvR = nullptr;
 }
 
 auto VoiceSuppressor::compute_local_kurtosis(int k, double* magnitude_spectrum) const -> double {
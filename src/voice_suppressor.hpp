@@ -24,6 +24,7 @@
 #include <qtmetamacros.h>
 #include <qtypes.h>
 #include <QString>
+#include <atomic>
 #include <span>
 #include <string>
 #include <vector>
@@ -31,6 +32,7 @@
 #include "pipeline_type.hpp"
 #include "plugin_base.hpp"
 #include "pw_manager.hpp"
+#include "rt_ring_buffer.hpp"
 
 class VoiceSuppressor : public PluginBase {
   Q_OBJECT
@@ -68,6 +70,17 @@ class VoiceSuppressor : public PluginBase {
  private:
   DbVoiceSuppressor* settings = nullptr;
 
+  // Realtime mirrors of the settings used in the per bin loop
+
+  std::atomic<bool> inverted_mode = {false};
+
+  std::atomic<double> correlation_threshold = {0.0};
+  std::atomic<double> phase_threshold = {0.0};  // radians
+  std::atomic<double> min_kurtosis = {0.0};
+  std::atomic<double> max_inst_freq = {0.0};
+  std::atomic<double> freq_start = {0.0};
+  std::atomic<double> freq_end = {0.0};
+
   bool ready = false;
   bool notify_latency = false;
 
@@ -95,8 +108,8 @@ class VoiceSuppressor : public PluginBase {
 
   std::vector<double> hanning_window;
 
-  std::vector<float> buf_in_L, buf_in_R;
-  std::vector<float> buf_out_L, buf_out_R;
+  rt::RingBuffer<float> buf_in_L, buf_in_R;
+  rt::RingBuffer<float> buf_out_L, buf_out_R;
 
   std::vector<float> data_L;
   std::vector<float> data_R;